@@ -0,0 +1,38 @@
+/*
+  benchmark.ino
+
+  The ESP32 contains two 8-bit DAC output channels.
+  DAC channel 1 is GPIO25 (Pin 25) and DAC channel 2 is GPIO26 (Pin 26).
+
+  This sketch measures how long the DacESP32 methods take on your board
+  (min/mean/median/99th percentile/max and calls per second) and prints
+  the result as CSV, which can be compared with the output of host tool
+  extras/bench or of other library versions. DAC channel 1 (Pin 25)
+  outputs test signals meanwhile.
+*/
+
+#include <Arduino.h>
+#include "DacESP32.h"
+#include "DacEspBench.h"
+
+DacESP32 dac1(GPIO_NUM_25);
+
+void printLine(const char *line, void *arg) {
+  Serial.println(line);
+}
+
+void setup() {
+  Serial.begin(115200);
+
+  Serial.println();
+  Serial.println("Sketch started. Benchmark running on GPIO (Pin) number 25.");
+
+  dac_bench_config_t config = DAC_BENCH_CONFIG_DEFAULT();
+  // measure each method 512 times
+  config.iterations = 512;
+  DacEspBench::run(dac1, config, printLine);
+}
+
+void loop() {
+  delay(1000);
+}
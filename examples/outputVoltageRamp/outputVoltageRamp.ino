@@ -0,0 +1,51 @@
+/*
+  outputVoltageRamp.ino
+
+  The ESP32 contains two 8-bit DAC output channels.
+  DAC channel 1 is GPIO25 (Pin 25) and DAC channel 2 is GPIO26 (Pin 26).
+
+  This sketch ramps the voltage on DAC channel 1 smoothly up & down instead 
+  of changing it in steps. DAC channel 2 outputs an ADSR-style envelope.
+  All ramps run in the background, loop() is free for other work.
+*/
+
+#include <Arduino.h>
+#include "DacESP32.h"
+#include "DacEspRamp.h"
+
+DacESP32 dac1(DAC_CHANNEL_1),
+         dac2(DAC_CHANNEL_2);
+
+DacEspRamp ramp1(dac1),
+           ramp2(dac2);
+
+// levels: peak, sustain, base - durations (ms): attack, decay, release
+dac_envelope_t env = { 255, 150, 0, 200, 300, 1000, DAC_RAMP_LINEAR };
+
+void setup() {
+  Serial.begin(115200);
+
+  Serial.println();
+  Serial.print("Sketch started. Voltage ramps on GPIO (Pin) numbers: ");
+  Serial.print(DAC_CHANNEL_1_GPIO_NUM);
+  Serial.print(" and ");
+  Serial.println(DAC_CHANNEL_2_GPIO_NUM);
+
+  dac1.outputVoltage((uint8_t)0);
+  dac2.outputVoltage((uint8_t)0);
+}
+
+void loop() {
+  // channel 1: S-curve ramp up within 2 secs, then slew down with 100 steps/sec
+  ramp1.rampTo(255, 2000, DAC_RAMP_SCURVE);
+  // channel 2: attack, decay & hold sustain level
+  ramp2.envelope(env);
+  delay(2500);
+
+  ramp1.slewTo(0, 100);
+  ramp2.release();
+  while (ramp1.isBusy()) {
+    delay(10);
+  }
+  delay(500);
+}
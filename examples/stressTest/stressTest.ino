@@ -0,0 +1,120 @@
+/*
+  stressTest.ino
+
+  The ESP32 contains two 8-bit DAC output channels.
+  DAC channel 1 is GPIO25 (Pin 25) and DAC channel 2 is GPIO26 (Pin 26).
+
+  This sketch checks the register locking of the library. A task pinned to
+  core 0 drives channel 1 while a task pinned to core 1 drives channel 2,
+  both changing scale, phase, offset, DC value and CW output as fast as
+  possible. Both channels share their control registers, so a lost update
+  shows up as a channel field not holding the value written last. At the
+  end the shadow copies of DacEspRegs get compared with the registers.
+*/
+
+#include <Arduino.h>
+#include "DacESP32.h"
+#include "DacEspRegs.h"
+#include "DacEspState.h"
+
+#define ITERATIONS 100000
+
+DacESP32 dac1(DAC_CHANNEL_1),
+         dac2(DAC_CHANNEL_2);
+
+typedef struct {
+  DacESP32     *dac;
+  uint32_t      errors;
+  volatile bool done;
+} stress_t;
+
+stress_t stress[2] = { { &dac1, 0, false }, { &dac2, 0, false } };
+uint32_t started;
+
+// Checks the fields of a channel. The task on the other core never writes
+// them, so they must hold the values this task has written last.
+bool channelOk(dac_channel_t channel, bool enabled, bool cw, uint8_t value,
+               dac_cw_scale_t scale, dac_cw_phase_t phase, int8_t offset) {
+  dac_reg_dump_t regs;
+  dac_state_t state;
+
+  DacEspRegs::capture(&regs);
+  DacEspState::decode(regs, CK8M, &state);
+  const dac_channel_state_t &c = state.channel[channel];
+
+  return c.outputEnabled == enabled && c.cwEnabled == cw && (cw || c.value == value) &&
+         c.scale == scale && c.invert == phase && c.offset == offset;
+}
+
+void stressTask(void *arg) {
+  stress_t *s = (stress_t *)arg;
+  DacESP32 &dac = *s->dac;
+  uint32_t seed = 12345 + dac.getChannel();
+  dac_cw_scale_t scale = DAC_CW_SCALE_1;
+  dac_cw_phase_t phase = DAC_CW_PHASE_0;
+  int8_t offset = 0;
+  uint8_t value = 0;
+  bool enabled = false, cw = false;
+
+  for (uint32_t i = 0; i < ITERATIONS; i++) {
+    seed = seed * 1103515245 + 12345;
+    uint32_t r = seed >> 8;
+    switch (r % 5) {
+      case 0:
+        scale = (dac_cw_scale_t)((r >> 4) & 3);
+        dac.setCwScale(scale);
+        break;
+      case 1:
+        phase = ((r >> 4) & 1) ? DAC_CW_PHASE_180 : DAC_CW_PHASE_0;
+        dac.setCwPhase(phase);
+        break;
+      case 2:
+        offset = (int8_t)(r >> 4);
+        dac.setCwOffset(offset);
+        break;
+      case 3:
+        value = (uint8_t)(r >> 4);
+        dac.outputVoltage(value);
+        enabled = true;
+        cw = false;
+        break;
+      default:
+        // same frequency on both channels, the CW generator is shared
+        dac.outputCW(1000, scale, phase, offset);
+        enabled = cw = true;
+        break;
+    }
+    if (!channelOk(dac.getChannel(), enabled, cw, value, scale, phase, offset)) {
+      s->errors++;
+    }
+  }
+
+  s->done = true;
+  vTaskDelete(NULL);
+}
+
+void setup() {
+  Serial.begin(115200);
+
+  Serial.println();
+  Serial.println("Sketch started. Stress test running on GPIO (Pin) numbers 25 (core 0) and 26 (core 1).");
+
+  started = millis();
+  xTaskCreatePinnedToCore(stressTask, "stress1", 4096, &stress[0], 1, NULL, 0);
+  xTaskCreatePinnedToCore(stressTask, "stress2", 4096, &stress[1], 1, NULL, 1);
+}
+
+void loop() {
+  static bool reported = false;
+
+  if (!reported && stress[0].done && stress[1].done) {
+    uint32_t mismatch = DacEspRegs::verify();
+
+    Serial.printf("%d iterations per channel in %lu ms\n", ITERATIONS, millis() - started);
+    Serial.printf("lost updates: channel 1 %u, channel 2 %u\n", stress[0].errors, stress[1].errors);
+    Serial.printf("shadow copies differing from registers: 0x%02x\n", mismatch);
+    Serial.println((stress[0].errors || stress[1].errors || mismatch) ? "FAILED" : "PASSED");
+    reported = true;
+  }
+  delay(100);
+}
@@ -0,0 +1,55 @@
+/*
+  bench, host tool of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Runs the DacEspBench microbenchmark with the register emulation on a
+  host and prints the CSV report, e.g. to compare library versions or
+  the effect of build options without hardware. The same benchmark runs
+  on the ESP32 with example sketch benchmark.ino.
+
+  Built by the host build together with the library (stub headers and
+  runtime in extras/host), from the repository root:
+    cmake -S extras/host -B build && cmake --build build --target bench
+    ./build/bench [iterations (256)] > host.csv
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "DacEspBench.h"
+
+static void printLine(const char *line, void *arg)
+{
+  puts(line);
+}
+
+int main(int argc, char *argv[])
+{
+  dac_bench_config_t config = DAC_BENCH_CONFIG_DEFAULT();
+  DacESP32 dac(DAC_CHANNEL_1);
+
+  if (argc > 1) {
+    config.iterations = (uint16_t)atoi(argv[1]);
+  }
+  return DacEspBench::run(dac, config, printLine) == ESP_OK ? 0 : 1;
+}
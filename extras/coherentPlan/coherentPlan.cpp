@@ -0,0 +1,91 @@
+/*
+  coherentPlan, host tool of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Prints the best coherent combinations of CW setting, ADC sample rate and
+  record length for a target frequency (class DacEspPlanner).
+
+  Build & run on a host (from this directory):
+    g++ -O2 -I../../src coherentPlan.cpp ../../src/DacEspPlanner.cpp -o coherentPlan
+    ./coherentPlan [options] frequency
+  Options:
+    -c Hz          RTC8M_CLK (8000000)
+    -d n, -s n     highest CK8M_DIV_SEL (7), highest SW_FSTEP (256)
+    -t Hz          CW frequency tolerance (0: nearest setting per CK8M_DIV_SEL)
+    -a Hz          fixed ADC clock (default: RTC8M_CLK / (1 + CK8M_DIV_SEL))
+    -r min,max     ADC clock dividers (1,64)
+    -n min,max     record length (256,4096)
+    -l             any record length, not only powers of 2
+    -p n           number of plans printed (10)
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "DacEspPlanner.h"
+
+#define PLANS_MAX 100
+
+int main(int argc, char *argv[])
+{
+  dac_plan_params_t params = { 8000000UL, 7, 256, 0, DAC_PLAN_ADC_CLOCK_CK8M, 1, 64, 256, 4096, true };
+  size_t maxPlans = 10;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "c:d:s:t:a:r:n:lp:")) != -1) {
+    switch (opt) {
+      case 'c': params.ck8m = atol(optarg); break;
+      case 'd': params.divMax = atoi(optarg); break;
+      case 's': params.fstepMax = atoi(optarg); break;
+      case 't': params.toleranceHz = atol(optarg); break;
+      case 'a': params.adcClock = atol(optarg); break;
+      case 'r': sscanf(optarg, "%u,%u", &params.adcDivMin, &params.adcDivMax); break;
+      case 'n': sscanf(optarg, "%u,%u", &params.recordMin, &params.recordMax); break;
+      case 'l': params.powerOfTwo = false; break;
+      case 'p': maxPlans = atoi(optarg); break;
+      default:
+        return 1;
+    }
+  }
+  if (optind >= argc || maxPlans < 1 || maxPlans > PLANS_MAX) {
+    fprintf(stderr, "usage: coherentPlan [options] frequency (see source)\n");
+    return 1;
+  }
+
+  uint32_t frequency = atol(argv[optind]);
+  dac_plan_t plans[PLANS_MAX];
+  size_t count = DacEspPlanner::plan(frequency, params, plans, maxPlans);
+
+  printf("# target %u Hz, RTC8M_CLK %u Hz, ADC clock %s\n", frequency, params.ck8m,
+         params.adcClock == DAC_PLAN_ADC_CLOCK_CK8M ? "RTC8M_CLK / (1 + CK8M_DIV_SEL)" : "fixed");
+  printf("#  div fstep     fcw(Hz) adcDiv  rate(Hz)     N      M  error(cycles)\n");
+  for (size_t i = 0; i < count; i++) {
+    const dac_plan_t &p = plans[i];
+    printf("%6u %5u %11.4f %6u %9.1f %5u %6u  %s%.6f\n", p.clk8mDiv, p.frequencyStep, p.fcw, p.adcDiv,
+           p.sampleRate, p.record, p.cycles, p.exact ? "exact " : "", p.error);
+  }
+
+  return count ? 0 : 1;
+}
@@ -0,0 +1,199 @@
+/*
+  cwFrac, host tool of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Simulates the fractional CW mode (class DacEspFrac): SW_FSTEP alternates
+  between two neighbours, driven by a first order accumulator every update
+  interval. The output gets rendered by DacEspCwModel (one sample per
+  generator clock, phase continuous across updates) and compared with the
+  nearest integer setting:
+    - average frequency achieved
+    - phase/time jitter against an ideal oscillator at the target frequency
+    - strongest spur close to the carrier (within +-1/interval) and SFDR
+
+  Build & run on a host (from this directory):
+    g++ -O2 -I../../src cwFrac.cpp ../../src/DacEspCwSolver.cpp ../../src/DacEspCwModel.cpp -o cwFrac
+    ./cwFrac <frequency Hz, e.g. 1000.25> [interval us (100)] [highAcc 0/1 (1)] [fstepMax (512)] [RTC8M_CLK Hz (8000000)]
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <complex>
+#include <vector>
+#include "DacEspCwSolver.h"
+#include "DacEspCwModel.h"
+
+// number of generator clocks simulated (FFT size)
+#define CLOCKS (1UL << 20)
+// bins next to the carrier belonging to it (Hann window main lobe)
+#define CARRIER_BINS 3
+
+typedef std::complex<double> cplx;
+
+typedef struct {
+  double fAvg;              // average output frequency (Hz)
+  double jitterPeakNs;      // max. time error against ideal oscillator (ns)
+  double jitterRmsNs;       // rms time error (ns)
+  double spurClose;         // strongest spur within +-1/interval (dBc)
+  double spurOffset;        // offset of this spur from carrier (Hz)
+  double sfdr;              // strongest spur anywhere (dBc)
+} result_t;
+
+//
+// In-place radix-2 FFT, size must be a power of 2.
+//
+static void fft(std::vector<cplx> &x)
+{
+  size_t n = x.size();
+
+  for (size_t i = 1, j = 0; i < n; i++) {
+    size_t bit = n >> 1;
+    for (; j & bit; bit >>= 1) j ^= bit;
+    j ^= bit;
+    if (i < j) std::swap(x[i], x[j]);
+  }
+  for (size_t len = 2; len <= n; len <<= 1) {
+    cplx wlen = std::polar(1.0, -2 * M_PI / len);
+    for (size_t i = 0; i < n; i += len) {
+      cplx w(1);
+      for (size_t k = 0; k < len / 2; k++) {
+        cplx u = x[i + k], v = x[i + k + len / 2] * w;
+        x[i + k] = u + v;
+        x[i + k + len / 2] = u - v;
+        w *= wlen;
+      }
+    }
+  }
+}
+
+//
+// Render CLOCKS generator clocks, SW_FSTEP updated every interval like
+// DacEspFrac::onTimer() does (fraction = 0 gives the plain integer setting).
+//
+static void simulate(const dac_cw_frac_solution_t &s, uint32_t ck8m, uint32_t intervalUs, double target,
+                     result_t *r)
+{
+  dac_cw_model_config_t config = { s.frequencyStep, s.clk8mDiv, 0, 0, 2, ck8m };
+  DacEspCwModel model(config);
+  double clock = model.getClockFrequency();
+  std::vector<uint8_t> codes(CLOCKS);
+  uint32_t accumulator = 0;
+  uint64_t phase = 0;           // phase accumulator, not wrapped
+  double errSum = 0, errMax = 0;
+  size_t updates = 0;
+
+  for (size_t pos = 0, k = 1; pos < CLOCKS; k++) {
+    // next update at k * interval
+    size_t next = (size_t)((double)k * intervalUs * clock / 1e6);
+    if (next > CLOCKS) next = CLOCKS;
+    if (next <= pos) continue;
+
+    uint16_t start = model.getPhase();
+    model.setConfig(config);
+    model.setPhase(start);
+    model.render(&codes[pos], next - pos);
+    phase += (uint64_t)config.fstep * (next - pos);
+    pos = next;
+
+    // time error of the zero crossings against an ideal oscillator
+    double err = ((double)phase / 65536 - target * pos / clock) / target * 1e9;
+    errSum += err * err;
+    if (fabs(err) > errMax) errMax = fabs(err);
+    updates++;
+
+    uint32_t a = accumulator + s.fraction;
+    config.fstep = s.frequencyStep + (a < accumulator);
+    accumulator = a;
+  }
+  r->fAvg = (double)phase / 65536 / (CLOCKS / clock);
+  r->jitterPeakNs = errMax;
+  r->jitterRmsNs = sqrt(errSum / updates);
+
+  // Hann windowed spectrum
+  std::vector<cplx> x(CLOCKS);
+  for (size_t i = 0; i < CLOCKS; i++) {
+    x[i] = (codes[i] - 128.0) * (0.5 - 0.5 * cos(2 * M_PI * i / CLOCKS));
+  }
+  fft(x);
+  size_t half = CLOCKS / 2, carrier = 1;
+  std::vector<double> p(half + 1);
+  for (size_t i = 0; i <= half; i++) {
+    p[i] = std::norm(x[i]);
+    if (i > CARRIER_BINS && p[i] > p[carrier]) carrier = i;
+  }
+  double binHz = clock / CLOCKS, pc = 0;
+  for (size_t i = carrier - CARRIER_BINS; i <= carrier + CARRIER_BINS; i++) pc += p[i];
+
+  size_t span = (size_t)(1e6 / intervalUs / binHz), close = 0, any = 0;
+  for (size_t i = CARRIER_BINS + 1; i <= half; i++) {
+    if (i + CARRIER_BINS >= carrier && i <= carrier + CARRIER_BINS) continue;
+    if (p[i] > p[any]) any = i;
+    if (i + span >= carrier && i <= carrier + span && p[i] > p[close]) close = i;
+  }
+  r->spurClose = close ? 10 * log10(p[close] / pc) : -999;
+  r->spurOffset = close ? ((double)close - carrier) * binHz : 0;
+  r->sfdr = 10 * log10(p[any] / pc);
+}
+
+static void print(const char *name, const result_t &r, double target)
+{
+  printf("%-9s %14.4f %10.4f %12.1f %11.1f %9.1f @ %+8.1fHz %8.1f\n", name, r.fAvg, r.fAvg - target,
+         r.jitterPeakNs, r.jitterRmsNs, r.spurClose, r.spurOffset, r.sfdr);
+}
+
+int main(int argc, char *argv[])
+{
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s frequency [intervalUs] [highAcc] [fstepMax] [ck8m]\n", argv[0]);
+    return 1;
+  }
+  double target = atof(argv[1]);
+  uint32_t intervalUs = argc > 2 ? atoi(argv[2]) : 100;
+  bool highAcc = argc > 3 ? atoi(argv[3]) != 0 : true;
+  dac_cw_solver_params_t params = { (uint32_t)(argc > 5 ? atol(argv[5]) : 8000000L), (uint8_t)(highAcc ? 7 : 0),
+                                    (uint16_t)(argc > 4 ? atoi(argv[4]) : 512), 0 };
+
+  dac_cw_frac_solution_t frac;
+  if (intervalUs == 0 || !DacEspCwSolver::solveFractional((uint32_t)(target * 1000 + 0.5), params, &frac)) {
+    fprintf(stderr, "frequency out of range\n");
+    return 1;
+  }
+  dac_cw_frac_solution_t integer = frac;
+  integer.frequencyStep += frac.fraction >= 0x80000000UL;
+  integer.fraction = 0;
+
+  double step = (double)params.ck8m / (1 + frac.clk8mDiv) / 65536;
+  printf("# target %.3fHz: CK8M_DIV_SEL %u, SW_FSTEP %u/%u (share %.6f), step %.3fHz, update every %uus\n",
+         target, frac.clk8mDiv, frac.frequencyStep, frac.frequencyStep + 1, frac.fraction / 4294967296.0,
+         step, intervalUs);
+  printf("# mode      average(Hz)  error(Hz) jitter pk(ns) rms(ns) close-in spur(dBc)     SFDR(dB)\n");
+
+  result_t r;
+  simulate(integer, params.ck8m, intervalUs, target, &r);
+  print("integer", r, target);
+  simulate(frac, params.ck8m, intervalUs, target, &r);
+  print("fraction", r, target);
+
+  return 0;
+}
@@ -0,0 +1,218 @@
+/*
+  cwModelTest, host tool of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Test of the CW generator model (src/DacEspCwModel.cpp, compiled into
+  this file). It renders every CK8M_DIV_SEL, SCALE, DC offset and INV
+  combination and checks that the period is 65536 / SW_FSTEP generator
+  ticks, that each SCALE step halves the amplitude, that the DC offset
+  saturates at code 0 / 255 and that the INV modes only flip the bits
+  they name (DAC_CW_INVERT_MSB the MSB). The period is checked for every
+  SW_FSTEP up to 1024 and random ones above.
+
+  Build & run on a host (from this directory):
+    g++ -O2 -I../../src cwModelTest.cpp -o cwModelTest
+    ./cwModelTest [random SW_FSTEP values (1000)] [seed (1)]
+  The host build (extras/host) runs it with ctest as well.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <random>
+#include "../../src/DacEspCwModel.cpp"
+
+#define TICKS_MAX 65536
+
+static uint64_t failures;
+
+#define CHECK(cond, ...)                                                              \
+  do {                                                                                \
+    if (!(cond)) {                                                                    \
+      if (failures++ < 20) {                                                          \
+        printf("FAIL %s: fstep %u div %u scale %u offset %d inv %u: ", #cond,         \
+               config.fstep, config.clk8mDiv, config.scale, config.offset,            \
+               config.invert);                                                        \
+        printf(__VA_ARGS__);                                                          \
+        printf("\n");                                                                 \
+      }                                                                               \
+      return;                                                                         \
+    }                                                                                 \
+  } while (0)
+
+// two's complement generator value of a DAC code (undoing the INV mode)
+static int8_t decode(uint8_t code, uint8_t invert)
+{
+  static const uint8_t mask[4] = { 0x00, 0xFF, 0x80, 0x7F };
+  return (int8_t)(code ^ mask[invert & 3]);
+}
+
+static int32_t clamp(int32_t value, int32_t low, int32_t high)
+{
+  return value < low ? low : (value > high ? high : value);
+}
+
+static uint32_t gcd(uint32_t a, uint32_t b)
+{
+  while (b) {
+    uint32_t t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+//
+// Period: over one cycle of the phase accumulator (65536 / gcd(fstep, 65536)
+// generator ticks) the cosine passes its upward zero crossing fstep / gcd
+// times, i.e. one period takes 65536 / fstep ticks on average.
+//
+static void checkPeriod(uint16_t fstep)
+{
+  static uint8_t buffer[TICKS_MAX + 1];
+  dac_cw_model_config_t config = { fstep, 0, 0, 0, 2, 0 };
+  DacEspCwModel model(config);
+  uint32_t g = gcd(fstep, TICKS_MAX);
+  uint32_t ticks = TICKS_MAX / g, crossings = 0;
+
+  model.render(buffer, ticks + 1);
+  CHECK(buffer[ticks] == buffer[0], "not back at phase 0 after %u ticks", ticks);
+  for (uint32_t i = 1; i <= ticks; i++) {
+    if (decode(buffer[i - 1], 2) < 0 && decode(buffer[i], 2) >= 0) {
+      crossings++;
+    }
+  }
+  CHECK(crossings == fstep / g, "%u periods in %u ticks, expected %u", crossings, ticks, fstep / g);
+}
+
+//
+// All DC offset & INV combinations of one SW_FSTEP, CK8M_DIV_SEL & SCALE
+// setting, compared with the previous SCALE (amplitude halved).
+// Parameter: p2p...peak to peak value per offset & INV, previous SCALE in, this SCALE out
+//
+static void checkScale(uint16_t fstep, uint8_t div, uint8_t scale, int32_t p2p[256][4])
+{
+  static uint8_t buffer[4][2 * TICKS_MAX];
+  uint32_t period = TICKS_MAX / fstep;
+  int32_t top = 127 >> scale, bottom = -127 >> scale;
+
+  for (int32_t offset = -128; offset <= 127; offset++) {
+    dac_cw_model_config_t config = { fstep, div, scale, (int8_t)offset, 0, 0 };
+    bool clipping = offset + top > 127 || offset + bottom < -128;
+
+    for (uint8_t invert = 0; invert < 4; invert++) {
+      dac_cw_model_stats_t stats;
+      config.invert = invert;
+      DacEspCwModel model(config);
+      uint8_t *codes = buffer[invert];
+
+      model.render(codes, 2 * period, 0, &stats);
+      // generator clock & period: 65536 / fstep ticks, not half of it
+      CHECK(model.getClockFrequency() == DAC_CW_MODEL_CK8M / (1 + div), "clock %u", model.getClockFrequency());
+      CHECK(fabs(model.getFrequency() * period - (double)DAC_CW_MODEL_CK8M / (1 + div)) < 1e-6, "frequency %f",
+            model.getFrequency());
+      bool half = period > 1;
+      for (uint32_t i = 0; i < period; i++) {
+        CHECK(codes[i + period] == codes[i], "tick %u: %u, one period later %u", i, codes[i], codes[i + period]);
+        half = half && codes[(i + period / 2) % period] == codes[i];
+      }
+      CHECK(!half, "periodic with %u ticks already", period / 2);
+
+      // DC offset saturates (phase 0 = cosine top, half period = bottom)
+      CHECK((stats.clipped > 0) == clipping, "%u samples clipped", stats.clipped);
+      CHECK(decode(codes[0], invert) == clamp(offset + top, -128, 127), "top %d", decode(codes[0], invert));
+      if (period > 1) {
+        CHECK(decode(codes[period / 2], invert) == clamp(offset + bottom, -128, 127), "bottom %d",
+              decode(codes[period / 2], invert));
+      }
+      if (invert == 2) {
+        CHECK(codes[0] == clamp(128 + offset + top, 0, 255), "top code %u", codes[0]);
+        CHECK(offset + top <= 127 || stats.max == 255, "max code %u", stats.max);
+        CHECK(offset + bottom >= -128 || stats.min == 0, "min code %u", stats.min);
+      }
+
+      // peak to peak, compared with the previous SCALE if neither clips
+      int32_t low = 127, high = -128;
+      for (uint32_t i = 0; i < period; i++) {
+        low = decode(codes[i], invert) < low ? decode(codes[i], invert) : low;
+        high = decode(codes[i], invert) > high ? decode(codes[i], invert) : high;
+      }
+      if (scale > 0 && !clipping && p2p[offset + 128][invert] >= 0) {
+        CHECK(abs(2 * (high - low) - p2p[offset + 128][invert]) <= 1, "peak to peak %d, previous scale %d",
+              high - low, p2p[offset + 128][invert]);
+      }
+      p2p[offset + 128][invert] = clipping ? -1 : high - low;
+    }
+
+    // INV modes only differ in the bits flipped: all, MSB, all but MSB
+    for (uint32_t i = 0; i < 2 * period; i++) {
+      CHECK(buffer[1][i] == (buffer[0][i] ^ 0xFF), "tick %u: INVERT_ALL %02x, NONE %02x", i, buffer[1][i],
+            buffer[0][i]);
+      CHECK(buffer[2][i] == (buffer[0][i] ^ 0x80), "tick %u: INVERT_MSB %02x, NONE %02x", i, buffer[2][i],
+            buffer[0][i]);
+      CHECK(buffer[3][i] == (buffer[0][i] ^ 0x7F), "tick %u: INVERT_NOT_MSB %02x, NONE %02x", i, buffer[3][i],
+            buffer[0][i]);
+    }
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  uint32_t cases = argc > 1 ? (uint32_t)atol(argv[1]) : 1000UL;
+  uint32_t seed = argc > 2 ? (uint32_t)atol(argv[2]) : 1;
+  std::mt19937 rng(seed);
+  uint64_t checked = 0;
+  static int32_t p2p[256][4];
+
+  // period: every SW_FSTEP up to 1024, powers of two & random ones up to 32512
+  // (at least one sample per negative half wave needed to see the crossing)
+  for (uint32_t fstep = 1; fstep <= 1024; fstep++) {
+    checkPeriod(fstep);
+    checked++;
+  }
+  for (uint32_t fstep = 2048; fstep < 32768; fstep <<= 1) {
+    checkPeriod(fstep);
+    checked++;
+  }
+  for (uint32_t i = 0; i < cases; i++) {
+    checkPeriod(1025 + rng() % (32512 - 1024));
+    checked++;
+  }
+
+  // every CK8M_DIV_SEL, SCALE, DC offset & INV combination for SW_FSTEP values with
+  // a whole number of ticks per period, 256 ticks at most (the period check above
+  // covers the others, the samples of a setting do not depend on SW_FSTEP)
+  for (uint32_t fstep = 256; fstep <= 32768; fstep <<= 1) {
+    for (uint8_t div = 0; div < 8; div++) {
+      for (uint8_t scale = 0; scale < 4; scale++) {
+        checkScale(fstep, div, scale, p2p);
+        checked += 256 * 4;
+      }
+    }
+  }
+  printf("%llu settings checked (seed %u), %llu failures\n", (unsigned long long)checked, seed,
+         (unsigned long long)failures);
+
+  return failures ? 1 : 0;
+}
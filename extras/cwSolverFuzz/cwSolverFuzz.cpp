@@ -0,0 +1,267 @@
+/*
+  cwSolverFuzz, host tool of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Property test of the CW frequency solver (src/DacEspCwSolver.cpp, compiled
+  into this file). For edge and random targets, clocks and limits it checks
+  that solve() terminates within (divMax + 1) * fstepMax search steps, finds
+  a setting exactly when one exists, that the setting is within range and
+  consistent with its reported frequency, and that it is the same globally
+  optimal setting a brute force search over all settings picks. Results of
+  solveFractional() are checked for range, accuracy and CK8M_DIV_SEL choice.
+  Both solvers must only use CK8M_DIV_SEL values in divAllowed.
+
+  Build & run on a host (from this directory):
+    g++ -O2 -I../../src cwSolverFuzz.cpp -o cwSolverFuzz
+    ./cwSolverFuzz [random cases (100000)] [seed (1)]
+  or as libFuzzer target (12 byte inputs: frequency, RTC8M_CLK, limits):
+    clang++ -O1 -g -fsanitize=fuzzer,address,undefined -DCW_SOLVER_LIBFUZZER -I../../src cwSolverFuzz.cpp -o cwSolverFuzzer
+    ./cwSolverFuzzer -max_len=12
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <random>
+
+// count the search steps of the solver, it gets compiled into this file
+static uint32_t iterations;
+#define DAC_CW_SOLVER_ITERATION() (iterations++)
+#include "../../src/DacEspCwSolver.cpp"
+
+static uint64_t failures;
+
+#define CHECK(cond, ...)                                                              \
+  do {                                                                                \
+    if (!(cond)) {                                                                    \
+      if (failures++ < 20) {                                                          \
+        printf("FAIL %s: f %u ck8m %u divMax %u fstepMax %u divAllowed %02x: ",       \
+               #cond, frequency, params.ck8m, params.divMax, params.fstepMax,         \
+               params.divAllowed);                                                    \
+        printf(__VA_ARGS__);                                                          \
+        printf("\n");                                                                 \
+      }                                                                               \
+      return;                                                                         \
+    }                                                                                 \
+  } while (0)
+
+//
+// Reference: try every allowed setting. Same tie-break as the solver (lowest
+// CK8M_DIV_SEL, then lowest SW_FSTEP), a setting counts if it deviates by
+// no more than the biggest step size (ck8m / 65536).
+//
+static bool bruteForce(uint32_t frequency, const dac_cw_solver_params_t &params, uint8_t *div, uint16_t *fstep,
+                       uint32_t *delta)
+{
+  uint64_t best = (uint64_t)(params.ck8m >> 16) + 1;
+
+  for (uint32_t d = 0; d <= params.divMax; d++) {
+    if (params.divAllowed && !(params.divAllowed & (1U << d))) {
+      continue;
+    }
+    for (uint32_t s = 1; s <= params.fstepMax; s++) {
+      uint32_t fcw = DacEspCwSolver::outputFrequency(params.ck8m, d, s);
+      uint64_t dtemp = (fcw > frequency) ? fcw - frequency : frequency - fcw;
+      if (dtemp < best) {
+        best = dtemp;
+        *div = d;
+        *fstep = s;
+      }
+    }
+  }
+  *delta = (uint32_t)best;
+  return best <= (params.ck8m >> 16);
+}
+
+//
+// Check all properties of solve() & solveFractional() for one case.
+//
+static void checkCase(uint32_t frequency, const dac_cw_solver_params_t &params)
+{
+  dac_cw_solution_t solution;
+  uint8_t refDiv = 0;
+  uint16_t refStep = 0;
+  uint32_t refDelta = 0;
+
+  iterations = 0;
+  bool found = DacEspCwSolver::solve(frequency, params, &solution);
+  bool refFound = (frequency != 0 && params.ck8m != 0) && bruteForce(frequency, params, &refDiv, &refStep, &refDelta);
+
+  // terminates within (divMax + 1) * fstepMax search steps
+  CHECK(iterations <= (params.divMax + 1UL) * params.fstepMax, "%u iterations", iterations);
+  CHECK(found == refFound, "solver %d, reference %d (div %u fstep %u delta %u)", found, refFound, refDiv, refStep,
+        refDelta);
+  if (found) {
+    uint32_t fcw = DacEspCwSolver::outputFrequency(params.ck8m, solution.clk8mDiv, solution.frequencyStep);
+    uint32_t delta = (fcw > frequency) ? fcw - frequency : frequency - fcw;
+    // setting within range & consistent
+    CHECK(solution.clk8mDiv <= params.divMax, "div %u", solution.clk8mDiv);
+    CHECK(DAC_CW_SOLVER_DIV_ALLOWED(params, solution.clk8mDiv), "div %u not allowed", solution.clk8mDiv);
+    CHECK(solution.frequencyStep >= 1 && solution.frequencyStep <= params.fstepMax, "fstep %u",
+          solution.frequencyStep);
+    CHECK(solution.fcw == fcw, "fcw %u, setting gives %u", solution.fcw, fcw);
+    CHECK(solution.deltaAbs == delta, "deltaAbs %u, setting gives %u", solution.deltaAbs, delta);
+    // globally optimal, same choice among equally good settings
+    CHECK(delta == refDelta, "delta %u (div %u fstep %u), best %u (div %u fstep %u)", delta, solution.clk8mDiv,
+          solution.frequencyStep, refDelta, refDiv, refStep);
+    CHECK(solution.clk8mDiv == refDiv && solution.frequencyStep == refStep, "div %u fstep %u, reference div %u fstep %u",
+          solution.clk8mDiv, solution.frequencyStep, refDiv, refStep);
+  }
+
+  // fractional solver (target in mHz, same frequency + 0.5Hz)
+  dac_cw_frac_solution_t frac;
+  uint64_t milliHz = (uint64_t)frequency * 1000 + 500;
+  if (milliHz > UINT32_MAX || params.ck8m >= 17000000UL) {
+    return;
+  }
+  uint32_t target = (uint32_t)milliHz;
+  if (DacEspCwSolver::solveFractional(target, params, &frac)) {
+    CHECK(frac.clk8mDiv <= params.divMax, "frac div %u", frac.clk8mDiv);
+    CHECK(DAC_CW_SOLVER_DIV_ALLOWED(params, frac.clk8mDiv), "frac div %u not allowed", frac.clk8mDiv);
+    CHECK(frac.frequencyStep >= 1 && frac.frequencyStep + (frac.fraction ? 1UL : 0UL) <= params.fstepMax,
+          "frac fstep %u fraction %u", frac.frequencyStep, frac.fraction);
+    // average within 1mHz + truncation of the lower setting
+    int64_t error = (int64_t)frac.fcwMilliHz - target;
+    CHECK(error <= 1 && error >= -2, "frac %u mHz, error %lld mHz", frac.fcwMilliHz, (long long)error);
+    // highest CK8M_DIV_SEL possible is used
+    for (uint32_t d = frac.clk8mDiv + 1; d <= params.divMax; d++) {
+      if (!DAC_CW_SOLVER_DIV_ALLOWED(params, d)) {
+        continue;
+      }
+      uint64_t fstep = (uint64_t)target * ((uint64_t)(1 + d) << 16) / ((uint64_t)params.ck8m * 1000);
+      CHECK(fstep == 0 || fstep + 1 > params.fstepMax, "div %u would allow fstep %llu", d, (unsigned long long)fstep);
+    }
+  }
+}
+
+//
+// Decode fuzzer input: frequency, ck8m, divMax, fstepMax, divAllowed (12 bytes, little endian).
+//
+static bool decodeCase(const uint8_t *data, size_t size, uint32_t *frequency, dac_cw_solver_params_t *params)
+{
+  if (size < 12) {
+    return false;
+  }
+  memcpy(frequency, data, 4);
+  memcpy(&params->ck8m, data + 4, 4);
+  params->divMax = data[8] & 7;
+  params->fstepMax = (uint16_t)(data[9] | (data[10] << 8));
+  params->divAllowed = data[11];
+  // RTC8M_CLK 1...16.7MHz, brute force needs fstepMax limited
+  params->ck8m = 1000000UL + params->ck8m % 15700000UL;
+  params->fstepMax = 1 + params->fstepMax % 4096;
+  return true;
+}
+
+#ifdef CW_SOLVER_LIBFUZZER
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+  uint32_t frequency;
+  dac_cw_solver_params_t params;
+
+  if (decodeCase(data, size, &frequency, &params)) {
+    checkCase(frequency, params);
+    if (failures) {
+      abort();
+    }
+  }
+  return 0;
+}
+
+#else
+
+int main(int argc, char *argv[])
+{
+  uint32_t cases = argc > 1 ? (uint32_t)atol(argv[1]) : 100000UL;
+  uint32_t seed = argc > 2 ? (uint32_t)atol(argv[2]) : 1;
+  std::mt19937 rng(seed);
+  uint64_t checked = 0;
+  const uint32_t clocks[] = { 8000000UL, 8123456UL, 8454000UL, 7800000UL, 1000000UL, 16700000UL };
+  const uint16_t fstepMaxes[] = { 1, 2, 255, 256, 257, 512, 1024 };
+  // divMax & divAllowed, the last ones skip dividers like DacEspArbiter constraints do
+  const struct { uint8_t divMax, divAllowed; } limits[] = { { 0, 0 }, { 1, 0 }, { 7, 0 }, { 7, 0x06 }, { 7, 0xA1 } };
+
+  // edge cases: every setting of the default configurations & its neighbours, range limits
+  for (uint32_t ck8m : clocks) {
+    for (uint16_t fstepMax : fstepMaxes) {
+      for (auto limit : limits) {
+        dac_cw_solver_params_t params = { ck8m, limit.divMax, fstepMax, limit.divAllowed };
+        uint32_t top = DacEspCwSolver::outputFrequency(ck8m, 0, fstepMax);
+        for (uint32_t frequency : { 0UL, 1UL, 2UL, (unsigned long)(ck8m >> 16), (unsigned long)top,
+                                    (unsigned long)(top + (ck8m >> 16)), (unsigned long)(top + (ck8m >> 16) + 1),
+                                    0xFFFFFFFFUL, 0xFFFFFFFFUL - (ck8m >> 16) }) {
+          checkCase(frequency, params);
+          checked++;
+        }
+        if (fstepMax > 256) {
+          continue;
+        }
+        for (uint32_t div = 0; div <= params.divMax; div++) {
+          for (uint32_t fstep = 1; fstep <= fstepMax; fstep++) {
+            uint32_t fcw = DacEspCwSolver::outputFrequency(ck8m, div, fstep);
+            for (uint32_t frequency = fcw - 1; frequency <= fcw + 1; frequency++) {
+              checkCase(frequency, params);
+              checked++;
+            }
+          }
+        }
+      }
+    }
+  }
+  // RTC8M_CLK near UINT32_MAX: targets where frequency + step size exceeds 32 bit
+  for (uint8_t divMax : { 0, 1 }) {
+    dac_cw_solver_params_t params = { 0xFFFFFFFFUL, divMax, 0xFFFF, 0 };
+    uint32_t top = DacEspCwSolver::outputFrequency(params.ck8m, 0, params.fstepMax);
+    uint32_t step = params.ck8m >> 16;
+    for (uint32_t frequency : { top - 1, top, top + 1, UINT32_MAX - step - 1, UINT32_MAX - step, UINT32_MAX - 1,
+                                UINT32_MAX }) {
+      checkCase(frequency, params);
+      checked++;
+    }
+  }
+  printf("%llu edge cases checked\n", (unsigned long long)checked);
+
+  // random cases
+  for (uint32_t i = 0; i < cases; i++) {
+    uint8_t data[12];
+    uint32_t frequency;
+    dac_cw_solver_params_t params;
+
+    for (uint8_t &b : data) {
+      b = (uint8_t)rng();
+    }
+    decodeCase(data, sizeof(data), &frequency, &params);
+    // mostly targets within the output range
+    if (rng() % 8) {
+      frequency %= DacEspCwSolver::outputFrequency(params.ck8m, 0, params.fstepMax) + 2 * (params.ck8m >> 16);
+    }
+    checkCase(frequency, params);
+  }
+  printf("%u random cases checked (seed %u), %llu failures\n", cases, seed, (unsigned long long)failures);
+
+  return failures ? 1 : 0;
+}
+
+#endif
@@ -0,0 +1,147 @@
+/*
+  cwSpectrum, host tool of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Tabulates THD & SFDR of the CW generator output for every (CK8M_DIV_SEL,
+  SW_FSTEP) pair. The output sequence gets rendered by DacEspCwModel over
+  an integer number of periods (one sample per generator clock, each held
+  for <oversample> samples to include the images of the sample & hold) and
+  analyzed with an FFT. The spectrum relative to the generator clock only
+  depends on SW_FSTEP, hence it is calculated once per SW_FSTEP and listed
+  for every divider.
+
+  Build & run on a host (from this directory):
+    g++ -O2 -I../../src cwSpectrum.cpp ../../src/DacEspCwModel.cpp -o cwSpectrum
+    ./cwSpectrum [fstepMax (256)] [scale (0)] [oversample (4)] > table.txt
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <complex>
+#include <vector>
+#include "DacEspCwModel.h"
+
+#define DIV_MAX      7
+#define HARMONICS_MAX 10
+
+typedef std::complex<double> cplx;
+
+//
+// In-place radix-2 FFT, size must be a power of 2.
+//
+static void fft(std::vector<cplx> &x)
+{
+  size_t n = x.size();
+
+  for (size_t i = 1, j = 0; i < n; i++) {
+    size_t bit = n >> 1;
+    for (; j & bit; bit >>= 1) j ^= bit;
+    j ^= bit;
+    if (i < j) std::swap(x[i], x[j]);
+  }
+  for (size_t len = 2; len <= n; len <<= 1) {
+    cplx wlen = std::polar(1.0, -2 * M_PI / len);
+    for (size_t i = 0; i < n; i += len) {
+      cplx w(1);
+      for (size_t k = 0; k < len / 2; k++) {
+        cplx u = x[i + k], v = x[i + k + len / 2] * w;
+        x[i + k] = u + v;
+        x[i + k + len / 2] = u - v;
+        w *= wlen;
+      }
+    }
+  }
+}
+
+//
+// Analyze output for one SW_FSTEP. Returns THD & SFDR in dB.
+//
+static void analyze(uint16_t fstep, uint8_t scale, unsigned oversample, double *thd, double *sfdr)
+{
+  dac_cw_model_config_t config = { fstep, 0, scale, 0, 2, 0 };
+  DacEspCwModel model(config);
+
+  // phase accumulator returns to its start value after 65536 / (fstep & -fstep) clocks
+  uint32_t clocks = 65536 / (fstep & -fstep);
+  uint32_t cycles = fstep / (fstep & -fstep);
+  std::vector<uint8_t> codes(clocks);
+  model.render(codes.data(), clocks);
+
+  size_t n = (size_t)clocks * oversample;
+  std::vector<cplx> x(n);
+  for (size_t i = 0; i < n; i++) {
+    x[i] = codes[i / oversample];
+  }
+  fft(x);
+
+  // power spectrum up to nyquist, fundamental is in bin 'cycles'
+  size_t half = n / 2;
+  std::vector<double> p(half + 1);
+  for (size_t i = 0; i <= half; i++) {
+    p[i] = std::norm(x[i]);
+  }
+  double fundamental = p[cycles];
+
+  double harmonics = 0;
+  for (unsigned h = 2; h <= HARMONICS_MAX; h++) {
+    size_t bin = ((size_t)h * cycles) % n;
+    if (bin > half) bin = n - bin;   // aliased
+    if (bin != 0 && bin != cycles) harmonics += p[bin];
+  }
+  double spur = 0;
+  for (size_t i = 1; i <= half; i++) {
+    if (i != cycles && p[i] > spur) spur = p[i];
+  }
+
+  *thd = harmonics > 0 ? 10 * log10(harmonics / fundamental) : -999;
+  *sfdr = spur > 0 ? 10 * log10(fundamental / spur) : 999;
+}
+
+int main(int argc, char *argv[])
+{
+  unsigned fstepMax   = argc > 1 ? atoi(argv[1]) : 256;
+  unsigned scale      = argc > 2 ? atoi(argv[2]) : 0;
+  unsigned oversample = argc > 3 ? atoi(argv[3]) : 4;
+
+  if (fstepMax < 1 || fstepMax > 65535 || scale > 3 || oversample < 1 || (oversample & (oversample - 1))) {
+    fprintf(stderr, "usage: %s [fstepMax 1..65535] [scale 0..3] [oversample power of 2]\n", argv[0]);
+    return 1;
+  }
+
+  std::vector<double> thd(fstepMax + 1), sfdr(fstepMax + 1);
+  for (unsigned fstep = 1; fstep <= fstepMax; fstep++) {
+    analyze(fstep, scale, oversample, &thd[fstep], &sfdr[fstep]);
+  }
+
+  printf("# CW generator spectral purity, RTC8M_CLK=%lu Hz, scale=%u, oversample=%u\n", DAC_CW_MODEL_CK8M, scale, oversample);
+  printf("# div fstep        fcw  steps/cycle  THD(dB)  SFDR(dB)\n");
+  for (unsigned div = 0; div <= DIV_MAX; div++) {
+    for (unsigned fstep = 1; fstep <= fstepMax; fstep++) {
+      double fcw = (double)DAC_CW_MODEL_CK8M / (1 + div) * fstep / 65536;
+      printf("%5u %5u %10.2f %12.1f %8.1f %9.1f\n", div, fstep, fcw, 65536.0 / fstep, thd[fstep], sfdr[fstep]);
+    }
+  }
+
+  return 0;
+}
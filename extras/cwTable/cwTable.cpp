@@ -0,0 +1,174 @@
+/*
+  cwTable, binary CW generator frequency table of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Query functions for binary CW generator frequency tables (host only,
+  POSIX). See cwTable.h for the file format.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "cwTable.h"
+
+CwTable::CwTable()
+  : m_map(NULL), m_size(0), m_header(NULL), m_records(NULL)
+{
+}
+
+CwTable::~CwTable()
+{
+  close();
+}
+
+//
+// Map a table file into memory & check its header.
+//
+bool CwTable::open(const char *path)
+{
+  struct stat st;
+  int fd;
+
+  close();
+  if ((fd = ::open(path, O_RDONLY)) < 0) {
+    perror(path);
+    return false;
+  }
+  if (fstat(fd, &st) < 0 || (size_t)st.st_size < sizeof(cw_table_header_t)) {
+    fprintf(stderr, "%s: not a CW table\n", path);
+    ::close(fd);
+    return false;
+  }
+  m_map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (m_map == MAP_FAILED) {
+    perror(path);
+    m_map = NULL;
+    return false;
+  }
+  m_size = st.st_size;
+
+  const cw_table_header_t *header = (const cw_table_header_t *)m_map;
+  if (header->magic != CW_TABLE_MAGIC || header->version != CW_TABLE_VERSION ||
+      header->headerSize < sizeof(cw_table_header_t) ||
+      m_size < header->headerSize + (size_t)header->count * sizeof(cw_table_record_t)) {
+    fprintf(stderr, "%s: not a CW table or unsupported version\n", path);
+    close();
+    return false;
+  }
+  m_header = header;
+  m_records = (const cw_table_record_t *)((const uint8_t *)m_map + header->headerSize);
+
+  return true;
+}
+
+void CwTable::close()
+{
+  if (m_map != NULL) {
+    munmap(m_map, m_size);
+  }
+  m_map = NULL;
+  m_size = 0;
+  m_header = NULL;
+  m_records = NULL;
+}
+
+//
+// Find the setting the solver returns for a target frequency.
+//
+const cw_table_record_t *CwTable::lookup(uint32_t target) const
+{
+  if (!m_header || !m_header->count || target < m_header->fmin || target > m_header->fmax) {
+    return NULL;
+  }
+
+  // last record with record.target <= target
+  size_t lo = 0, hi = m_header->count;
+  while (hi - lo > 1) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (m_records[mid].target <= target) lo = mid;
+    else hi = mid;
+  }
+  return &m_records[lo];
+}
+
+//
+// First record with fcw >= given frequency (count() if none).
+//
+size_t CwTable::lowerBoundFcw(uint32_t fcw) const
+{
+  size_t lo = 0, hi = count();
+  while (lo < hi) {
+    size_t mid = lo + (hi - lo) / 2;
+    if (m_records[mid].fcw < fcw) lo = mid + 1;
+    else hi = mid;
+  }
+  return lo;
+}
+
+//
+// Find the achievable setting with output frequency closest to a frequency.
+//
+const cw_table_record_t *CwTable::nearest(uint32_t frequency) const
+{
+  if (!count()) {
+    return NULL;
+  }
+
+  size_t i = lowerBoundFcw(frequency);
+  if (i == count()) {
+    return &m_records[i - 1];
+  }
+  if (i > 0 && frequency - m_records[i - 1].fcw <= m_records[i].fcw - frequency) {
+    return &m_records[i - 1];
+  }
+  return &m_records[i];
+}
+
+//
+// Range scan: all settings with fmin <= fcw <= fmax. Returns number of settings.
+//
+size_t CwTable::range(uint32_t fmin, uint32_t fmax, size_t *first, size_t *last) const
+{
+  *first = lowerBoundFcw(fmin);
+  *last = (fmax == UINT32_MAX) ? count() : lowerBoundFcw(fmax + 1);
+  if (*last < *first) {
+    *last = *first;
+  }
+  return *last - *first;
+}
+
+size_t CwTable::within(uint32_t frequency, uint32_t tolerance, size_t *first, size_t *last) const
+{
+  uint32_t fmin = (frequency > tolerance) ? frequency - tolerance : 0;
+  uint32_t fmax = (UINT32_MAX - frequency > tolerance) ? frequency + tolerance : UINT32_MAX;
+
+  return range(fmin, fmax, first, last);
+}
+
+uint32_t CwTable::lastTarget(size_t index) const
+{
+  return (index + 1 < count()) ? m_records[index + 1].target - 1 : m_header->fmax;
+}
@@ -0,0 +1,105 @@
+/*
+  cwTable, binary CW generator frequency table of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Compact binary CW generator frequency table & query functions (host).
+
+  A table holds the result of DacEspCwSolver for every target frequency
+  of a solver configuration. Consecutive target frequencies resolving to
+  the same setting are stored as one record, sorted by target frequency
+  (and by that also by output frequency fcw). All values little endian.
+
+    header  (32 bytes): magic "DCWT", version, header size, RTC8M_CLK,
+                        SW_FSTEP_MAX, CK8M_DIV_SEL max., first & last
+                        valid target frequency, number of records
+    records (12 bytes): first target frequency, fcw, SW_FSTEP, CK8M_DIV_SEL
+
+  The file gets mapped into memory (mmap), queries are binary searches.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef cwTable_h
+#define cwTable_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define CW_TABLE_MAGIC   0x54574344UL    // "DCWT"
+#define CW_TABLE_VERSION 1
+
+#pragma pack(push, 1)
+typedef struct {
+  uint32_t magic;           // CW_TABLE_MAGIC
+  uint16_t version;         // CW_TABLE_VERSION
+  uint16_t headerSize;      // sizeof(cw_table_header_t)
+  uint32_t ck8m;            // RTC8M_CLK assumed by solver (Hz)
+  uint16_t fstepMax;        // SW_FSTEP_MAX
+  uint8_t  divMax;          // highest CK8M_DIV_SEL (0: CW_FREQUENCY_HIGH_ACCURACY not defined)
+  uint8_t  reserved1;
+  uint32_t fmin;            // lowest valid target frequency
+  uint32_t fmax;            // highest valid target frequency
+  uint32_t count;           // number of records
+  uint32_t reserved2;
+} cw_table_header_t;
+
+typedef struct {
+  uint32_t target;          // first target frequency resolving to this setting
+  uint32_t fcw;             // output frequency (Hz, as calculated by solver)
+  uint16_t fstep;           // SENS_SW_FSTEP
+  uint8_t  div;             // RTC_CNTL_CK8M_DIV_SEL
+  uint8_t  reserved;
+} cw_table_record_t;
+#pragma pack(pop)
+
+// CwTable class, read only access to a table file
+class CwTable
+{
+  public:
+    CwTable();
+    ~CwTable();
+    bool   open(const char *path);
+    void   close(void);
+    const cw_table_header_t &header(void) const { return *m_header; };
+    size_t count(void) const { return m_header ? m_header->count : 0; };
+    const cw_table_record_t *record(size_t index) const { return &m_records[index]; };
+
+    // setting chosen by the solver for a target frequency (NULL if out of range)
+    const cw_table_record_t *lookup(uint32_t target) const;
+    // achievable setting with fcw closest to frequency
+    const cw_table_record_t *nearest(uint32_t frequency) const;
+    // index range [*first, *last) of settings with fmin <= fcw <= fmax
+    size_t range(uint32_t fmin, uint32_t fmax, size_t *first, size_t *last) const;
+    // settings with fcw within +-tolerance Hz of frequency
+    size_t within(uint32_t frequency, uint32_t tolerance, size_t *first, size_t *last) const;
+    // last target frequency resolving to the setting of a record
+    uint32_t lastTarget(size_t index) const;
+
+  private:
+    size_t lowerBoundFcw(uint32_t fcw) const;
+
+    void   *m_map;          // mapped file
+    size_t  m_size;         // size of mapped file
+    const cw_table_header_t *m_header;
+    const cw_table_record_t *m_records;
+};
+
+#endif
@@ -0,0 +1,290 @@
+/*
+  cwTableGen, CW generator frequency table generator of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Generates binary CW generator frequency tables (see cwTable.h) by
+  running the library's own solver (src/DacEspCwSolver.cpp) for every
+  target frequency. The frequency range gets split into chunks which are
+  solved by several threads, results are merged in chunk order, hence
+  the output does not depend on the number of threads. Host only
+  (little endian, POSIX).
+
+  Build (from this directory):
+    g++ -O2 -pthread -I../../src cwTableGen.cpp ../../src/DacEspCwSolver.cpp -o cwTableGen
+
+  Examples:
+    cwTableGen -s 256 table.bin             one table, all cores
+    cwTableGen -a -c 8000000,8254000 doc    all configurations for two RTC8M_CLK values
+    cwTableGen -b -s 512                    throughput with 1...n threads
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "DacEspCwSolver.h"
+#include "cwTable.h"
+
+#define CHUNK_SIZE 1024     // target frequencies solved per work item
+
+// result of one chunk of target frequencies
+typedef struct {
+  std::vector<cw_table_record_t> records;
+  uint32_t first;           // first valid target in chunk (0 = none)
+  uint32_t last;            // last valid target in chunk
+} chunk_t;
+
+static void usage(const char *name)
+{
+  fprintf(stderr, "usage: %s [-l] [-s fstepMax] [-c ck8m] [-j threads] output.bin\n"
+                  "       %s -a [-c ck8m[,ck8m...]] [-j threads] outputDir\n"
+                  "       %s -b [-l] [-s fstepMax] [-c ck8m]\n"
+                  "  -l  low accuracy (CW_FREQUENCY_HIGH_ACCURACY not defined)\n"
+                  "  -s  SW_FSTEP_MAX (default 256)\n"
+                  "  -c  RTC8M_CLK in Hz (default 8000000)\n"
+                  "  -j  number of threads (default: number of cores)\n"
+                  "  -a  all configurations (high/low accuracy, SW_FSTEP_MAX 128/256/512)\n"
+                  "  -b  benchmark: throughput with 1...n threads, nothing written\n", name, name, name);
+  exit(1);
+}
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+//
+// Solve all target frequencies of a chunk.
+//
+static void solveChunk(const dac_cw_solver_params_t &params, uint32_t from, uint32_t to, chunk_t *chunk)
+{
+  dac_cw_solution_t solution;
+
+  chunk->first = chunk->last = 0;
+  for (uint32_t f = from; f <= to; f++) {
+    if (!DacEspCwSolver::solve(f, params, &solution)) {
+      continue;
+    }
+    if (chunk->first == 0) chunk->first = f;
+    chunk->last = f;
+    if (chunk->records.empty() || chunk->records.back().fstep != solution.frequencyStep ||
+        chunk->records.back().div != solution.clk8mDiv) {
+      cw_table_record_t r = { f, solution.fcw, solution.frequencyStep, solution.clk8mDiv, 0 };
+      chunk->records.push_back(r);
+    }
+  }
+}
+
+//
+// Solve all target frequencies of a configuration with several threads &
+// merge the chunks in order. Returns number of target frequencies solved.
+//
+static uint32_t generate(const dac_cw_solver_params_t &params, unsigned threads,
+                         cw_table_header_t *header, std::vector<cw_table_record_t> *records)
+{
+  // no setting beyond the highest fcw + one step size
+  uint32_t fupper = DacEspCwSolver::outputFrequency(params.ck8m, 0, params.fstepMax) + (params.ck8m >> 16) + 2;
+  uint32_t chunks = (fupper + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  std::vector<chunk_t> results(chunks);
+  std::atomic<uint32_t> next(0);
+  std::vector<std::thread> pool;
+
+  for (unsigned t = 0; t < threads; t++) {
+    pool.push_back(std::thread([&]() {
+      uint32_t c;
+      while ((c = next++) < chunks) {
+        uint32_t from = c * CHUNK_SIZE + 1;
+        uint32_t to = (c + 1) * CHUNK_SIZE < fupper ? (c + 1) * CHUNK_SIZE : fupper;
+        solveChunk(params, from, to, &results[c]);
+      }
+    }));
+  }
+  for (auto &t : pool) {
+    t.join();
+  }
+
+  // merge, a record continuing over a chunk border gets joined
+  uint32_t fmin = 0, fmax = 0;
+  records->clear();
+  for (uint32_t c = 0; c < chunks; c++) {
+    const chunk_t &chunk = results[c];
+    if (chunk.first == 0) {
+      continue;
+    }
+    if (fmin == 0) fmin = chunk.first;
+    fmax = chunk.last;
+    for (size_t i = 0; i < chunk.records.size(); i++) {
+      const cw_table_record_t &r = chunk.records[i];
+      if (i == 0 && !records->empty() && records->back().fstep == r.fstep && records->back().div == r.div) {
+        continue;
+      }
+      records->push_back(r);
+    }
+  }
+
+  memset(header, 0, sizeof(*header));
+  header->magic = CW_TABLE_MAGIC;
+  header->version = CW_TABLE_VERSION;
+  header->headerSize = sizeof(*header);
+  header->ck8m = params.ck8m;
+  header->fstepMax = params.fstepMax;
+  header->divMax = params.divMax;
+  header->fmin = fmin;
+  header->fmax = fmax;
+  header->count = records->size();
+
+  return fupper;
+}
+
+//
+// Check solver output is sorted by fcw (needed for queries) & write table.
+//
+static bool writeTable(const char *path, const cw_table_header_t &header, const std::vector<cw_table_record_t> &records)
+{
+  for (size_t i = 1; i < records.size(); i++) {
+    if (records[i].fcw < records[i - 1].fcw) {
+      fprintf(stderr, "%s: solver output not monotonic at %u Hz\n", path, records[i].target);
+      return false;
+    }
+  }
+
+  FILE *out = fopen(path, "wb");
+  if (out == NULL) {
+    perror(path);
+    return false;
+  }
+  if (fwrite(&header, sizeof(header), 1, out) != 1 ||
+      fwrite(records.data(), sizeof(cw_table_record_t), records.size(), out) != records.size() ||
+      fclose(out) != 0) {
+    perror(path);
+    return false;
+  }
+  return true;
+}
+
+static bool generateTable(const dac_cw_solver_params_t &params, unsigned threads, const char *path)
+{
+  std::vector<cw_table_record_t> records;
+  cw_table_header_t header;
+
+  double t = now();
+  uint32_t solved = generate(params, threads, &header, &records);
+  t = now() - t;
+
+  if (!writeTable(path, header, records)) {
+    return false;
+  }
+  printf("%s: targets %u...%u Hz, %u records, %u bytes, %.0f solutions/s\n", path, header.fmin, header.fmax, header.count,
+         (uint32_t)(sizeof(header) + records.size() * sizeof(cw_table_record_t)), solved / t);
+
+  return true;
+}
+
+int main(int argc, char *argv[])
+{
+  dac_cw_solver_params_t params = { 8000000UL, 7, 256, 0 };
+  std::vector<uint32_t> clocks;
+  unsigned threads = std::thread::hardware_concurrency();
+  bool all = false, benchmark = false;
+  int opt;
+
+  while ((opt = getopt(argc, argv, "ls:c:j:ab")) != -1) {
+    switch (opt) {
+      case 'l': params.divMax = 0; break;
+      case 's': params.fstepMax = (uint16_t)atoi(optarg); break;
+      case 'c':
+        for (char *p = strtok(optarg, ","); p != NULL; p = strtok(NULL, ",")) {
+          clocks.push_back((uint32_t)strtoul(p, NULL, 0));
+        }
+        break;
+      case 'j': threads = atoi(optarg); break;
+      case 'a': all = true; break;
+      case 'b': benchmark = true; break;
+      default: usage(argv[0]);
+    }
+  }
+  if (clocks.empty()) {
+    clocks.push_back(params.ck8m);
+  }
+  if (threads == 0) {
+    threads = 1;
+  }
+  if (optind != argc - (benchmark ? 0 : 1) || params.fstepMax == 0 || (all && benchmark)) {
+    usage(argv[0]);
+  }
+  for (uint32_t ck8m : clocks) {
+    if (ck8m == 0) usage(argv[0]);
+  }
+
+  if (benchmark) {
+    // same configuration with increasing number of threads
+    std::vector<cw_table_record_t> records;
+    cw_table_header_t header;
+    double base = 0;
+    unsigned cores = std::thread::hardware_concurrency();
+
+    params.ck8m = clocks[0];
+    printf("%u cores, SW_FSTEP_MAX=%u, CK8M_DIV_SEL max.=%u, RTC8M_CLK=%u Hz\n", cores, params.fstepMax, params.divMax, params.ck8m);
+    for (unsigned n = 1; n <= (cores > threads ? cores : threads); n *= 2) {
+      double t = now();
+      uint32_t solved = generate(params, n, &header, &records);
+      double rate = solved / (now() - t);
+      if (n == 1) base = rate;
+      printf("threads %2u: %10.0f solutions/s, speedup %.2f\n", n, rate, rate / base);
+    }
+    return 0;
+  }
+
+  if (!all) {
+    params.ck8m = clocks[0];
+    return generateTable(params, threads, argv[optind]) ? 0 : 1;
+  }
+
+  // all configurations, file names as in doc/
+  const uint16_t fstepMax[] = { 128, 256, 512 };
+  for (uint32_t ck8m : clocks) {
+    for (int highAcc = 1; highAcc >= 0; highAcc--) {
+      for (uint16_t fs : fstepMax) {
+        char path[512];
+        dac_cw_solver_params_t p = { ck8m, (uint8_t)(highAcc ? 7 : 0), fs, 0 };
+        if (ck8m == 8000000UL) {
+          snprintf(path, sizeof(path), "%s/CW_generator_frequ_table_%s_Fstep%u.bin", argv[optind], highAcc ? "highAcc" : "lowAcc", fs);
+        }
+        else {
+          snprintf(path, sizeof(path), "%s/CW_generator_frequ_table_%s_Fstep%u_%uHz.bin", argv[optind], highAcc ? "highAcc" : "lowAcc", fs, ck8m);
+        }
+        if (!generateTable(p, threads, path)) {
+          return 1;
+        }
+      }
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,185 @@
+/*
+  cwTableQuery, CW generator frequency table query tool of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Command line tool answering queries on binary CW generator frequency
+  tables (see cwTable.h). Host only (POSIX).
+
+  Build (from this directory):
+    g++ -O2 cwTableQuery.cpp cwTable.cpp -o cwTableQuery
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <vector>
+#include "cwTable.h"
+
+static void usage(const char *name)
+{
+  fprintf(stderr, "usage: %s <table.bin> <command> [args]\n"
+                  "  lookup <f>            setting chosen by setCwFrequency(f)\n"
+                  "  nearest <f>           achievable frequency closest to f\n"
+                  "  within <f> <n>        all settings with fcw within f +-n Hz\n"
+                  "  range <f1> <f2>       all settings with f1 <= fcw <= f2\n"
+                  "  dump [f1 f2]          solver output per target frequency as text\n"
+                  "  bench [text table]    query timing (compared with searching the text table)\n", name);
+  exit(1);
+}
+
+static double stepSize(const cw_table_header_t &h, const cw_table_record_t *r)
+{
+  return ((double)h.ck8m / (1 + r->div)) / 65536;
+}
+
+static void print(const CwTable &table, const cw_table_record_t *r)
+{
+  printf("fcw=%u, clk8mDiv=%u, frequencyStep=%u, stepSize=%f, targets %u...%u\n",
+         r->fcw, r->div, r->fstep, stepSize(table.header(), r), r->target, table.lastTarget(r - table.record(0)));
+}
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+//
+// Time lookups in the binary table & the equivalent search in a text table.
+//
+static int bench(const CwTable &table, const char *textPath)
+{
+  const cw_table_header_t &h = table.header();
+  const int queries = 1000000;
+  volatile uint32_t sink = 0;
+
+  srand(1);
+  std::vector<uint32_t> targets(queries);
+  for (int i = 0; i < queries; i++) {
+    targets[i] = h.fmin + (uint32_t)rand() % (h.fmax - h.fmin + 1);
+  }
+
+  double t = now();
+  for (int i = 0; i < queries; i++) {
+    sink += table.lookup(targets[i])->fstep;
+  }
+  double tLookup = (now() - t) / queries;
+
+  t = now();
+  for (int i = 0; i < queries; i++) {
+    sink += table.nearest(targets[i])->fcw;
+  }
+  double tNearest = (now() - t) / queries;
+
+  printf("binary table: %u records, lookup %.1f ns, nearest %.1f ns per query\n",
+         h.count, tLookup * 1e9, tNearest * 1e9);
+
+  if (textPath == NULL) {
+    return 0;
+  }
+
+  // same as grep "ftarget=<f>," on the text table, file read once per query
+  const int textQueries = 20;
+  char pattern[32];
+  t = now();
+  for (int i = 0; i < textQueries; i++) {
+    FILE *in = fopen(textPath, "rb");
+    if (in == NULL) {
+      perror(textPath);
+      return 1;
+    }
+    std::vector<char> text;
+    char buffer[65536];
+    size_t n;
+    while ((n = fread(buffer, 1, sizeof(buffer), in)) > 0) {
+      text.insert(text.end(), buffer, buffer + n);
+    }
+    fclose(in);
+    text.push_back(0);
+    snprintf(pattern, sizeof(pattern), "ftarget=%u,", targets[i]);
+    sink += (strstr(text.data(), pattern) != NULL);
+  }
+  double tText = (now() - t) / textQueries;
+
+  printf("text table:   %.3f ms per query (%.0fx slower than binary lookup)\n", tText * 1e3, tText / tLookup);
+
+  return 0;
+}
+
+int main(int argc, char *argv[])
+{
+  CwTable table;
+
+  if (argc < 3) {
+    usage(argv[0]);
+  }
+  if (!table.open(argv[1])) {
+    return 1;
+  }
+
+  const char *cmd = argv[2];
+  const cw_table_header_t &h = table.header();
+  size_t first, last;
+
+  if (!strcmp(cmd, "lookup") && argc == 4) {
+    const cw_table_record_t *r = table.lookup(strtoul(argv[3], NULL, 0));
+    if (r == NULL) {
+      printf("frequency out of range (%u...%u Hz)\n", h.fmin, h.fmax);
+      return 1;
+    }
+    print(table, r);
+  }
+  else if (!strcmp(cmd, "nearest") && argc == 4) {
+    const cw_table_record_t *r = table.nearest(strtoul(argv[3], NULL, 0));
+    if (r != NULL) print(table, r);
+  }
+  else if (!strcmp(cmd, "within") && argc == 5) {
+    table.within(strtoul(argv[3], NULL, 0), strtoul(argv[4], NULL, 0), &first, &last);
+    for (size_t i = first; i < last; i++) print(table, table.record(i));
+  }
+  else if (!strcmp(cmd, "range") && argc == 5) {
+    table.range(strtoul(argv[3], NULL, 0), strtoul(argv[4], NULL, 0), &first, &last);
+    for (size_t i = first; i < last; i++) print(table, table.record(i));
+  }
+  else if (!strcmp(cmd, "dump") && (argc == 3 || argc == 5)) {
+    uint32_t f1 = (argc == 5) ? strtoul(argv[3], NULL, 0) : h.fmin;
+    uint32_t f2 = (argc == 5) ? strtoul(argv[4], NULL, 0) : h.fmax;
+    if (f1 < h.fmin) f1 = h.fmin;
+    if (f2 > h.fmax) f2 = h.fmax;
+    for (uint32_t f = f1; f <= f2 && f >= f1; f++) {
+      const cw_table_record_t *r = table.lookup(f);
+      printf("setCwFrequency(): ftarget=%u, fcw=%u, abs(delta)=%u, clk8mDiv=%u, frequencyStep=%u, stepSize=%f\n",
+             f, r->fcw, (r->fcw > f) ? r->fcw - f : f - r->fcw, r->div, r->fstep, stepSize(h, r));
+    }
+  }
+  else if (!strcmp(cmd, "bench") && (argc == 3 || argc == 4)) {
+    return bench(table, (argc == 4) ? argv[3] : NULL);
+  }
+  else {
+    usage(argv[0]);
+  }
+
+  return 0;
+}
@@ -0,0 +1,672 @@
+/*
+  DacEspHostSim, host runtime for the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Runtime of the host build of the DacESP32 library (extras/host). Backs
+  the stub headers in extras/host/include: FreeRTOS spinlocks & tasks on
+  POSIX threads, esp_timer, Arduino timing/logging/Serial, Preferences
+  kept in memory and a simulated RTC8M_CLK whose frequency follows
+  RTC_CNTL_CK8M_DFREQ in the emulated register file (src/DacEspHal.cpp).
+  Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "DacEspHostSim.h"
+#include <stdarg.h>
+#include <pthread.h>
+#include <sched.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <Preferences.h>
+#include "DacESP32.h"
+#include "DacEspRegs.h"
+
+// initialize static members of class
+uint32_t DacEspHostSim::m_ck8m = DAC_HOST_CK8M_DEFAULT;
+int32_t  DacEspHostSim::m_ck8mStep = DAC_HOST_CK8M_STEP_DEFAULT;
+int32_t  DacEspHostSim::m_calFailAfter = -1;
+uint32_t DacEspHostSim::m_calCount = 0;
+int      DacEspHostSim::m_logLevel = DACESP32_HOST_LOG_LEVEL;
+
+static const std::chrono::steady_clock::time_point s_start = std::chrono::steady_clock::now();
+
+static uint64_t elapsedUs()
+{
+  return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - s_start).count();
+}
+
+//
+// Reset the emulated registers to the state after ESP-IDF startup (RTC8M_CLK
+// running, RTC8M_D256_CLK off, CK8M_DFREQ default), drop the shadow copies of
+// DacEspRegs & restore the default clock model. Must not be called while
+// DacESP32 objects, the service, drift or fractional tasks/timers are active.
+//
+void DacEspHostSim::reset()
+{
+  DacEspHal::reset();
+  DacEspHal::write(RTC_CNTL_CLK_CONF_REG, RTC_CNTL_ENB_CK8M_DIV |
+                   ((uint32_t)DAC_HOST_DFREQ_DEFAULT << RTC_CNTL_CK8M_DFREQ_S));
+  for (int reg = 0; reg < DAC_REG_MAX; reg++) {
+    DacEspRegs::invalidate((dac_reg_t)reg);
+  }
+  DacEspRegs::resetStats();
+  m_ck8m = DAC_HOST_CK8M_DEFAULT;
+  m_ck8mStep = DAC_HOST_CK8M_STEP_DEFAULT;
+  m_calFailAfter = -1;
+  m_calCount = 0;
+}
+
+//
+// Set the clock model: RTC8M_CLK = frequency + (CK8M_DFREQ - 172) * step.
+//
+void DacEspHostSim::setCk8m(uint32_t frequency, int32_t step)
+{
+  m_ck8m = frequency;
+  m_ck8mStep = step;
+}
+
+//
+// Simulated RTC8M_CLK frequency for the current CK8M_DFREQ (Hz).
+//
+uint32_t DacEspHostSim::getCk8m()
+{
+  int32_t dfreq = REG_GET_FIELD(RTC_CNTL_CLK_CONF_REG, RTC_CNTL_CK8M_DFREQ);
+  int64_t frequency = (int64_t)m_ck8m + (int64_t)(dfreq - DAC_HOST_DFREQ_DEFAULT) * m_ck8mStep;
+
+  return frequency > 256 ? (uint32_t)frequency : 256;
+}
+
+//
+// Let rtc_clk_cal() fail (return 0) after count more successful calls.
+// Parameter: count...-1 never fails (default)
+//
+void DacEspHostSim::setCalFailAfter(int32_t count)
+{
+  m_calFailAfter = count;
+}
+
+// Preferences storage, key is "namespace/key"
+static std::mutex s_prefsLock;
+static std::map<std::string, uint32_t> s_prefs;
+
+//
+// Erase all values stored with Preferences.
+//
+void DacEspHostSim::clearPreferences()
+{
+  std::lock_guard<std::mutex> lock(s_prefsLock);
+  s_prefs.clear();
+}
+
+//
+// register access of the stub headers (soc/soc.h)
+//
+uint32_t dac_host_reg_read(uint32_t addr)
+{
+  return DacEspHal::read(addr);
+}
+
+void dac_host_reg_write(uint32_t addr, uint32_t value)
+{
+  DacEspHal::write(addr, value);
+}
+
+//
+// RTC clock functions (soc/rtc.h), see the ESP-IDF for their register usage
+//
+uint32_t rtc_clk_cal(rtc_cal_sel_t cal_clk, uint32_t slow_clk_cycles)
+{
+  DacEspHostSim::m_calCount++;
+  if (cal_clk != RTC_CAL_8MD256 || slow_clk_cycles == 0 || !rtc_clk_8md256_enabled()) {
+    return 0;
+  }
+  if (DacEspHostSim::m_calFailAfter >= 0) {
+    if (DacEspHostSim::m_calFailAfter == 0) {
+      return 0;
+    }
+    DacEspHostSim::m_calFailAfter--;
+  }
+  // period of RTC8M_CLK/256 in us, RTC_CLK_CAL_FRACT fractional bits
+  return (uint32_t)((256000000ULL << RTC_CLK_CAL_FRACT) / DacEspHostSim::getCk8m());
+}
+
+void rtc_clk_8m_enable(bool clk_8m_en, bool d256_en)
+{
+  uint32_t conf = REG_READ(RTC_CNTL_CLK_CONF_REG) & ~(RTC_CNTL_ENB_CK8M | RTC_CNTL_ENB_CK8M_DIV);
+
+  if (!clk_8m_en) {
+    conf |= RTC_CNTL_ENB_CK8M;
+  }
+  if (!clk_8m_en || !d256_en) {
+    conf |= RTC_CNTL_ENB_CK8M_DIV;
+  }
+  REG_WRITE(RTC_CNTL_CLK_CONF_REG, conf);
+}
+
+bool rtc_clk_8m_enabled()
+{
+  return GET_PERI_REG_MASK(RTC_CNTL_CLK_CONF_REG, RTC_CNTL_ENB_CK8M) == 0;
+}
+
+bool rtc_clk_8md256_enabled()
+{
+  return GET_PERI_REG_MASK(RTC_CNTL_CLK_CONF_REG, RTC_CNTL_ENB_CK8M_DIV) == 0;
+}
+
+//
+// FreeRTOS spinlocks (freertos/FreeRTOS.h). Owner is a per thread id, the
+// lock is recursive for its owner like portMUX on the ESP32.
+//
+static uint32_t threadId()
+{
+  static std::atomic<uint32_t> next(1);
+  static thread_local uint32_t id = next++;
+
+  return id;
+}
+
+void vPortEnterCritical(portMUX_TYPE *mux)
+{
+  uint32_t id = threadId();
+
+  if (__atomic_load_n(&mux->owner, __ATOMIC_ACQUIRE) == id) {
+    mux->count++;
+    return;
+  }
+  for (;;) {
+    uint32_t expected = portMUX_FREE_VAL;
+    if (__atomic_compare_exchange_n(&mux->owner, &expected, id, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+      break;
+    }
+    sched_yield();
+  }
+  mux->count = 1;
+}
+
+void vPortExitCritical(portMUX_TYPE *mux)
+{
+  if (__atomic_load_n(&mux->owner, __ATOMIC_RELAXED) != threadId() || mux->count == 0) {
+    dac_host_log(ARDUHAL_LOG_LEVEL_ERROR, __func__, "spinlock not held by caller");
+    abort();
+  }
+  if (--mux->count == 0) {
+    __atomic_store_n(&mux->owner, portMUX_FREE_VAL, __ATOMIC_RELEASE);
+  }
+}
+
+//
+// FreeRTOS tasks (freertos/task.h) on POSIX threads. Task control blocks
+// are never freed, so a late notification of a deleted task is harmless.
+//
+struct dac_host_task {
+  TaskFunction_t          code;
+  void                   *arg;
+  BaseType_t              core;
+  std::mutex              lock;
+  std::condition_variable cv;
+  uint32_t                notify;
+};
+
+static thread_local dac_host_task *s_task = NULL;   // task of the calling thread
+static thread_local bool s_inIsr = false;           // running an ESP_TIMER_ISR callback
+
+static dac_host_task *currentTask()
+{
+  if (s_task == NULL) {
+    s_task = new dac_host_task();
+    s_task->core = 0;
+    s_task->notify = 0;
+  }
+  return s_task;
+}
+
+static void *taskEntry(void *arg)
+{
+  s_task = (dac_host_task *)arg;
+  s_task->code(s_task->arg);
+  return NULL;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t code, const char *name, uint32_t stackDepth, void *arg,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core)
+{
+  dac_host_task *task = new dac_host_task();
+  pthread_t thread;
+  pthread_attr_t attr;
+
+  (void)name;
+  (void)stackDepth;
+  (void)priority;
+  task->code = code;
+  task->arg = arg;
+  task->core = (core >= 0 && core < portNUM_PROCESSORS) ? core : 0;
+  task->notify = 0;
+  if (handle != NULL) {
+    *handle = task;
+  }
+  pthread_attr_init(&attr);
+  pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
+  int result = pthread_create(&thread, &attr, taskEntry, task);
+  pthread_attr_destroy(&attr);
+  if (result != 0) {
+    if (handle != NULL) {
+      *handle = NULL;
+    }
+    delete task;
+    return pdFAIL;
+  }
+
+  return pdPASS;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t code, const char *name, uint32_t stackDepth, void *arg,
+                       UBaseType_t priority, TaskHandle_t *handle)
+{
+  return xTaskCreatePinnedToCore(code, name, stackDepth, arg, priority, handle, tskNO_AFFINITY);
+}
+
+void vTaskDelete(TaskHandle_t task)
+{
+  if (task != NULL && task != s_task) {
+    dac_host_log(ARDUHAL_LOG_LEVEL_ERROR, __func__, "only self deletion is supported");
+    abort();
+  }
+  pthread_exit(NULL);
+}
+
+void vTaskDelay(TickType_t ticks)
+{
+  if (ticks == 0) {
+    sched_yield();
+    return;
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds((uint64_t)ticks * portTICK_PERIOD_MS));
+}
+
+void vTaskDelayUntil(TickType_t *previousWakeTime, TickType_t increment)
+{
+  *previousWakeTime += increment;
+  TickType_t now = xTaskGetTickCount();
+  if ((int32_t)(*previousWakeTime - now) > 0) {
+    vTaskDelay(*previousWakeTime - now);
+  }
+}
+
+TickType_t xTaskGetTickCount()
+{
+  return (TickType_t)(elapsedUs() / 1000 / portTICK_PERIOD_MS);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle()
+{
+  return currentTask();
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait)
+{
+  dac_host_task *task = currentTask();
+  std::unique_lock<std::mutex> lock(task->lock);
+
+  if (ticksToWait == portMAX_DELAY) {
+    task->cv.wait(lock, [task] { return task->notify != 0; });
+  }
+  else {
+    task->cv.wait_for(lock, std::chrono::milliseconds((uint64_t)ticksToWait * portTICK_PERIOD_MS),
+                      [task] { return task->notify != 0; });
+  }
+  uint32_t value = task->notify;
+  if (value != 0) {
+    task->notify = clearCountOnExit ? 0 : value - 1;
+  }
+
+  return value;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task)
+{
+  {
+    std::lock_guard<std::mutex> lock(task->lock);
+    task->notify++;
+  }
+  task->cv.notify_one();
+
+  return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higherPriorityTaskWoken)
+{
+  xTaskNotifyGive(task);
+  if (higherPriorityTaskWoken != NULL) {
+    *higherPriorityTaskWoken = pdFALSE;
+  }
+}
+
+BaseType_t xPortGetCoreID()
+{
+  return s_task != NULL ? s_task->core : 0;
+}
+
+BaseType_t xPortInIsrContext()
+{
+  return s_inIsr ? pdTRUE : pdFALSE;
+}
+
+//
+// esp_timer (esp_timer.h). Every timer has an own thread running its
+// callbacks, ESP_TIMER_ISR callbacks run with xPortInIsrContext() true.
+//
+struct esp_timer {
+  esp_timer_cb_t          callback;
+  void                   *arg;
+  bool                    isr;
+  std::thread             thread;
+  std::mutex              lock;
+  std::condition_variable cv;
+  bool                    armed;
+  bool                    deleted;
+  uint32_t                generation;   // incremented on every start/stop
+  uint64_t                period;       // us, 0 for one shot
+  std::chrono::steady_clock::time_point due;
+};
+
+static void timerThread(esp_timer_handle_t timer)
+{
+  std::unique_lock<std::mutex> lock(timer->lock);
+
+  for (;;) {
+    timer->cv.wait(lock, [timer] { return timer->armed || timer->deleted; });
+    if (timer->deleted) {
+      return;
+    }
+    uint32_t generation = timer->generation;
+    if (timer->cv.wait_until(lock, timer->due, [timer, generation] {
+          return timer->deleted || timer->generation != generation; })) {
+      continue;   // stopped, restarted or deleted meanwhile
+    }
+    if (timer->period != 0) {
+      timer->due += std::chrono::microseconds(timer->period);
+    }
+    else {
+      timer->armed = false;
+    }
+    lock.unlock();
+    s_inIsr = timer->isr;
+    timer->callback(timer->arg);
+    s_inIsr = false;
+    lock.lock();
+  }
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *create_args, esp_timer_handle_t *out_handle)
+{
+  if (create_args == NULL || create_args->callback == NULL || out_handle == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  esp_timer_handle_t timer = new esp_timer();
+  timer->callback = create_args->callback;
+  timer->arg = create_args->arg;
+  timer->isr = create_args->dispatch_method == ESP_TIMER_ISR;
+  timer->armed = false;
+  timer->deleted = false;
+  timer->generation = 0;
+  timer->period = 0;
+  timer->thread = std::thread(timerThread, timer);
+  *out_handle = timer;
+
+  return ESP_OK;
+}
+
+static esp_err_t timerStart(esp_timer_handle_t timer, uint64_t us, bool periodic)
+{
+  if (timer == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  {
+    std::lock_guard<std::mutex> lock(timer->lock);
+    if (timer->armed) {
+      return ESP_ERR_INVALID_STATE;
+    }
+    timer->armed = true;
+    timer->generation++;
+    timer->period = periodic ? (us ? us : 1) : 0;
+    timer->due = std::chrono::steady_clock::now() + std::chrono::microseconds(us);
+  }
+  timer->cv.notify_one();
+
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us)
+{
+  return timerStart(timer, timeout_us, false);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period)
+{
+  return timerStart(timer, period, true);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer)
+{
+  if (timer == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  {
+    std::lock_guard<std::mutex> lock(timer->lock);
+    if (!timer->armed) {
+      return ESP_ERR_INVALID_STATE;
+    }
+    timer->armed = false;
+    timer->generation++;
+  }
+  timer->cv.notify_one();
+
+  return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer)
+{
+  if (timer == NULL) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  {
+    std::lock_guard<std::mutex> lock(timer->lock);
+    if (timer->armed) {
+      return ESP_ERR_INVALID_STATE;
+    }
+    timer->deleted = true;
+  }
+  timer->cv.notify_one();
+  timer->thread.join();
+  delete timer;
+
+  return ESP_OK;
+}
+
+int64_t esp_timer_get_time()
+{
+  return (int64_t)elapsedUs();
+}
+
+//
+// Arduino core functions (Arduino.h)
+//
+unsigned long millis()
+{
+  return (unsigned long)(elapsedUs() / 1000);
+}
+
+unsigned long micros()
+{
+  return (unsigned long)elapsedUs();
+}
+
+void delay(uint32_t ms)
+{
+  std::this_thread::sleep_for(std::chrono::milliseconds(ms));
+}
+
+void delayMicroseconds(uint32_t us)
+{
+  std::this_thread::sleep_for(std::chrono::microseconds(us));
+}
+
+uint32_t getCpuFrequencyMhz()
+{
+  return 240;
+}
+
+void dac_host_log(int level, const char *func, const char *format, ...)
+{
+  static const char tag[] = "?EWIDV";
+  va_list args;
+
+  if (level > DacEspHostSim::getLogLevel()) {
+    return;
+  }
+  fprintf(stderr, "[%c] %s(): ", tag[level], func);
+  va_start(args, format);
+  vfprintf(stderr, format, args);
+  va_end(args);
+  fputc('\n', stderr);
+}
+
+HardwareSerial Serial;
+
+size_t HardwareSerial::print(const char *text)            { return fputs(text, stdout) < 0 ? 0 : strlen(text); }
+size_t HardwareSerial::print(int value)                   { return printf("%d", value); }
+size_t HardwareSerial::print(unsigned int value)          { return printf("%u", value); }
+size_t HardwareSerial::print(long value)                  { return printf("%ld", value); }
+size_t HardwareSerial::print(unsigned long value)         { return printf("%lu", value); }
+size_t HardwareSerial::print(double value, int digits)    { return printf("%.*f", digits, value); }
+size_t HardwareSerial::println()                          { return print("\r\n"); }
+size_t HardwareSerial::println(const char *text)          { return print(text) + println(); }
+size_t HardwareSerial::println(int value)                 { return print(value) + println(); }
+size_t HardwareSerial::println(unsigned int value)        { return print(value) + println(); }
+size_t HardwareSerial::println(long value)                { return print(value) + println(); }
+size_t HardwareSerial::println(unsigned long value)       { return print(value) + println(); }
+size_t HardwareSerial::println(double value, int digits)  { return print(value, digits) + println(); }
+size_t HardwareSerial::write(const uint8_t *buffer, size_t size) { return fwrite(buffer, 1, size, stdout); }
+void   HardwareSerial::flush()                            { fflush(stdout); }
+
+size_t HardwareSerial::printf(const char *format, ...)
+{
+  va_list args;
+
+  va_start(args, format);
+  int length = vprintf(format, args);
+  va_end(args);
+
+  return length < 0 ? 0 : length;
+}
+
+//
+// Preferences (Preferences.h), kept in memory
+//
+bool Preferences::begin(const char *name, bool readOnly)
+{
+  if (m_namespace != NULL || name == NULL || strlen(name) > 15) {
+    return false;
+  }
+  m_namespace = name;
+  m_readOnly = readOnly;
+
+  return true;
+}
+
+void Preferences::end()
+{
+  m_namespace = NULL;
+}
+
+bool Preferences::clear()
+{
+  if (m_namespace == NULL || m_readOnly) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(s_prefsLock);
+  std::string prefix = std::string(m_namespace) + '/';
+  for (std::map<std::string, uint32_t>::iterator it = s_prefs.begin(); it != s_prefs.end(); ) {
+    if (it->first.compare(0, prefix.size(), prefix) == 0) {
+      it = s_prefs.erase(it);
+    }
+    else {
+      ++it;
+    }
+  }
+
+  return true;
+}
+
+bool Preferences::remove(const char *key)
+{
+  if (m_namespace == NULL || m_readOnly) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(s_prefsLock);
+
+  return s_prefs.erase(std::string(m_namespace) + '/' + key) != 0;
+}
+
+bool Preferences::isKey(const char *key)
+{
+  if (m_namespace == NULL) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lock(s_prefsLock);
+
+  return s_prefs.count(std::string(m_namespace) + '/' + key) != 0;
+}
+
+size_t Preferences::put(const char *key, uint32_t value, size_t size)
+{
+  if (m_namespace == NULL || m_readOnly) {
+    return 0;
+  }
+  std::lock_guard<std::mutex> lock(s_prefsLock);
+  s_prefs[std::string(m_namespace) + '/' + key] = value;
+
+  return size;
+}
+
+uint32_t Preferences::get(const char *key, uint32_t defaultValue)
+{
+  if (m_namespace == NULL) {
+    return defaultValue;
+  }
+  std::lock_guard<std::mutex> lock(s_prefsLock);
+  std::map<std::string, uint32_t>::const_iterator it = s_prefs.find(std::string(m_namespace) + '/' + key);
+
+  return it == s_prefs.end() ? defaultValue : it->second;
+}
+
+size_t   Preferences::putUChar(const char *key, uint8_t value)           { return put(key, value, 1); }
+size_t   Preferences::putUShort(const char *key, uint16_t value)         { return put(key, value, 2); }
+size_t   Preferences::putUInt(const char *key, uint32_t value)           { return put(key, value, 4); }
+uint8_t  Preferences::getUChar(const char *key, uint8_t defaultValue)    { return (uint8_t)get(key, defaultValue); }
+uint16_t Preferences::getUShort(const char *key, uint16_t defaultValue)  { return (uint16_t)get(key, defaultValue); }
+uint32_t Preferences::getUInt(const char *key, uint32_t defaultValue)    { return get(key, defaultValue); }
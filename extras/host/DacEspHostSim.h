@@ -0,0 +1,73 @@
+/*
+  DacEspHostSim, host runtime for the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Runtime of the host build of the DacESP32 library (extras/host). Backs
+  the stub headers in extras/host/include: FreeRTOS spinlocks & tasks on
+  POSIX threads, esp_timer, Arduino timing/logging/Serial, Preferences
+  kept in memory and a simulated RTC8M_CLK whose frequency follows
+  RTC_CNTL_CK8M_DFREQ in the emulated register file (src/DacEspHal.cpp).
+  Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef DacEspHostSim_h
+#define DacEspHostSim_h
+
+#include <Arduino.h>
+#include "soc/rtc.h"
+
+//
+// definitions
+//
+#define DAC_HOST_CK8M_DEFAULT      8000000   // simulated RTC8M_CLK at CK8M_DFREQ default (Hz)
+#define DAC_HOST_CK8M_STEP_DEFAULT 20000     // RTC8M_CLK change per CK8M_DFREQ step (Hz)
+#define DAC_HOST_DFREQ_DEFAULT     172       // CK8M_DFREQ set by the ESP-IDF startup code
+
+#ifndef DACESP32_HOST_LOG_LEVEL
+#define DACESP32_HOST_LOG_LEVEL ARDUHAL_LOG_LEVEL_ERROR
+#endif
+
+// DacEspHostSim class, all members are static (host build only)
+class DacEspHostSim
+{
+  public:
+    static void     reset(void);
+    static void     setCk8m(uint32_t frequency, int32_t step = DAC_HOST_CK8M_STEP_DEFAULT);
+    static uint32_t getCk8m(void);
+    static void     setCalFailAfter(int32_t count);
+    static uint32_t getCalCount(void) { return m_calCount; };
+    static void     setLogLevel(int level) { m_logLevel = level; };
+    static int      getLogLevel(void) { return m_logLevel; };
+    static void     clearPreferences(void);
+
+  private:
+    friend uint32_t rtc_clk_cal(rtc_cal_sel_t cal_clk, uint32_t slow_clk_cycles);
+
+    static uint32_t m_ck8m;           // RTC8M_CLK at DAC_HOST_DFREQ_DEFAULT
+    static int32_t  m_ck8mStep;       // change per CK8M_DFREQ step
+    static int32_t  m_calFailAfter;   // rtc_clk_cal() calls left before it fails, -1: never
+    static uint32_t m_calCount;       // rtc_clk_cal() calls since reset()
+    static int      m_logLevel;
+};
+
+#endif
@@ -0,0 +1,548 @@
+/*
+  hostTest, host test of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Unit test of the DacESP32 library on the emulated registers of the host
+  build (extras/host). Checks the register fields written by the DacESP32
+  class, DacEspRegs shadow copies, DacEspTransaction, DacEspIsr,
+  DacEspArbiter, DacEspRamp, DacEspService and the RTC8M_CLK measurement
+  on the simulated clock.
+
+  Build & run on a host (from the repository root):
+    cmake -S extras/host -B build && cmake --build build && ctest --test-dir build
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <atomic>
+#include <pthread.h>
+#include "DacEspHostSim.h"
+#include "DacESP32.h"
+#include "DacEspRegs.h"
+#include "DacEspIsr.h"
+#include "DacEspTransaction.h"
+#include "DacEspArbiter.h"
+#include "DacEspClock.h"
+#include "DacEspDrift.h"
+#include "DacEspFrac.h"
+#include "DacEspRamp.h"
+#include "DacEspService.h"
+#include "DacEspTrace.h"
+#include "DacEspProfile.h"
+
+static uint32_t failures;
+
+#define CHECK(cond)                                                       \
+  do {                                                                    \
+    if (!(cond)) {                                                        \
+      printf("FAIL %s:%d: %s\n", __func__, __LINE__, #cond);              \
+      failures++;                                                         \
+    }                                                                     \
+  } while (0)
+
+#define FIELD(reg, field) ((DacEspHal::read(reg) >> (field##_S)) & (field##_V))
+
+// register writes seen by the write hook
+static uint32_t writesClkConf, writesCtrl1, writesCtrl2, writesPad;
+static uint32_t writeLastCtrl, writeFirstPad, writes;  // write order
+
+static void countWrites(uint32_t addr, uint32_t value, void *arg)
+{
+  writes++;
+  if (addr == RTC_CNTL_CLK_CONF_REG) {
+    writesClkConf++;
+  }
+  else if (addr == SENS_SAR_DAC_CTRL1_REG) {
+    writesCtrl1++;
+    writeLastCtrl = writes;
+  }
+  else if (addr == SENS_SAR_DAC_CTRL2_REG) {
+    writesCtrl2++;
+    writeLastCtrl = writes;
+  }
+  else if (writesPad++ == 0) {
+    writeFirstPad = writes;
+  }
+}
+
+static void resetWrites()
+{
+  writesClkConf = writesCtrl1 = writesCtrl2 = writesPad = 0;
+  writeLastCtrl = writeFirstPad = writes = 0;
+}
+
+//
+// DC output: DAC value & pad enable bits of the channel pad register
+//
+static void testVoltage()
+{
+  DacESP32 dac1(GPIO_NUM_25), dac2(DAC_CHANNEL_2);
+  gpio_num_t pin;
+
+  CHECK(dac1.getChannel() == DAC_CHANNEL_1);
+  CHECK(dac2.getGPIOnum(&pin) == ESP_OK && pin == GPIO_NUM_26);
+  CHECK(FIELD(RTC_IO_PAD_DAC1_REG, RTC_IO_PDAC1_XPD_DAC) == 0);
+
+  CHECK(dac1.outputVoltage((uint8_t)100) == ESP_OK);
+  CHECK(FIELD(RTC_IO_PAD_DAC1_REG, RTC_IO_PDAC1_DAC) == 100);
+  CHECK(FIELD(RTC_IO_PAD_DAC1_REG, RTC_IO_PDAC1_XPD_DAC) == 1);
+  CHECK(FIELD(RTC_IO_PAD_DAC1_REG, RTC_IO_PDAC1_MUX_SEL) == 1);
+  CHECK(FIELD(RTC_IO_PAD_DAC2_REG, RTC_IO_PDAC2_XPD_DAC) == 0);
+
+  float voltage = dac2.getConfig().channelVoltageMax / 2;
+  CHECK(dac2.outputVoltage(voltage) == ESP_OK);
+  CHECK(FIELD(RTC_IO_PAD_DAC2_REG, RTC_IO_PDAC2_DAC) == 127);
+  CHECK(FIELD(RTC_IO_PAD_DAC2_REG, RTC_IO_PDAC2_XPD_DAC) == 1);
+  CHECK(dac2.outputVoltage(-1.0f) == ESP_OK);
+  CHECK(FIELD(RTC_IO_PAD_DAC2_REG, RTC_IO_PDAC2_DAC) == 0);
+
+  CHECK(dac1.disable() == ESP_OK);
+  CHECK(FIELD(RTC_IO_PAD_DAC1_REG, RTC_IO_PDAC1_XPD_DAC) == 0);
+  CHECK(FIELD(RTC_IO_PAD_DAC2_REG, RTC_IO_PDAC2_XPD_DAC) == 1);
+
+  // shadow copies: the same value again gets skipped
+  dac_regs_stats_t stats;
+  CHECK(dac2.outputVoltage((uint8_t)127) == ESP_OK);
+  DacEspRegs::resetStats();
+  uint32_t writes = DacEspHal::getWriteCount();
+  CHECK(dac2.outputVoltage((uint8_t)127) == ESP_OK);
+  DacEspRegs::getStats(&stats);
+  CHECK(DacEspHal::getWriteCount() == writes);
+  CHECK(stats.skipped > 0 && stats.issued == 0);
+}
+
+//
+// CW generator: solver result, channel fields & the frequency reported
+//
+static void testCw()
+{
+  DacESP32 dac1(DAC_CHANNEL_1), dac2(DAC_CHANNEL_2);
+  dac_cw_setting_t setting;
+
+  CHECK(DacESP32::solveCwFrequency(1000, &setting) == ESP_OK);
+  CHECK(dac1.outputCW(1000) == ESP_OK);
+  CHECK(FIELD(SENS_SAR_DAC_CTRL1_REG, SENS_SW_TONE_EN) == 1);
+  CHECK(FIELD(SENS_SAR_DAC_CTRL1_REG, SENS_SW_FSTEP) == setting.frequencyStep);
+  CHECK(FIELD(RTC_CNTL_CLK_CONF_REG, RTC_CNTL_CK8M_DIV_SEL) == setting.clk8mDiv);
+  CHECK(FIELD(RTC_CNTL_CLK_CONF_REG, RTC_CNTL_CK8M_DFREQ) == DAC_HOST_DFREQ_DEFAULT);
+  CHECK(FIELD(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_CW_EN1) == 1);
+  CHECK(FIELD(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_CW_EN2) == 0);
+  CHECK(FIELD(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_INV1) == DAC_CW_PHASE_0);
+  CHECK(FIELD(RTC_IO_PAD_DAC1_REG, RTC_IO_PDAC1_XPD_DAC) == 1);
+  CHECK(abs((int32_t)dac1.getCwFrequencyActual() - 1000) < 20);
+
+  CHECK(dac2.outputCW(1000, DAC_CW_SCALE_4, DAC_CW_PHASE_180, -5) == ESP_OK);
+  CHECK(FIELD(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_CW_EN2) == 1);
+  CHECK(FIELD(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_SCALE2) == DAC_CW_SCALE_4);
+  CHECK(FIELD(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_INV2) == DAC_CW_PHASE_180);
+  CHECK(FIELD(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_DC2) == (uint8_t)-5);
+  CHECK(FIELD(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_SCALE1) == DAC_CW_SCALE_1);
+
+  dac_state_t state;
+  DacESP32::getState(&state);
+  CHECK(state.toneEnabled && state.frequencyStep == setting.frequencyStep);
+  CHECK(state.channel[0].cwEnabled && state.channel[1].cwEnabled);
+  CHECK(state.channel[1].offset == -5 && state.channel[1].scale == DAC_CW_SCALE_4);
+  CHECK(state.frequency == dac1.getCwFrequencyActual());
+
+  // DC output releases the channel from the CW generator
+  CHECK(dac1.outputVoltage((uint8_t)10) == ESP_OK);
+  CHECK(FIELD(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_CW_EN1) == 0);
+  CHECK(FIELD(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_CW_EN2) == 1);
+}
+
+//
+// Transaction: all changes of a commit written with one write per register
+//
+static void testTransaction()
+{
+  DacESP32 dac1(DAC_CHANNEL_1), dac2(DAC_CHANNEL_2);
+  DacEspTransaction tx;
+  dac_cw_setting_t setting;
+
+  CHECK(dac1.outputCW(1000) == ESP_OK);
+  CHECK(dac2.outputCW(2000, DAC_CW_SCALE_2) == ESP_OK);
+  CHECK(DacESP32::solveCwFrequency(3000, &setting) == ESP_OK);
+
+  DacEspHal::setWriteHook(countWrites);
+  resetWrites();
+  tx.begin();
+  CHECK(tx.setCwFrequency(3000) == ESP_OK);
+  CHECK(tx.setCwScale(dac1, DAC_CW_SCALE_8) == ESP_OK);
+  CHECK(tx.setCwOffset(dac2, 7) == ESP_OK);
+  CHECK(tx.setCwPhase(dac2, DAC_CW_PHASE_180) == ESP_OK);
+  CHECK(tx.cwDeselect(dac1) == ESP_OK);
+  CHECK(tx.commit() == ESP_OK);
+  DacEspHal::setWriteHook(NULL);
+
+  CHECK(writesCtrl1 <= 1 && writesCtrl2 == 1 && writesClkConf <= 1);
+  CHECK(FIELD(SENS_SAR_DAC_CTRL1_REG, SENS_SW_FSTEP) == setting.frequencyStep);
+  CHECK(FIELD(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_CW_EN1) == 0);
+  CHECK(FIELD(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_SCALE1) == DAC_CW_SCALE_8);
+  CHECK(FIELD(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_DC2) == 7);
+  CHECK(FIELD(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_INV2) == DAC_CW_PHASE_180);
+  CHECK(dac1.getCwScale() == DAC_CW_SCALE_8 && dac2.getCwOffset() == 7 && dac2.getCwPhase() == DAC_CW_PHASE_180);
+
+  // output of a channel switched to the CW generator powered up last
+  CHECK(dac1.disable() == ESP_OK);
+  DacEspHal::setWriteHook(countWrites);
+  resetWrites();
+  CHECK(tx.cwSelect(dac1) == ESP_OK);
+  CHECK(tx.commit() == ESP_OK);
+  DacEspHal::setWriteHook(NULL);
+  CHECK(writesPad == 1 && writeFirstPad > writeLastCtrl);
+  CHECK(FIELD(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_CW_EN1) == 1);
+  CHECK(FIELD(RTC_IO_PAD_DAC1_REG, RTC_IO_PDAC1_XPD_DAC) == 1);
+
+  // frequency solved with the configuration of the object given
+  DacEspConfig config = dac2.getConfig();
+  config.cwHighAccuracy = !config.cwHighAccuracy;
+  config.fstepMax = 512;
+  CHECK(dac2.setConfig(config) == ESP_OK);
+  DacEspHostSim::setLogLevel(ARDUHAL_LOG_LEVEL_NONE);
+  CHECK(tx.setCwFrequency(50000) != ESP_OK);
+  DacEspHostSim::setLogLevel(DACESP32_HOST_LOG_LEVEL);
+  CHECK(tx.setCwFrequency(dac2, 50000) == ESP_OK);
+  CHECK(tx.commit() == ESP_OK);
+  uint32_t fstep = FIELD(SENS_SAR_DAC_CTRL1_REG, SENS_SW_FSTEP);
+  uint32_t div = FIELD(RTC_CNTL_CLK_CONF_REG, RTC_CNTL_CK8M_DIV_SEL);
+  CHECK(fstep > 256 && fstep <= 512);
+  CHECK(dac2.setCwFrequency(50000) == ESP_OK);
+  CHECK(FIELD(SENS_SAR_DAC_CTRL1_REG, SENS_SW_FSTEP) == fstep);
+  CHECK(FIELD(RTC_CNTL_CLK_CONF_REG, RTC_CNTL_CK8M_DIV_SEL) == div);
+}
+
+//
+// ISR-safe functions: argument checks & register fields
+//
+static void testIsr()
+{
+  DacESP32 dac1(DAC_CHANNEL_1), dac2(DAC_CHANNEL_2);
+  dac_cw_setting_t setting;
+
+  CHECK(DacEspIsr::outputVoltage(DAC_CHANNEL_2, 200) == ESP_OK);
+  CHECK(FIELD(RTC_IO_PAD_DAC2_REG, RTC_IO_PDAC2_DAC) == 200);
+  CHECK(DacEspIsr::outputVoltage(DAC_CHANNEL_MAX, 200) == ESP_ERR_INVALID_ARG);
+  CHECK(DacEspIsr::setCwScale(DAC_CHANNEL_1, (dac_cw_scale_t)4) == ESP_ERR_INVALID_ARG);
+
+  CHECK(DacESP32::solveCwFrequency(5000, &setting) == ESP_OK);
+  CHECK(DacEspIsr::setCwFrequency(setting) == ESP_OK);
+  CHECK(DacEspIsr::setCwOffset(DAC_CHANNEL_1, -20) == ESP_OK);
+  CHECK(DacEspIsr::cwEnable(DAC_CHANNEL_1) == ESP_OK);
+  CHECK(FIELD(SENS_SAR_DAC_CTRL1_REG, SENS_SW_FSTEP) == setting.frequencyStep);
+  CHECK(FIELD(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_DC1) == (uint8_t)-20);
+  CHECK(FIELD(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_CW_EN1) == 1);
+  CHECK(DacEspIsr::cwDisable(DAC_CHANNEL_1) == ESP_OK);
+  CHECK(FIELD(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_CW_EN1) == 0);
+}
+
+//
+// Arbiter: the CW solver only uses CK8M_DIV_SEL values allowed
+//
+static void testArbiter()
+{
+  DacESP32 dac1(DAC_CHANNEL_1);
+  int id;
+
+  CHECK(DacEspArbiter::addConstraint("hostTest", DAC_ARB_DIV_ONLY(2), &id) == ESP_OK);
+  CHECK(DacEspArbiter::getAllowed() == DAC_ARB_DIV_ONLY(2));
+  CHECK(dac1.outputCW(700) == ESP_OK);
+  CHECK(FIELD(RTC_CNTL_CLK_CONF_REG, RTC_CNTL_CK8M_DIV_SEL) == 2);
+  CHECK(DacEspArbiter::getDivider() == 2);
+  CHECK(DacEspArbiter::removeConstraint(id) == ESP_OK);
+  CHECK(DacEspArbiter::getAllowed() == DAC_ARB_DIV_ANY);
+}
+
+//
+// RTC8M_CLK measurement on the simulated clock
+//
+static void testClock()
+{
+  DacEspHostSim::setCk8m(8300000);
+  uint32_t ck8m = DacEspClock::measureCk8m();
+  CHECK(ck8m > 8299000 && ck8m < 8301000);
+  // RTC8M_D256_CLK is off after reset() & must be switched off again
+  CHECK(!rtc_clk_8md256_enabled() && rtc_clk_8m_enabled());
+
+  DacEspHostSim::setCalFailAfter(0);
+  DacEspHostSim::setLogLevel(ARDUHAL_LOG_LEVEL_NONE);
+  CHECK(DacEspClock::measureCk8m() == 0);
+  DacEspHostSim::setLogLevel(DACESP32_HOST_LOG_LEVEL);
+
+  // RTC8M_CLK = 8.3MHz + (CK8M_DFREQ - 172) * 20kHz: 157 gives 8.0MHz
+  DacEspConfig config = DacESP32::getGlobalConfig();
+  dac_trim_result_t trim;
+  DacEspHostSim::setCalFailAfter(-1);
+  CHECK(DacEspClock::autoTrim(8000000, &trim) == ESP_OK);
+  CHECK(trim.dfreq == 157 && trim.frequency > 7999000 && trim.frequency < 8001000 && trim.measurements <= 10);
+  CHECK(FIELD(RTC_CNTL_CLK_CONF_REG, RTC_CNTL_CK8M_DFREQ) == 157);
+  CHECK(DacESP32::getGlobalConfig().ck8mDfreq == 157);
+
+  // failing measurement: original CK8M_DFREQ restored
+  DacEspHostSim::setCalFailAfter(3);
+  DacEspHostSim::setLogLevel(ARDUHAL_LOG_LEVEL_NONE);
+  CHECK(DacEspClock::autoTrim(8300000, &trim) == ESP_FAIL);
+  DacEspHostSim::setLogLevel(DACESP32_HOST_LOG_LEVEL);
+  CHECK(FIELD(RTC_CNTL_CLK_CONF_REG, RTC_CNTL_CK8M_DFREQ) == 157);
+  CHECK(DacESP32::getGlobalConfig().ck8mDfreq == 157);
+  CHECK(DacESP32::setGlobalConfig(config) == ESP_OK);
+}
+
+//
+// Drift compensation: settings solved & applied with the estimated clock,
+// ck8mSolved moves only with the setting applied, nothing done while
+// DacEspFrac owns the frequency registers
+//
+static float s_temperature;
+
+static float temperature(void *arg)
+{
+  return s_temperature;
+}
+
+static void testDrift()
+{
+  DacESP32 dac1(DAC_CHANNEL_1);
+  DacEspConfig config = DacESP32::getGlobalConfig();
+  dac_drift_config_t cfg = DAC_DRIFT_CONFIG_DEFAULT();
+  dac_drift_stats_t stats;
+
+  // RTC8M_CLK from the temperature: 1000ppm/°C around 25°C, the task runs once
+  cfg.periodMs = 1000000;
+  cfg.temperature = temperature;
+  cfg.tempCoeffPpm = 1000;
+  s_temperature = 25;
+  CHECK(DacEspDrift::begin(cfg) == ESP_OK);
+  CHECK(DacEspDrift::end() == ESP_OK);
+
+  CHECK(dac1.outputCW(1000) == ESP_OK);
+  uint32_t fstep = FIELD(SENS_SAR_DAC_CTRL1_REG, SENS_SW_FSTEP);
+  s_temperature = 75;
+  CHECK(DacEspDrift::check() == ESP_OK);
+  DacEspDrift::getStats(&stats);
+  CHECK(stats.resolves == 1 && stats.applied == 1 && stats.ck8mSolved == stats.ck8m);
+  CHECK(stats.ck8m > 8390000 && stats.ck8m < 8410000);
+  CHECK(FIELD(SENS_SAR_DAC_CTRL1_REG, SENS_SW_FSTEP) != fstep && abs(stats.errorHz) < 20);
+
+  // fractional mode running: no measurement, no register change
+  CHECK(DacEspFrac::start(1000500) == ESP_OK);
+  s_temperature = 25;
+  CHECK(DacEspDrift::check() == ESP_ERR_INVALID_STATE);
+  DacEspDrift::getStats(&stats);
+  CHECK(stats.checks == 1 && stats.resolves == 1);
+  CHECK(DacEspFrac::stop() == ESP_OK);
+
+  // new setting not better by hysteresisHz: solved again, not applied
+  cfg.hysteresisHz = 1000000;
+  s_temperature = 25;
+  CHECK(DacEspDrift::begin(cfg) == ESP_OK);
+  CHECK(DacEspDrift::end() == ESP_OK);
+  CHECK(dac1.outputCW(1000) == ESP_OK);
+  fstep = FIELD(SENS_SAR_DAC_CTRL1_REG, SENS_SW_FSTEP);
+  DacEspDrift::getStats(&stats);
+  uint32_t ck8mSolved = stats.ck8mSolved;
+  s_temperature = 75;
+  CHECK(DacEspDrift::check() == ESP_OK);
+  CHECK(DacEspDrift::check() == ESP_OK);
+  DacEspDrift::getStats(&stats);
+  CHECK(stats.resolves == 2 && stats.applied == 0 && stats.ck8mSolved == ck8mSolved);
+  CHECK(FIELD(SENS_SAR_DAC_CTRL1_REG, SENS_SW_FSTEP) == fstep);
+
+  CHECK(DacESP32::setGlobalConfig(config) == ESP_OK);
+}
+
+//
+// Ramp: runs in the background (esp_timer) & ends at the target value,
+// stop() returns only after a tick writing the DAC value has finished
+//
+static std::atomic<bool> s_rampStopped(false);
+
+static void *rampStopThread(void *arg)
+{
+  static_cast<DacEspRamp *>(arg)->stop();
+  s_rampStopped = true;
+  return NULL;
+}
+
+static void testRamp()
+{
+  DacESP32 dac1(DAC_CHANNEL_1);
+  DacEspRamp ramp(dac1);
+  pthread_t thread;
+
+  CHECK(dac1.outputCW(1000) == ESP_OK);
+  CHECK(ramp.rampTo(200, 20) == ESP_OK);
+  for (int i = 0; i < 500 && ramp.isBusy(); i++) {
+    delay(1);
+  }
+  CHECK(!ramp.isBusy() && ramp.getValue() == 200);
+  CHECK(FIELD(RTC_IO_PAD_DAC1_REG, RTC_IO_PDAC1_DAC) == 200);
+  CHECK(FIELD(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_CW_EN1) == 0);
+
+  // holding the register lock keeps the next tick between computing & writing its value
+  s_rampStopped = false;
+  CHECK(ramp.rampTo(0, 20) == ESP_OK);
+  DAC_ENTER_CRITICAL();
+  delay(5);
+  CHECK(pthread_create(&thread, NULL, rampStopThread, &ramp) == 0);
+  delay(5);
+  bool stoppedEarly = s_rampStopped;
+  DAC_EXIT_CRITICAL();
+  pthread_join(thread, NULL);
+  CHECK(!stoppedEarly && ramp.getState() == DAC_RAMP_IDLE);
+  CHECK(FIELD(RTC_IO_PAD_DAC1_REG, RTC_IO_PDAC1_DAC) == ramp.getValue());
+  CHECK(dac1.outputVoltage((uint8_t)7) == ESP_OK);
+  delay(5);
+  CHECK(FIELD(RTC_IO_PAD_DAC1_REG, RTC_IO_PDAC1_DAC) == 7);
+}
+
+//
+// Service: commands of a channel execute in the order posted, coalescing
+// never moves a setting in front of a later command
+//
+static void testService()
+{
+  DacESP32 dac1(DAC_CHANNEL_1), dac2(DAC_CHANNEL_2);
+  dac_cw_setting_t setting;
+
+  CHECK(DacEspService::begin() == ESP_OK);
+  for (int i = 0; i < 3; i++) {
+    CHECK(DacEspService::outputVoltage(dac1, 10) == ESP_OK);
+    CHECK(DacEspService::outputCW(dac1, 1000) == ESP_OK);
+    CHECK(DacEspService::outputVoltage(dac1, 20) == ESP_OK);
+    CHECK(DacEspService::setCwFrequency(dac2, 2000) == ESP_OK);
+    CHECK(DacEspService::outputCW(dac2, 1000) == ESP_OK);
+    CHECK(DacEspService::setCwFrequency(dac2, 3000) == ESP_OK);
+  }
+  CHECK(DacEspService::end() == ESP_OK);
+
+  CHECK(FIELD(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_CW_EN1) == 0);
+  CHECK(FIELD(RTC_IO_PAD_DAC1_REG, RTC_IO_PDAC1_DAC) == 20);
+  CHECK(FIELD(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_CW_EN2) == 1);
+  CHECK(DacESP32::solveCwFrequency(3000, &setting) == ESP_OK);
+  CHECK(FIELD(SENS_SAR_DAC_CTRL1_REG, SENS_SW_FSTEP) == setting.frequencyStep);
+}
+
+#ifdef DACESP32_PROFILING_ENABLED
+//
+// Profiling: a call is accounted to the method called only, not to the
+// public methods it uses internally
+//
+static uint32_t calls(dac_trace_api_t api)
+{
+  dac_profile_stats_t stats;
+
+  return DacEspProfile::getStats(api, &stats) ? stats.count : 0xFFFFFFFF;
+}
+
+static void testProfile()
+{
+  DacESP32 dac1(DAC_CHANNEL_1);
+  dac_state_t state;
+
+  DacEspProfile::reset();
+  CHECK(dac1.outputVoltage(1.0f) == ESP_OK);
+  CHECK(calls(DAC_API_OUTPUT_VOLTAGE_FLOAT) == 1 && calls(DAC_API_OUTPUT_VOLTAGE) == 0);
+  CHECK(dac1.outputCW(1000, DAC_CW_SCALE_2) == ESP_OK);
+  CHECK(calls(DAC_API_OUTPUT_CW) == 1 && calls(DAC_API_SET_CW_FREQUENCY) == 0 && calls(DAC_API_SET_CW_SCALE) == 0 &&
+        calls(DAC_API_SET_CW_PHASE) == 0 && calls(DAC_API_SET_CW_OFFSET) == 0);
+  CHECK(dac1.setPin(GPIO_NUM_26) == ESP_OK);
+  CHECK(calls(DAC_API_SET_PIN) == 1 && calls(DAC_API_SET_CHANNEL) == 0);
+  CHECK(DacEspFrac::start(1000500) == ESP_OK && DacEspFrac::start(1000500) == ESP_OK);
+  CHECK(DacEspFrac::stop() == ESP_OK);
+  CHECK(calls(DAC_API_FRAC_START) == 2 && calls(DAC_API_FRAC_STOP) == 1);
+  dac1.getCwFrequencyActual();
+  DacESP32::getState(&state);
+  CHECK(calls(DAC_API_GET_CW_FREQUENCY_ACTUAL) == 1 && calls(DAC_API_GET_STATE) == 1);
+}
+#endif
+
+#ifdef DACESP32_TRACE_ENABLED
+//
+// Trace: register writes are tagged with the method called
+//
+static uint8_t  s_dump[sizeof(dac_trace_header_t) + DAC_TRACE_LEN * sizeof(dac_trace_entry_t)];
+static size_t   s_dumpSize;
+
+static void traceOut(const void *data, size_t size, void *arg)
+{
+  if (s_dumpSize + size <= sizeof(s_dump)) {
+    memcpy(s_dump + s_dumpSize, data, size);
+  }
+  s_dumpSize += size;
+}
+
+// bit per dac_trace_api_t seen in the trace
+static uint64_t tracedApis()
+{
+  uint64_t apis = 0;
+
+  s_dumpSize = 0;
+  DacEspTrace::dump(traceOut);
+  const dac_trace_header_t *header = (const dac_trace_header_t *)s_dump;
+  const dac_trace_entry_t *entry = (const dac_trace_entry_t *)(s_dump + sizeof(dac_trace_header_t));
+  for (uint32_t i = 0; i < header->count; i++) {
+    apis |= 1ULL << entry[i].api;
+  }
+  DacEspTrace::reset();
+  return apis;
+}
+
+static void testTrace()
+{
+  DacESP32 dac1(DAC_CHANNEL_1);
+  dac_cw_setting_t setting;
+
+  DacEspTrace::reset();
+  CHECK(dac1.outputVoltage(1.0f) == ESP_OK);
+  CHECK(tracedApis() == 1ULL << DAC_API_OUTPUT_VOLTAGE_FLOAT);
+  CHECK(dac1.outputCW(1000, DAC_CW_SCALE_2, DAC_CW_PHASE_180, 3) == ESP_OK);
+  CHECK(tracedApis() == 1ULL << DAC_API_OUTPUT_CW);
+  CHECK(DacESP32::solveCwFrequency(2000, &setting) == ESP_OK);
+  CHECK(DacEspIsr::setCwFrequency(setting) == ESP_OK && DacEspIsr::setCwScale(DAC_CHANNEL_1, DAC_CW_SCALE_1) == ESP_OK);
+  CHECK(tracedApis() == (1ULL << DAC_API_ISR_SET_CW_FREQUENCY | 1ULL << DAC_API_ISR_SET_CW_SCALE));
+}
+#endif
+
+int main()
+{
+  void (*tests[])(void) = { testVoltage, testCw, testTransaction, testIsr, testArbiter, testClock, testDrift,
+                            testRamp, testService,
+#ifdef DACESP32_PROFILING_ENABLED
+                            testProfile,
+#endif
+#ifdef DACESP32_TRACE_ENABLED
+                            testTrace,
+#endif
+                          };
+
+  for (size_t i = 0; i < sizeof(tests) / sizeof(tests[0]); i++) {
+    DacEspHostSim::reset();
+    tests[i]();
+  }
+
+  printf("%s: %u failures\n", failures ? "FAILED" : "PASSED", failures);
+  return failures ? 1 : 0;
+}
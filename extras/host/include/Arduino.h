@@ -0,0 +1,79 @@
+// Host stub of the Arduino-ESP32 core for the DacESP32 host build (extras/host).
+// Provides the small subset of the core (logging, timing, Serial) the library
+// uses. The runtime behind it is extras/host/DacEspHostSim.cpp.
+#ifndef DACESP32_HOST_ARDUINO_H
+#define DACESP32_HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "esp_err.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "soc/soc.h"
+
+typedef enum {
+  GPIO_NUM_NC = -1,
+  GPIO_NUM_0 = 0, GPIO_NUM_1, GPIO_NUM_2, GPIO_NUM_3, GPIO_NUM_4, GPIO_NUM_5, GPIO_NUM_6, GPIO_NUM_7,
+  GPIO_NUM_8, GPIO_NUM_9, GPIO_NUM_10, GPIO_NUM_11, GPIO_NUM_12, GPIO_NUM_13, GPIO_NUM_14, GPIO_NUM_15,
+  GPIO_NUM_16, GPIO_NUM_17, GPIO_NUM_18, GPIO_NUM_19, GPIO_NUM_20, GPIO_NUM_21, GPIO_NUM_22, GPIO_NUM_23,
+  GPIO_NUM_24, GPIO_NUM_25, GPIO_NUM_26, GPIO_NUM_27, GPIO_NUM_28, GPIO_NUM_29, GPIO_NUM_30, GPIO_NUM_31,
+  GPIO_NUM_32, GPIO_NUM_33, GPIO_NUM_34, GPIO_NUM_35, GPIO_NUM_36, GPIO_NUM_37, GPIO_NUM_38, GPIO_NUM_39,
+  GPIO_NUM_MAX
+} gpio_num_t;
+
+// log levels as in esp32-hal-log.h
+#define ARDUHAL_LOG_LEVEL_NONE    0
+#define ARDUHAL_LOG_LEVEL_ERROR   1
+#define ARDUHAL_LOG_LEVEL_WARN    2
+#define ARDUHAL_LOG_LEVEL_INFO    3
+#define ARDUHAL_LOG_LEVEL_DEBUG   4
+#define ARDUHAL_LOG_LEVEL_VERBOSE 5
+
+// prints to stderr if level <= current level (see DacEspHostSim::setLogLevel)
+void dac_host_log(int level, const char *func, const char *format, ...) __attribute__((format(printf, 3, 4)));
+
+#define log_e(format, ...) dac_host_log(ARDUHAL_LOG_LEVEL_ERROR, __func__, format, ##__VA_ARGS__)
+#define log_w(format, ...) dac_host_log(ARDUHAL_LOG_LEVEL_WARN, __func__, format, ##__VA_ARGS__)
+#define log_i(format, ...) dac_host_log(ARDUHAL_LOG_LEVEL_INFO, __func__, format, ##__VA_ARGS__)
+#define log_d(format, ...) dac_host_log(ARDUHAL_LOG_LEVEL_DEBUG, __func__, format, ##__VA_ARGS__)
+#define log_v(format, ...) dac_host_log(ARDUHAL_LOG_LEVEL_VERBOSE, __func__, format, ##__VA_ARGS__)
+
+// Serial, writes to stdout
+class HardwareSerial
+{
+  public:
+    void   begin(unsigned long baud) { (void)baud; };
+    size_t print(const char *text);
+    size_t print(int value);
+    size_t print(unsigned int value);
+    size_t print(long value);
+    size_t print(unsigned long value);
+    size_t print(double value, int digits = 2);
+    size_t println(void);
+    size_t println(const char *text);
+    size_t println(int value);
+    size_t println(unsigned int value);
+    size_t println(long value);
+    size_t println(unsigned long value);
+    size_t println(double value, int digits = 2);
+    size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+    size_t write(const uint8_t *buffer, size_t size);
+    void   flush(void);
+    operator bool() const { return true; };
+};
+
+extern HardwareSerial Serial;
+
+unsigned long millis(void);
+unsigned long micros(void);
+void          delay(uint32_t ms);
+void          delayMicroseconds(uint32_t us);
+uint32_t      getCpuFrequencyMhz(void);
+
+#endif
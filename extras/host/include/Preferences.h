@@ -0,0 +1,37 @@
+// Host stub of the Arduino-ESP32 Preferences (NVS) class (extras/host,
+// DacESP32 host build). Values are kept in memory for the process lifetime,
+// DacEspHostSim::clearPreferences() erases them.
+#ifndef DACESP32_HOST_PREFERENCES_H
+#define DACESP32_HOST_PREFERENCES_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+class Preferences
+{
+  public:
+    Preferences() : m_namespace(NULL), m_readOnly(true) {};
+    ~Preferences() { end(); };
+
+    bool     begin(const char *name, bool readOnly = false);
+    void     end(void);
+    bool     clear(void);
+    bool     remove(const char *key);
+    bool     isKey(const char *key);
+
+    size_t   putUChar(const char *key, uint8_t value);
+    size_t   putUShort(const char *key, uint16_t value);
+    size_t   putUInt(const char *key, uint32_t value);
+    uint8_t  getUChar(const char *key, uint8_t defaultValue = 0);
+    uint16_t getUShort(const char *key, uint16_t defaultValue = 0);
+    uint32_t getUInt(const char *key, uint32_t defaultValue = 0);
+
+  private:
+    size_t   put(const char *key, uint32_t value, size_t size);
+    uint32_t get(const char *key, uint32_t defaultValue);
+
+    const char *m_namespace;
+    bool        m_readOnly;
+};
+
+#endif
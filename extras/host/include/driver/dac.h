@@ -0,0 +1,19 @@
+// Host stub of the ESP-IDF DAC driver (extras/host, DacESP32 host build).
+// The functions are emulated on the register file by src/DacEspHal.cpp.
+#ifndef DACESP32_HOST_DAC_H
+#define DACESP32_HOST_DAC_H
+
+#include "esp_err.h"
+#include "soc/dac_channel.h"
+
+typedef enum {
+  DAC_CHANNEL_1 = 0,
+  DAC_CHANNEL_2 = 1,
+  DAC_CHANNEL_MAX
+} dac_channel_t;
+
+esp_err_t dac_output_enable(dac_channel_t channel);
+esp_err_t dac_output_disable(dac_channel_t channel);
+esp_err_t dac_pad_get_io_num(dac_channel_t channel, gpio_num_t *gpio_num);
+
+#endif
@@ -0,0 +1,10 @@
+// Host stub of the ESP-IDF memory placement attributes (extras/host, DacESP32 host build)
+#ifndef DACESP32_HOST_ESP_ATTR_H
+#define DACESP32_HOST_ESP_ATTR_H
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+#define RTC_DATA_ATTR
+#define RTC_NOINIT_ATTR
+
+#endif
@@ -0,0 +1,48 @@
+// Host stub of FreeRTOS (ESP32 port) for the DacESP32 host build (extras/host).
+// portMUX_TYPE is a real recursive spinlock, tasks are POSIX threads.
+#ifndef DACESP32_HOST_FREERTOS_H
+#define DACESP32_HOST_FREERTOS_H
+
+#include <stdint.h>
+#include "esp_attr.h"
+
+typedef int      BaseType_t;
+typedef unsigned UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE  1
+#define pdFAIL  0
+#define pdPASS  1
+
+#define configTICK_RATE_HZ 1000
+#define portTICK_PERIOD_MS (1000 / configTICK_RATE_HZ)
+#define pdMS_TO_TICKS(ms)  ((TickType_t)(((uint64_t)(ms) * configTICK_RATE_HZ) / 1000))
+#define portMAX_DELAY      (TickType_t)0xffffffffUL
+#define portNUM_PROCESSORS 2
+#define tskNO_AFFINITY     0x7FFFFFFF
+
+// spinlock, recursive for the owning thread (like on the ESP32)
+typedef struct {
+  volatile uint32_t owner;  // owning thread, portMUX_FREE_VAL if free
+  volatile uint32_t count;  // recursion depth
+} portMUX_TYPE;
+
+#define portMUX_FREE_VAL            0xB33FFFFFUL
+#define portMUX_INITIALIZER_UNLOCKED { portMUX_FREE_VAL, 0 }
+
+void vPortEnterCritical(portMUX_TYPE *mux);
+void vPortExitCritical(portMUX_TYPE *mux);
+
+#define portENTER_CRITICAL(mux)      vPortEnterCritical(mux)
+#define portEXIT_CRITICAL(mux)       vPortExitCritical(mux)
+#define portENTER_CRITICAL_ISR(mux)  vPortEnterCritical(mux)
+#define portEXIT_CRITICAL_ISR(mux)   vPortExitCritical(mux)
+#define portENTER_CRITICAL_SAFE(mux) vPortEnterCritical(mux)
+#define portEXIT_CRITICAL_SAFE(mux)  vPortExitCritical(mux)
+#define portYIELD_FROM_ISR(...)
+
+BaseType_t xPortGetCoreID(void);
+BaseType_t xPortInIsrContext(void);
+
+#endif
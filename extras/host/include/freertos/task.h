@@ -0,0 +1,23 @@
+// Host stub of the FreeRTOS task API (extras/host, DacESP32 host build)
+#ifndef DACESP32_HOST_TASK_H
+#define DACESP32_HOST_TASK_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct dac_host_task *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *arg);
+
+BaseType_t   xTaskCreatePinnedToCore(TaskFunction_t code, const char *name, uint32_t stackDepth, void *arg,
+                                     UBaseType_t priority, TaskHandle_t *handle, BaseType_t core);
+BaseType_t   xTaskCreate(TaskFunction_t code, const char *name, uint32_t stackDepth, void *arg,
+                         UBaseType_t priority, TaskHandle_t *handle);
+void         vTaskDelete(TaskHandle_t task);
+void         vTaskDelay(TickType_t ticks);
+void         vTaskDelayUntil(TickType_t *previousWakeTime, TickType_t increment);
+TickType_t   xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+uint32_t     ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait);
+BaseType_t   xTaskNotifyGive(TaskHandle_t task);
+void         vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higherPriorityTaskWoken);
+
+#endif
@@ -0,0 +1,11 @@
+// Host stub of the ESP32 DAC channel pin definitions (extras/host, DacESP32 host build)
+#ifndef DACESP32_HOST_DAC_CHANNEL_H
+#define DACESP32_HOST_DAC_CHANNEL_H
+
+#define DAC_GPIO25_CHANNEL     DAC_CHANNEL_1
+#define DAC_CHANNEL_1_GPIO_NUM 25
+
+#define DAC_GPIO26_CHANNEL     DAC_CHANNEL_2
+#define DAC_CHANNEL_2_GPIO_NUM 26
+
+#endif
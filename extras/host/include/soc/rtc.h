@@ -0,0 +1,22 @@
+// Host stub of the ESP32 RTC clock functions (extras/host, DacESP32 host build).
+// RTC8M_CLK is simulated, see DacEspHostSim.
+#ifndef DACESP32_HOST_RTC_H
+#define DACESP32_HOST_RTC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define RTC_CLK_CAL_FRACT 19
+
+typedef enum {
+  RTC_CAL_RTC_MUX = 0,
+  RTC_CAL_8MD256 = 1,
+  RTC_CAL_32K_XTAL = 2
+} rtc_cal_sel_t;
+
+uint32_t rtc_clk_cal(rtc_cal_sel_t cal_clk, uint32_t slow_clk_cycles);
+void     rtc_clk_8m_enable(bool clk_8m_en, bool d256_en);
+bool     rtc_clk_8m_enabled(void);
+bool     rtc_clk_8md256_enabled(void);
+
+#endif
@@ -0,0 +1,70 @@
+// Host stub of the ESP32 RTC_CNTL register definitions, RTC_CNTL_CLK_CONF_REG
+// only (extras/host, DacESP32 host build)
+#ifndef DACESP32_HOST_RTC_CNTL_REG_H
+#define DACESP32_HOST_RTC_CNTL_REG_H
+
+#include "soc/soc.h"
+
+#define RTC_CNTL_CLK_CONF_REG (DR_REG_RTCCNTL_BASE + 0x70)
+#define RTC_CNTL_ANA_CLK_RTC_SEL 0x00000003
+#define RTC_CNTL_ANA_CLK_RTC_SEL_M ((RTC_CNTL_ANA_CLK_RTC_SEL_V)<<(RTC_CNTL_ANA_CLK_RTC_SEL_S))
+#define RTC_CNTL_ANA_CLK_RTC_SEL_V 0x3
+#define RTC_CNTL_ANA_CLK_RTC_SEL_S 30
+#define RTC_CNTL_FAST_CLK_RTC_SEL (BIT(29))
+#define RTC_CNTL_FAST_CLK_RTC_SEL_M (BIT(29))
+#define RTC_CNTL_FAST_CLK_RTC_SEL_V 0x1
+#define RTC_CNTL_FAST_CLK_RTC_SEL_S 29
+#define RTC_CNTL_SOC_CLK_SEL 0x00000003
+#define RTC_CNTL_SOC_CLK_SEL_M ((RTC_CNTL_SOC_CLK_SEL_V)<<(RTC_CNTL_SOC_CLK_SEL_S))
+#define RTC_CNTL_SOC_CLK_SEL_V 0x3
+#define RTC_CNTL_SOC_CLK_SEL_S 27
+#define RTC_CNTL_CK8M_FORCE_PU (BIT(26))
+#define RTC_CNTL_CK8M_FORCE_PU_M (BIT(26))
+#define RTC_CNTL_CK8M_FORCE_PU_V 0x1
+#define RTC_CNTL_CK8M_FORCE_PU_S 26
+#define RTC_CNTL_CK8M_FORCE_PD (BIT(25))
+#define RTC_CNTL_CK8M_FORCE_PD_M (BIT(25))
+#define RTC_CNTL_CK8M_FORCE_PD_V 0x1
+#define RTC_CNTL_CK8M_FORCE_PD_S 25
+#define RTC_CNTL_CK8M_DFREQ 0x000000FF
+#define RTC_CNTL_CK8M_DFREQ_M ((RTC_CNTL_CK8M_DFREQ_V)<<(RTC_CNTL_CK8M_DFREQ_S))
+#define RTC_CNTL_CK8M_DFREQ_V 0xFF
+#define RTC_CNTL_CK8M_DFREQ_S 17
+#define RTC_CNTL_CK8M_FORCE_NOGATING (BIT(16))
+#define RTC_CNTL_CK8M_FORCE_NOGATING_M (BIT(16))
+#define RTC_CNTL_CK8M_FORCE_NOGATING_V 0x1
+#define RTC_CNTL_CK8M_FORCE_NOGATING_S 16
+#define RTC_CNTL_XTAL_FORCE_NOGATING (BIT(15))
+#define RTC_CNTL_XTAL_FORCE_NOGATING_M (BIT(15))
+#define RTC_CNTL_XTAL_FORCE_NOGATING_V 0x1
+#define RTC_CNTL_XTAL_FORCE_NOGATING_S 15
+#define RTC_CNTL_CK8M_DIV_SEL 0x00000007
+#define RTC_CNTL_CK8M_DIV_SEL_M ((RTC_CNTL_CK8M_DIV_SEL_V)<<(RTC_CNTL_CK8M_DIV_SEL_S))
+#define RTC_CNTL_CK8M_DIV_SEL_V 0x7
+#define RTC_CNTL_CK8M_DIV_SEL_S 12
+#define RTC_CNTL_DIG_CLK8M_EN (BIT(10))
+#define RTC_CNTL_DIG_CLK8M_EN_M (BIT(10))
+#define RTC_CNTL_DIG_CLK8M_EN_V 0x1
+#define RTC_CNTL_DIG_CLK8M_EN_S 10
+#define RTC_CNTL_DIG_CLK8M_D256_EN (BIT(9))
+#define RTC_CNTL_DIG_CLK8M_D256_EN_M (BIT(9))
+#define RTC_CNTL_DIG_CLK8M_D256_EN_V 0x1
+#define RTC_CNTL_DIG_CLK8M_D256_EN_S 9
+#define RTC_CNTL_DIG_XTAL32K_EN (BIT(8))
+#define RTC_CNTL_DIG_XTAL32K_EN_M (BIT(8))
+#define RTC_CNTL_DIG_XTAL32K_EN_V 0x1
+#define RTC_CNTL_DIG_XTAL32K_EN_S 8
+#define RTC_CNTL_ENB_CK8M_DIV (BIT(7))
+#define RTC_CNTL_ENB_CK8M_DIV_M (BIT(7))
+#define RTC_CNTL_ENB_CK8M_DIV_V 0x1
+#define RTC_CNTL_ENB_CK8M_DIV_S 7
+#define RTC_CNTL_ENB_CK8M (BIT(6))
+#define RTC_CNTL_ENB_CK8M_M (BIT(6))
+#define RTC_CNTL_ENB_CK8M_V 0x1
+#define RTC_CNTL_ENB_CK8M_S 6
+#define RTC_CNTL_CK8M_DIV 0x00000003
+#define RTC_CNTL_CK8M_DIV_M ((RTC_CNTL_CK8M_DIV_V)<<(RTC_CNTL_CK8M_DIV_S))
+#define RTC_CNTL_CK8M_DIV_V 0x3
+#define RTC_CNTL_CK8M_DIV_S 4
+
+#endif
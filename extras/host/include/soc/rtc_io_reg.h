@@ -0,0 +1,116 @@
+// Host stub of the ESP32 RTCIO register definitions, DAC pads only
+// (extras/host, DacESP32 host build)
+#ifndef DACESP32_HOST_RTC_IO_REG_H
+#define DACESP32_HOST_RTC_IO_REG_H
+
+#include "soc/soc.h"
+
+#define RTC_IO_PAD_DAC1_REG (DR_REG_RTCIO_BASE + 0x84)
+#define RTC_IO_PDAC1_DRV 0x00000003
+#define RTC_IO_PDAC1_DRV_M ((RTC_IO_PDAC1_DRV_V)<<(RTC_IO_PDAC1_DRV_S))
+#define RTC_IO_PDAC1_DRV_V 0x3
+#define RTC_IO_PDAC1_DRV_S 30
+#define RTC_IO_PDAC1_HOLD (BIT(29))
+#define RTC_IO_PDAC1_HOLD_M (BIT(29))
+#define RTC_IO_PDAC1_HOLD_V 0x1
+#define RTC_IO_PDAC1_HOLD_S 29
+#define RTC_IO_PDAC1_RDE (BIT(28))
+#define RTC_IO_PDAC1_RDE_M (BIT(28))
+#define RTC_IO_PDAC1_RDE_V 0x1
+#define RTC_IO_PDAC1_RDE_S 28
+#define RTC_IO_PDAC1_RUE (BIT(27))
+#define RTC_IO_PDAC1_RUE_M (BIT(27))
+#define RTC_IO_PDAC1_RUE_V 0x1
+#define RTC_IO_PDAC1_RUE_S 27
+#define RTC_IO_PDAC1_DAC 0x000000FF
+#define RTC_IO_PDAC1_DAC_M ((RTC_IO_PDAC1_DAC_V)<<(RTC_IO_PDAC1_DAC_S))
+#define RTC_IO_PDAC1_DAC_V 0xFF
+#define RTC_IO_PDAC1_DAC_S 19
+#define RTC_IO_PDAC1_XPD_DAC (BIT(18))
+#define RTC_IO_PDAC1_XPD_DAC_M (BIT(18))
+#define RTC_IO_PDAC1_XPD_DAC_V 0x1
+#define RTC_IO_PDAC1_XPD_DAC_S 18
+#define RTC_IO_PDAC1_MUX_SEL (BIT(17))
+#define RTC_IO_PDAC1_MUX_SEL_M (BIT(17))
+#define RTC_IO_PDAC1_MUX_SEL_V 0x1
+#define RTC_IO_PDAC1_MUX_SEL_S 17
+#define RTC_IO_PDAC1_FUN_SEL 0x00000003
+#define RTC_IO_PDAC1_FUN_SEL_M ((RTC_IO_PDAC1_FUN_SEL_V)<<(RTC_IO_PDAC1_FUN_SEL_S))
+#define RTC_IO_PDAC1_FUN_SEL_V 0x3
+#define RTC_IO_PDAC1_FUN_SEL_S 15
+#define RTC_IO_PDAC1_SLP_SEL (BIT(14))
+#define RTC_IO_PDAC1_SLP_SEL_M (BIT(14))
+#define RTC_IO_PDAC1_SLP_SEL_V 0x1
+#define RTC_IO_PDAC1_SLP_SEL_S 14
+#define RTC_IO_PDAC1_SLP_IE (BIT(13))
+#define RTC_IO_PDAC1_SLP_IE_M (BIT(13))
+#define RTC_IO_PDAC1_SLP_IE_V 0x1
+#define RTC_IO_PDAC1_SLP_IE_S 13
+#define RTC_IO_PDAC1_SLP_OE (BIT(12))
+#define RTC_IO_PDAC1_SLP_OE_M (BIT(12))
+#define RTC_IO_PDAC1_SLP_OE_V 0x1
+#define RTC_IO_PDAC1_SLP_OE_S 12
+#define RTC_IO_PDAC1_FUN_IE (BIT(11))
+#define RTC_IO_PDAC1_FUN_IE_M (BIT(11))
+#define RTC_IO_PDAC1_FUN_IE_V 0x1
+#define RTC_IO_PDAC1_FUN_IE_S 11
+#define RTC_IO_PDAC1_DAC_XPD_FORCE (BIT(10))
+#define RTC_IO_PDAC1_DAC_XPD_FORCE_M (BIT(10))
+#define RTC_IO_PDAC1_DAC_XPD_FORCE_V 0x1
+#define RTC_IO_PDAC1_DAC_XPD_FORCE_S 10
+
+#define RTC_IO_PAD_DAC2_REG (DR_REG_RTCIO_BASE + 0x88)
+#define RTC_IO_PDAC2_DRV 0x00000003
+#define RTC_IO_PDAC2_DRV_M ((RTC_IO_PDAC2_DRV_V)<<(RTC_IO_PDAC2_DRV_S))
+#define RTC_IO_PDAC2_DRV_V 0x3
+#define RTC_IO_PDAC2_DRV_S 30
+#define RTC_IO_PDAC2_HOLD (BIT(29))
+#define RTC_IO_PDAC2_HOLD_M (BIT(29))
+#define RTC_IO_PDAC2_HOLD_V 0x1
+#define RTC_IO_PDAC2_HOLD_S 29
+#define RTC_IO_PDAC2_RDE (BIT(28))
+#define RTC_IO_PDAC2_RDE_M (BIT(28))
+#define RTC_IO_PDAC2_RDE_V 0x1
+#define RTC_IO_PDAC2_RDE_S 28
+#define RTC_IO_PDAC2_RUE (BIT(27))
+#define RTC_IO_PDAC2_RUE_M (BIT(27))
+#define RTC_IO_PDAC2_RUE_V 0x1
+#define RTC_IO_PDAC2_RUE_S 27
+#define RTC_IO_PDAC2_DAC 0x000000FF
+#define RTC_IO_PDAC2_DAC_M ((RTC_IO_PDAC2_DAC_V)<<(RTC_IO_PDAC2_DAC_S))
+#define RTC_IO_PDAC2_DAC_V 0xFF
+#define RTC_IO_PDAC2_DAC_S 19
+#define RTC_IO_PDAC2_XPD_DAC (BIT(18))
+#define RTC_IO_PDAC2_XPD_DAC_M (BIT(18))
+#define RTC_IO_PDAC2_XPD_DAC_V 0x1
+#define RTC_IO_PDAC2_XPD_DAC_S 18
+#define RTC_IO_PDAC2_MUX_SEL (BIT(17))
+#define RTC_IO_PDAC2_MUX_SEL_M (BIT(17))
+#define RTC_IO_PDAC2_MUX_SEL_V 0x1
+#define RTC_IO_PDAC2_MUX_SEL_S 17
+#define RTC_IO_PDAC2_FUN_SEL 0x00000003
+#define RTC_IO_PDAC2_FUN_SEL_M ((RTC_IO_PDAC2_FUN_SEL_V)<<(RTC_IO_PDAC2_FUN_SEL_S))
+#define RTC_IO_PDAC2_FUN_SEL_V 0x3
+#define RTC_IO_PDAC2_FUN_SEL_S 15
+#define RTC_IO_PDAC2_SLP_SEL (BIT(14))
+#define RTC_IO_PDAC2_SLP_SEL_M (BIT(14))
+#define RTC_IO_PDAC2_SLP_SEL_V 0x1
+#define RTC_IO_PDAC2_SLP_SEL_S 14
+#define RTC_IO_PDAC2_SLP_IE (BIT(13))
+#define RTC_IO_PDAC2_SLP_IE_M (BIT(13))
+#define RTC_IO_PDAC2_SLP_IE_V 0x1
+#define RTC_IO_PDAC2_SLP_IE_S 13
+#define RTC_IO_PDAC2_SLP_OE (BIT(12))
+#define RTC_IO_PDAC2_SLP_OE_M (BIT(12))
+#define RTC_IO_PDAC2_SLP_OE_V 0x1
+#define RTC_IO_PDAC2_SLP_OE_S 12
+#define RTC_IO_PDAC2_FUN_IE (BIT(11))
+#define RTC_IO_PDAC2_FUN_IE_M (BIT(11))
+#define RTC_IO_PDAC2_FUN_IE_V 0x1
+#define RTC_IO_PDAC2_FUN_IE_S 11
+#define RTC_IO_PDAC2_DAC_XPD_FORCE (BIT(10))
+#define RTC_IO_PDAC2_DAC_XPD_FORCE_M (BIT(10))
+#define RTC_IO_PDAC2_DAC_XPD_FORCE_V 0x1
+#define RTC_IO_PDAC2_DAC_XPD_FORCE_S 10
+
+#endif
@@ -0,0 +1,72 @@
+// Host stub of the ESP32 SENS register definitions, DAC control only
+// (extras/host, DacESP32 host build)
+#ifndef DACESP32_HOST_SENS_REG_H
+#define DACESP32_HOST_SENS_REG_H
+
+#include "soc/soc.h"
+
+#define SENS_SAR_DAC_CTRL1_REG (DR_REG_SENS_BASE + 0x0098)
+#define SENS_DAC_CLK_INV (BIT(25))
+#define SENS_DAC_CLK_INV_M (BIT(25))
+#define SENS_DAC_CLK_INV_V 0x1
+#define SENS_DAC_CLK_INV_S 25
+#define SENS_DAC_CLK_FORCE_HIGH (BIT(24))
+#define SENS_DAC_CLK_FORCE_HIGH_M (BIT(24))
+#define SENS_DAC_CLK_FORCE_HIGH_V 0x1
+#define SENS_DAC_CLK_FORCE_HIGH_S 24
+#define SENS_DAC_CLK_FORCE_LOW (BIT(23))
+#define SENS_DAC_CLK_FORCE_LOW_M (BIT(23))
+#define SENS_DAC_CLK_FORCE_LOW_V 0x1
+#define SENS_DAC_CLK_FORCE_LOW_S 23
+#define SENS_DAC_DIG_FORCE (BIT(22))
+#define SENS_DAC_DIG_FORCE_M (BIT(22))
+#define SENS_DAC_DIG_FORCE_V 0x1
+#define SENS_DAC_DIG_FORCE_S 22
+#define SENS_DEBUG_BIT_SEL 0x0000001F
+#define SENS_DEBUG_BIT_SEL_M ((SENS_DEBUG_BIT_SEL_V)<<(SENS_DEBUG_BIT_SEL_S))
+#define SENS_DEBUG_BIT_SEL_V 0x1F
+#define SENS_DEBUG_BIT_SEL_S 17
+#define SENS_SW_TONE_EN (BIT(16))
+#define SENS_SW_TONE_EN_M (BIT(16))
+#define SENS_SW_TONE_EN_V 0x1
+#define SENS_SW_TONE_EN_S 16
+#define SENS_SW_FSTEP 0x0000FFFF
+#define SENS_SW_FSTEP_M ((SENS_SW_FSTEP_V)<<(SENS_SW_FSTEP_S))
+#define SENS_SW_FSTEP_V 0xFFFF
+#define SENS_SW_FSTEP_S 0
+
+#define SENS_SAR_DAC_CTRL2_REG (DR_REG_SENS_BASE + 0x009c)
+#define SENS_DAC_CW_EN2 (BIT(25))
+#define SENS_DAC_CW_EN2_M (BIT(25))
+#define SENS_DAC_CW_EN2_V 0x1
+#define SENS_DAC_CW_EN2_S 25
+#define SENS_DAC_CW_EN1 (BIT(24))
+#define SENS_DAC_CW_EN1_M (BIT(24))
+#define SENS_DAC_CW_EN1_V 0x1
+#define SENS_DAC_CW_EN1_S 24
+#define SENS_DAC_INV2 0x00000003
+#define SENS_DAC_INV2_M ((SENS_DAC_INV2_V)<<(SENS_DAC_INV2_S))
+#define SENS_DAC_INV2_V 0x3
+#define SENS_DAC_INV2_S 22
+#define SENS_DAC_INV1 0x00000003
+#define SENS_DAC_INV1_M ((SENS_DAC_INV1_V)<<(SENS_DAC_INV1_S))
+#define SENS_DAC_INV1_V 0x3
+#define SENS_DAC_INV1_S 20
+#define SENS_DAC_SCALE2 0x00000003
+#define SENS_DAC_SCALE2_M ((SENS_DAC_SCALE2_V)<<(SENS_DAC_SCALE2_S))
+#define SENS_DAC_SCALE2_V 0x3
+#define SENS_DAC_SCALE2_S 18
+#define SENS_DAC_SCALE1 0x00000003
+#define SENS_DAC_SCALE1_M ((SENS_DAC_SCALE1_V)<<(SENS_DAC_SCALE1_S))
+#define SENS_DAC_SCALE1_V 0x3
+#define SENS_DAC_SCALE1_S 16
+#define SENS_DAC_DC2 0x000000FF
+#define SENS_DAC_DC2_M ((SENS_DAC_DC2_V)<<(SENS_DAC_DC2_S))
+#define SENS_DAC_DC2_V 0xFF
+#define SENS_DAC_DC2_S 8
+#define SENS_DAC_DC1 0x000000FF
+#define SENS_DAC_DC1_M ((SENS_DAC_DC1_V)<<(SENS_DAC_DC1_S))
+#define SENS_DAC_DC1_V 0xFF
+#define SENS_DAC_DC1_S 0
+
+#endif
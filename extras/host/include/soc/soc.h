@@ -0,0 +1,33 @@
+// Host stub of the ESP32 soc definitions (extras/host, DacESP32 host build).
+// The register access macros work on the emulated register file (DacEspHal).
+#ifndef DACESP32_HOST_SOC_H
+#define DACESP32_HOST_SOC_H
+
+#include <stdint.h>
+
+#define BIT(nr) (1UL << (nr))
+
+#define DR_REG_RTCCNTL_BASE 0x3ff48000
+#define DR_REG_RTCIO_BASE   0x3ff48400
+#define DR_REG_SENS_BASE    0x3ff48800
+
+uint32_t dac_host_reg_read(uint32_t addr);
+void     dac_host_reg_write(uint32_t addr, uint32_t value);
+
+#define READ_PERI_REG(addr)               dac_host_reg_read((uint32_t)(addr))
+#define WRITE_PERI_REG(addr, val)         dac_host_reg_write((uint32_t)(addr), (uint32_t)(val))
+#define REG_READ(addr)                    READ_PERI_REG(addr)
+#define REG_WRITE(addr, val)              WRITE_PERI_REG(addr, val)
+#define SET_PERI_REG_MASK(addr, mask)     WRITE_PERI_REG(addr, READ_PERI_REG(addr) | (mask))
+#define CLEAR_PERI_REG_MASK(addr, mask)   WRITE_PERI_REG(addr, READ_PERI_REG(addr) & ~(uint32_t)(mask))
+#define GET_PERI_REG_MASK(addr, mask)     (READ_PERI_REG(addr) & (mask))
+#define SET_PERI_REG_BITS(addr, bit_map, value, shift) \
+  WRITE_PERI_REG(addr, (READ_PERI_REG(addr) & ~((uint32_t)(bit_map) << (shift))) | \
+                       (((uint32_t)(value) & (bit_map)) << (shift)))
+#define GET_PERI_REG_BITS2(addr, mask, shift) ((READ_PERI_REG(addr) >> (shift)) & (mask))
+#define REG_SET_BIT(addr, bit)            SET_PERI_REG_MASK(addr, bit)
+#define REG_CLR_BIT(addr, bit)            CLEAR_PERI_REG_MASK(addr, bit)
+#define REG_GET_FIELD(addr, field)        ((READ_PERI_REG(addr) >> (field##_S)) & (field##_V))
+#define REG_SET_FIELD(addr, field, val)   SET_PERI_REG_BITS(addr, field##_V, val, field##_S)
+
+#endif
@@ -0,0 +1,163 @@
+/*
+  stressTest, host test of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Multithreaded stress test of the register locking on the host build
+  (extras/host), host variant of example sketch stressTest.ino. Two POSIX
+  threads drive channel 1 and channel 2 concurrently with the DacESP32 and
+  DacEspIsr functions on the emulated registers and check after every call
+  that the fields of their channel hold the values written last (no lost
+  update by the other thread). At the end the DacEspRegs shadow copies get
+  compared with the registers.
+
+  Built & run by the CMake project in extras/host (ctest).
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <pthread.h>
+#include <atomic>
+#include "DacEspHostSim.h"
+#include "DacESP32.h"
+#include "DacEspRegs.h"
+#include "DacEspIsr.h"
+#include "DacEspState.h"
+
+#define ITERATIONS 200000
+
+typedef struct {
+  DacESP32     *dac;
+  uint32_t      errors;
+} stress_t;
+
+static std::atomic<int> s_ready(0);
+
+//
+// Checks the fields of a channel. The other thread never writes them, so
+// they must hold the values this thread has written last.
+//
+static bool channelOk(dac_channel_t channel, bool enabled, bool cw, uint8_t value,
+                      dac_cw_scale_t scale, dac_cw_phase_t phase, int8_t offset)
+{
+  dac_reg_dump_t regs;
+  dac_state_t state;
+
+  DacEspRegs::capture(&regs);
+  DacEspState::decode(regs, CK8M, &state);
+  const dac_channel_state_t &c = state.channel[channel];
+
+  return c.outputEnabled == enabled && c.cwEnabled == cw && (cw || c.value == value) &&
+         c.scale == scale && c.invert == phase && c.offset == offset;
+}
+
+static void *stressThread(void *arg)
+{
+  stress_t *s = (stress_t *)arg;
+  DacESP32 &dac = *s->dac;
+  dac_channel_t channel = dac.getChannel();
+  uint32_t seed = 12345 + channel;
+  dac_cw_scale_t scale = DAC_CW_SCALE_1;
+  dac_cw_phase_t phase = DAC_CW_PHASE_0;
+  int8_t offset = 0;
+  uint8_t value = 0;
+  bool enabled = false, cw = false;
+
+  // start both threads at the same time
+  s_ready++;
+  while (s_ready < 2) {
+  }
+
+  for (uint32_t i = 0; i < ITERATIONS; i++) {
+    seed = seed * 1103515245 + 12345;
+    uint32_t r = seed >> 8;
+    switch (r % 7) {
+      case 0:
+        scale = (dac_cw_scale_t)((r >> 4) & 3);
+        dac.setCwScale(scale);
+        break;
+      case 1:
+        phase = ((r >> 4) & 1) ? DAC_CW_PHASE_180 : DAC_CW_PHASE_0;
+        dac.setCwPhase(phase);
+        break;
+      case 2:
+        offset = (int8_t)(r >> 4);
+        dac.setCwOffset(offset);
+        break;
+      case 3:
+        value = (uint8_t)(r >> 4);
+        dac.outputVoltage(value);
+        enabled = true;
+        cw = false;
+        break;
+      case 4:
+        // ISR variants use the same lock
+        offset = (int8_t)(r >> 4);
+        DacEspIsr::setCwOffset(channel, offset);
+        break;
+      case 5:
+        value = (uint8_t)(r >> 4);
+        DacEspIsr::outputVoltage(channel, value);
+        enabled = true;
+        cw = false;
+        break;
+      default:
+        // same frequency on both channels, the CW generator is shared
+        dac.outputCW(1000, scale, phase, offset);
+        enabled = cw = true;
+        break;
+    }
+    if (!channelOk(channel, enabled, cw, value, scale, phase, offset)) {
+      s->errors++;
+    }
+  }
+
+  return NULL;
+}
+
+int main()
+{
+  DacEspHostSim::reset();
+
+  DacESP32 dac1(DAC_CHANNEL_1), dac2(DAC_CHANNEL_2);
+  stress_t stress[2] = { { &dac1, 0 }, { &dac2, 0 } };
+  pthread_t threads[2];
+
+  for (int i = 0; i < 2; i++) {
+    if (pthread_create(&threads[i], NULL, stressThread, &stress[i]) != 0) {
+      printf("FAILED: thread could not be created\n");
+      return 1;
+    }
+  }
+  for (int i = 0; i < 2; i++) {
+    pthread_join(threads[i], NULL);
+  }
+
+  uint32_t mismatch = DacEspRegs::verify();
+  bool failed = stress[0].errors || stress[1].errors || mismatch;
+
+  printf("%d iterations per channel\n", ITERATIONS);
+  printf("lost updates: channel 1 %u, channel 2 %u\n", stress[0].errors, stress[1].errors);
+  printf("shadow copies differing from registers: 0x%02x\n", mismatch);
+  printf("%s\n", failed ? "FAILED" : "PASSED");
+
+  return failed ? 1 : 0;
+}
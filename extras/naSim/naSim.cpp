@@ -0,0 +1,131 @@
+/*
+  naSim, host tool of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Host test of the network analyzer DSP (src/DacEspGoertzel.cpp) with
+  synthetic data: for a log sweep over the frequencies the CW generator
+  really outputs it generates I2S ADC sample words of reference and
+  response channel (RC lowpass or RLC bandpass as device, random start
+  phase, 12-bit quantization, gaussian noise), evaluates them like
+  DacEspAnalyzer does and prints measured against theoretical gain and
+  phase. Exit status is 1 if a point above -40 dB is off by more than
+  0.1 dB or 1 degree (ctest runs it for both devices).
+
+  Build & run on a host (from this directory):
+    g++ -O2 -I../../src naSim.cpp ../../src/DacEspGoertzel.cpp ../../src/DacEspCwSolver.cpp -o naSim
+    ./naSim [lowpass|bandpass] [fc Hz (2000)] [noise counts rms (2)] [samples/s (100000)]
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <complex>
+#include <random>
+#include "DacEspGoertzel.h"
+#include "DacEspCwSolver.h"
+
+#define REF_CHANNEL  6
+#define RESP_CHANNEL 7
+#define SAMPLES_MAX  2048
+
+// max. deviation from theory for responses above -40dB
+#define GAIN_ERR_MAX  0.1   // dB
+#define PHASE_ERR_MAX 1.0   // degree
+
+//
+// Transfer function of the simulated device: RC lowpass or series RLC bandpass.
+//
+static std::complex<double> device(bool bandpass, double fc, double q, double f)
+{
+  std::complex<double> s(0, f / fc);
+  return bandpass ? (s / q) / (s * s + s / q + 1.0) : 1.0 / (1.0 + s);
+}
+
+int main(int argc, char *argv[])
+{
+  bool bandpass = argc > 1 && argv[1][0] == 'b';
+  double fc = argc > 2 ? atof(argv[2]) : 2000;
+  double noise = argc > 3 ? atof(argv[3]) : 2;
+  double sampleRate = argc > 4 ? atof(argv[4]) : 100000;
+  double q = 2;
+  dac_cw_solver_params_t params = { 8000000UL, 7, 256, 0 };
+  std::mt19937 rng(1);
+  std::normal_distribution<double> gauss(0, noise);
+  static uint16_t words[2 * SAMPLES_MAX + 1];
+  double gainErrMax = 0, phaseErrMax = 0;
+
+  printf("# %s fc %.0f Hz, noise %.1f counts rms, %.0f samples/s\n", bandpass ? "bandpass Q 2" : "lowpass", fc,
+         noise, sampleRate);
+  printf("#  freq(Hz)   gain(dB)   theory   phase(deg)  theory\n");
+  for (int i = 0; i < 25; i++) {
+    // log sweep 100Hz...20kHz with the frequencies the CW generator really outputs
+    dac_cw_solution_t solution;
+    if (!DacEspCwSolver::solve((uint32_t)(100 * pow(200, i / 24.0)), params, &solution)) {
+      continue;
+    }
+    double f = solution.fcw;
+    if (f >= sampleRate / 4) {
+      break;
+    }
+    std::complex<double> h = device(bandpass, fc, q, f);
+
+    // ADC words: reference & response alternating, response 1 / sampleRate later,
+    // random phase of the CW output at capture start, capture starting with either channel
+    uint32_t samples = DacEspGoertzel::coherentLength(sampleRate / 2, f, SAMPLES_MAX);
+    double phase0 = 2 * M_PI * (rng() % 3600) / 3600.0;
+    int first = rng() & 1;
+    size_t count = 2 * samples + 1;
+    for (size_t k = 0; k < count; k++) {
+      int channel = ((k + first) & 1) ? RESP_CHANNEL : REF_CHANNEL;
+      double t = k / sampleRate;
+      double v = 1500 * cos(2 * M_PI * f * t + phase0);
+      if (channel == RESP_CHANNEL) {
+        v = 1500 * std::abs(h) * cos(2 * M_PI * f * t + phase0 + std::arg(h));
+      }
+      long code = lround(2048 + v + gauss(rng));
+      code = code < 0 ? 0 : (code > 4095 ? 4095 : code);
+      words[k] = (uint16_t)((channel << DAC_GOERTZEL_CHANNEL_S) | code);
+    }
+
+    dac_goertzel_response_t r;
+    if (!DacEspGoertzel::response(words, count, REF_CHANNEL, RESP_CHANNEL, sampleRate, f, &r)) {
+      printf("%10.0f  evaluation failed\n", f);
+      return 1;
+    }
+    double gain = 20 * log10(std::abs(h)), phase = std::arg(h) * 180 / M_PI;
+    double phaseErr = fabs(remainder(r.phase - phase, 360.0));
+    printf("%10.0f %10.3f %8.3f %10.2f %9.2f\n", f, r.gainDb, gain, r.phase, phase);
+    if (gain > -40) {
+      gainErrMax = fmax(gainErrMax, fabs(r.gainDb - gain));
+      phaseErrMax = fmax(phaseErrMax, phaseErr);
+    }
+  }
+  printf("# max. error above -40dB: gain %.3f dB, phase %.2f deg\n", gainErrMax, phaseErrMax);
+  if (gainErrMax > GAIN_ERR_MAX || phaseErrMax > PHASE_ERR_MAX) {
+    printf("# FAILED, limits %.3f dB, %.2f deg\n", GAIN_ERR_MAX, PHASE_ERR_MAX);
+    return 1;
+  }
+
+  return 0;
+}
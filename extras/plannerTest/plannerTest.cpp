@@ -0,0 +1,166 @@
+/*
+  plannerTest, host tool of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Test of the coherent sampling planner (src/DacEspPlanner.cpp, compiled
+  into this file) for both ADC clock modes (fixed clock and
+  DAC_PLAN_ADC_CLOCK_CK8M). Exact plans have to fulfill
+  fcw * N == M * sampleRate as exact rational (128 bit integers), every
+  plan gcd(M, N) == 1, M < N / 2, the CW frequency below Nyquist, the
+  coherence error reported and the limits given. Edge cases use ADC
+  dividers up to 2^32 - 1, where RTC8M_CLK * SW_FSTEP * adcDiv exceeds
+  64 bit.
+
+  Build & run on a host (from this directory):
+    g++ -O2 -I../../src plannerTest.cpp -o plannerTest
+    ./plannerTest [random cases (300)] [seed (1)]
+  The host build (extras/host) runs it with ctest as well.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <random>
+#include "../../src/DacEspPlanner.cpp"
+
+#define PLANS_MAX 16
+
+static uint64_t failures;
+
+#define CHECK(cond, ...)                                                              \
+  do {                                                                                \
+    if (!(cond)) {                                                                    \
+      if (failures++ < 20) {                                                          \
+        printf("FAIL %s: f %u ck8m %u adcClock %u adcDiv %u...%u record %u...%u%s: ", \
+               #cond, frequency, params.ck8m, params.adcClock, params.adcDivMin,      \
+               params.adcDivMax, params.recordMin, params.recordMax,                  \
+               params.powerOfTwo ? " (2^n)" : "");                                    \
+        printf(__VA_ARGS__);                                                          \
+        printf("\n");                                                                 \
+      }                                                                               \
+      return;                                                                         \
+    }                                                                                 \
+  } while (0)
+
+//
+// Check all plans found for one case. Exact plans have to fulfill
+// fcw * N == M * sampleRate as exact rational, all plans gcd(M, N) == 1,
+// M < N / 2 and the limits given.
+//
+static void checkCase(uint32_t frequency, const dac_plan_params_t &params, bool exactExpected = false)
+{
+  dac_plan_t plans[PLANS_MAX];
+  size_t count = DacEspPlanner::plan(frequency, params, plans, PLANS_MAX);
+  bool ck8mClock = params.adcClock == DAC_PLAN_ADC_CLOCK_CK8M;
+
+  CHECK(count <= PLANS_MAX, "%u plans", (unsigned)count);
+  CHECK(!exactExpected || (count > 0 && plans[0].exact), "no exact plan found");
+  for (size_t i = 0; i < count; i++) {
+    const dac_plan_t &p = plans[i];
+    uint64_t n = p.record, m = p.cycles;
+
+    CHECK(p.clk8mDiv <= params.divMax, "div %u", p.clk8mDiv);
+    CHECK(p.frequencyStep >= 1 && p.frequencyStep <= params.fstepMax, "fstep %u", p.frequencyStep);
+    CHECK(p.adcDiv >= params.adcDivMin && p.adcDiv <= params.adcDivMax, "adcDiv %u", p.adcDiv);
+    CHECK(n >= params.recordMin && n <= params.recordMax && (!params.powerOfTwo || isPowerOfTwo(n)), "N %u",
+          p.record);
+    CHECK(m >= 1 && 2 * m < n, "M %u, N %u", p.cycles, p.record);
+    CHECK(2 * p.fcw < p.sampleRate, "fcw %.3f, sample rate %.3f", p.fcw, p.sampleRate);
+    CHECK(gcd(m, n) == 1, "M %u, N %u not coprime", p.cycles, p.record);
+    if (params.toleranceHz) {
+      CHECK(fabs(p.fcw - frequency) <= params.toleranceHz, "fcw %.3f", p.fcw);
+    }
+    // fcw * N / sampleRate - M as exact fraction (128 bit)
+    //   fcw = ck8m * fstep / ((1 + div) * 65536), sampleRate = clock / adcDiv
+    unsigned __int128 lhs, rhs;
+    if (ck8mClock) {
+      lhs = (unsigned __int128)p.frequencyStep * n * p.adcDiv;
+      rhs = (unsigned __int128)m << 16;
+    } else {
+      lhs = (unsigned __int128)params.ck8m * p.frequencyStep * n * p.adcDiv;
+      rhs = (unsigned __int128)m * params.adcClock * ((uint64_t)(1 + p.clk8mDiv) << 16);
+    }
+    CHECK(p.exact == (lhs == rhs), "exact %d, fcw * N %s M * sampleRate (div %u fstep %u adcDiv %u N %u M %u)",
+          p.exact, lhs == rhs ? "==" : "!=", p.clk8mDiv, p.frequencyStep, p.adcDiv, p.record, p.cycles);
+    double clock = ck8mClock ? (double)params.ck8m / (1 + p.clk8mDiv) : params.adcClock;
+    double error = fabs(p.fcw * n * p.adcDiv / clock - m);
+    CHECK(fabs(p.error - error) < 1e-6 * n, "error %g, recalculated %g", p.error, error);
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  uint32_t cases = argc > 1 ? (uint32_t)atol(argv[1]) : 300UL;
+  uint32_t seed = argc > 2 ? (uint32_t)atol(argv[2]) : 1;
+  std::mt19937 rng(seed);
+  uint64_t checked = 0;
+
+  // ADC clocked by RTC8M_CLK: the denominator is a power of 2 up to 65536,
+  // hence an exact plan always exists for power of 2 records 2...65536
+  for (uint32_t frequency : { 100U, 1000U, 10000U, 31000U, 62500U, 124999U }) {
+    for (uint32_t ck8m : { 8000000U, 8123456U }) {
+      dac_plan_params_t params = { ck8m, 7, 256, 0, DAC_PLAN_ADC_CLOCK_CK8M, 1, 64, 2, 65536, true };
+      checkCase(frequency, params, (uint64_t)frequency * 65536 <= (uint64_t)ck8m * params.fstepMax);
+      checked++;
+    }
+  }
+
+  // fixed ADC clock, dividers big enough for ck8m * fstep * adcDiv to exceed 64 bit
+  for (uint32_t adcDivMin : { 1U, 1U << 16, 1U << 20, 0xFFFFFF00U }) {
+    uint32_t frequency = 4000000;
+    dac_plan_params_t params = { 0xFFFFFFFFU, 7, 0xFFFF, 0, 0xFFFFFFFFU, adcDivMin, adcDivMin + 0xFF, 2, 1024, false };
+    checkCase(frequency, params);
+    params.adcDivMax = 0xFFFFFFFFU;
+    params.recordMax = 64;
+    checkCase(frequency, params);
+    checked += 2;
+  }
+  // ck8m * fstep * adcDiv = 2^31 * 2^15 * 2^18 wraps to 0 in 64 bit, far above Nyquist
+  {
+    uint32_t frequency = 1U << 30;
+    dac_plan_params_t params = { 1U << 31, 0, 0xFFFF, 0, 0xFFFFFFFFU, 1U << 18, (1U << 18) + 0xFF, 2, 1024, false };
+    checkCase(frequency, params);
+    checked++;
+  }
+  printf("%llu edge cases checked\n", (unsigned long long)checked);
+
+  // random clocks, limits & targets, both ADC clock modes
+  for (uint32_t i = 0; i < cases; i++) {
+    dac_plan_params_t params;
+    params.ck8m = 7500000 + rng() % 1000000;
+    params.divMax = rng() % 8;
+    params.fstepMax = 1 + rng() % 512;
+    params.toleranceHz = (rng() % 2) ? rng() % 50 : 0;
+    params.adcClock = (rng() % 2) ? DAC_PLAN_ADC_CLOCK_CK8M : 1000000 + rng() % 40000000;
+    params.adcDivMin = 1 + rng() % 64;
+    params.adcDivMax = params.adcDivMin + rng() % 16;
+    params.powerOfTwo = rng() % 2;
+    params.recordMin = 2 + rng() % 256;
+    params.recordMax = params.recordMin + rng() % (params.powerOfTwo ? 65536 : 1024);
+    uint32_t frequency = 1 + rng() % 100000;
+    checkCase(frequency, params);
+  }
+  printf("%u random cases checked (seed %u), %llu failures\n", cases, seed, (unsigned long long)failures);
+
+  return failures ? 1 : 0;
+}
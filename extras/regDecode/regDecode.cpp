@@ -0,0 +1,60 @@
+/*
+  regDecode, host tool of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Decodes register dumps captured on a board. Every input line containing
+  a dump as printed by DacESP32::printDacRegisterSettings() or
+  DacEspState::formatDump()
+    DACREGS clkConf ctrl1 ctrl2 padDac1 padDac2
+  gets decoded with class DacEspState (the same decoder DacESP32::getState()
+  uses), other lines are ignored. Serial monitor logs can be used as is.
+
+  Build & run on a host (from this directory):
+    g++ -O2 -I../../src regDecode.cpp ../../src/DacEspState.cpp ../../src/DacEspCwModel.cpp ../../src/DacEspCwSolver.cpp -o regDecode
+    ./regDecode [RTC8M_CLK Hz (8000000)] < serial.log
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "DacEspState.h"
+
+int main(int argc, char *argv[])
+{
+  uint32_t ck8m = argc > 1 ? (uint32_t)atol(argv[1]) : 8000000UL;
+  char line[512], text[1024];
+  unsigned count = 0;
+
+  while (fgets(line, sizeof(line), stdin) != NULL) {
+    dac_reg_dump_t regs;
+    dac_state_t state;
+
+    if (!DacEspState::parseDump(line, &regs)) {
+      continue;
+    }
+    DacEspState::decode(regs, ck8m, &state);
+    DacEspState::format(state, text, sizeof(text));
+    printf("#%u %s%s\n", ++count, line, text);
+  }
+
+  return count ? 0 : 1;
+}
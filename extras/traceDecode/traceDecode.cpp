@@ -0,0 +1,85 @@
+/*
+  traceDecode, host tool of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Decodes a register write trace recorded with DACESP32_TRACE_ENABLED and
+  output with DacEspTrace::dump() (binary, format see DacEspTraceFormat.h).
+  Every write gets printed with its time relative to the first entry, CPU
+  core, calling API, register, old & new value and the bits changed.
+
+  Build & run on a host (from this directory):
+    g++ -O2 -I../../src traceDecode.cpp -o traceDecode
+    ./traceDecode trace.bin
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <stdio.h>
+#include "DacEspTraceFormat.h"
+
+static const char *apiNames[] = DAC_TRACE_API_NAMES;
+static const char *regNames[DAC_TRACE_REGS] = { "CLK_CONF", "DAC_CTRL1", "DAC_CTRL2", "PAD_DAC1", "PAD_DAC2" };
+
+int main(int argc, char *argv[])
+{
+  FILE *file = argc > 1 ? fopen(argv[1], "rb") : stdin;
+  dac_trace_header_t header;
+  dac_trace_entry_t entry;
+  uint32_t start = 0;
+
+  if (file == NULL) {
+    fprintf(stderr, "cannot open %s\n", argv[1]);
+    return 1;
+  }
+  if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != DAC_TRACE_MAGIC) {
+    fprintf(stderr, "no trace dump\n");
+    return 1;
+  }
+  if (header.version != DAC_TRACE_VERSION || header.ccountMhz == 0) {
+    fprintf(stderr, "unsupported trace version %u\n", header.version);
+    return 1;
+  }
+  printf("%u writes recorded, last %u kept, %u MHz\n", header.writes, header.count, header.ccountMhz);
+  printf("     #        us core api                       register             old        new     change\n");
+
+  uint32_t seq = header.writes - header.count;
+  for (uint32_t i = 0; i < header.count; i++, seq++) {
+    if (fread(&entry, sizeof(entry), 1, file) != 1) {
+      fprintf(stderr, "trace truncated after %u entries\n", i);
+      return 1;
+    }
+    if (i == 0) {
+      start = entry.ccount;
+    }
+    // cycle counter wraps around, differences stay valid (< 2^32 cycles)
+    double us = (double)(uint32_t)(entry.ccount - start) / header.ccountMhz;
+    const char *api = entry.api < DAC_API_MAX ? apiNames[entry.api] : "?";
+    const char *reg = entry.reg < DAC_TRACE_REGS ? regNames[entry.reg] : "?";
+    uint32_t addr = entry.reg < DAC_TRACE_REGS ? header.addr[entry.reg] : 0;
+
+    printf("%6u %9.1f %4u %-25s %-9s %08x %08x->%08x %08x%s\n", seq, us, entry.core, api, reg, addr,
+           entry.oldValue, entry.newValue, entry.oldValue ^ entry.newValue,
+           (entry.flags & DAC_TRACE_FLAG_DRIVER) ? " (driver)" : "");
+  }
+
+  return 0;
+}
@@ -0,0 +1,171 @@
+/*
+  trimSearchTest, host tool of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Test of the RTC8M_CLK trim search (src/DacEspTrimSearch.cpp, compiled
+  into this file) against simulated clocks: rising linear and non-linear
+  curves, flat regions, noise and targets out of range. It checks that the
+  CK8M_DFREQ value found is as close to the target as the best of all 256
+  values, that no more than 10 measurements are needed and that every
+  failing measurement ends the search.
+
+  Build & run on a host (from this directory):
+    g++ -O2 -I../../src trimSearchTest.cpp -o trimSearchTest
+    ./trimSearchTest [random cases (10000)] [seed (1)]
+  The host build (extras/host) runs it with ctest as well.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <random>
+#include "../../src/DacEspTrimSearch.cpp"
+
+static uint64_t failures;
+
+#define CHECK(cond, ...)                                                              \
+  do {                                                                                \
+    if (!(cond)) {                                                                    \
+      if (failures++ < 20) {                                                          \
+        printf("FAIL %s: target %u f(0) %u f(255) %u: ", #cond, target,               \
+               clock.frequency[0], clock.frequency[DAC_TRIM_DFREQ_MAX]);              \
+        printf(__VA_ARGS__);                                                          \
+        printf("\n");                                                                 \
+      }                                                                               \
+      return;                                                                         \
+    }                                                                                 \
+  } while (0)
+
+// simulated RTC8M_CLK: frequency for every CK8M_DFREQ value, rising
+typedef struct {
+  uint32_t frequency[DAC_TRIM_DFREQ_MAX + 1];
+  uint32_t measurements;    // measurements done
+  uint32_t failAt;          // measurement returning 0 (1...n, 0 = none)
+} sim_clock_t;
+
+static uint32_t measure(uint8_t dfreq, void *arg)
+{
+  sim_clock_t *clock = (sim_clock_t *)arg;
+
+  if (++clock->measurements == clock->failAt) {
+    return 0;
+  }
+  return clock->frequency[dfreq];
+}
+
+static uint32_t distance(uint32_t f, uint32_t target)
+{
+  return f > target ? f - target : target - f;
+}
+
+//
+// Search one target & compare with the closest value of all CK8M_DFREQ values.
+//
+static void checkCase(uint32_t target, sim_clock_t &clock)
+{
+  dac_trim_result_t result;
+  uint32_t best = 0xFFFFFFFF;
+
+  for (uint32_t dfreq = 0; dfreq <= DAC_TRIM_DFREQ_MAX; dfreq++) {
+    if (distance(clock.frequency[dfreq], target) < best) {
+      best = distance(clock.frequency[dfreq], target);
+    }
+  }
+
+  clock.measurements = 0;
+  clock.failAt = 0;
+  CHECK(DacEspTrimSearch::search(target, measure, &clock, &result), "search failed");
+  CHECK(result.frequency == clock.frequency[result.dfreq], "dfreq %u f %u", result.dfreq, result.frequency);
+  CHECK(distance(result.frequency, target) == best, "dfreq %u f %u, best distance %u", result.dfreq,
+        result.frequency, best);
+  CHECK(result.measurements == clock.measurements && result.measurements <= 10, "%u measurements (%u)",
+        result.measurements, clock.measurements);
+
+  // every failing measurement ends the search
+  for (uint32_t failAt = 1; failAt <= result.measurements; failAt++) {
+    clock.measurements = 0;
+    clock.failAt = failAt;
+    CHECK(!DacEspTrimSearch::search(target, measure, &clock, &result), "failing measurement %u ignored", failAt);
+    CHECK(clock.measurements == failAt, "%u measurements after failing measurement %u", clock.measurements,
+          failAt);
+  }
+}
+
+//
+// Fill in a clock curve: f(0), slope (Hz per step), curvature & flat regions
+// (the oscillator only changes every n-th value), noise keeps it rising.
+//
+static void makeClock(sim_clock_t &clock, uint32_t f0, uint32_t slope, int32_t curvature, uint32_t flat,
+                      uint32_t noise, std::mt19937 &rng)
+{
+  uint32_t f = f0;
+
+  for (uint32_t dfreq = 0; dfreq <= DAC_TRIM_DFREQ_MAX; dfreq++) {
+    if (dfreq > 0 && dfreq % flat == 0) {
+      int32_t step = (int32_t)slope + curvature * ((int32_t)dfreq - 128) / 128;
+      f += (uint32_t)(step > 0 ? step : 0) + (noise ? rng() % noise : 0);
+    }
+    clock.frequency[dfreq] = f;
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  uint32_t cases = argc > 1 ? (uint32_t)atol(argv[1]) : 10000UL;
+  uint32_t seed = argc > 2 ? (uint32_t)atol(argv[2]) : 1;
+  std::mt19937 rng(seed);
+  uint64_t checked = 0;
+  sim_clock_t clock;
+
+  // edge cases: every value of typical curves & its neighbours, out of range targets
+  const struct { uint32_t f0, slope; int32_t curvature; uint32_t flat; } curves[] = {
+    { 4560000, 20000, 0, 1 }, { 4560000, 20000, 10000, 1 }, { 4560000, 20000, -15000, 1 },
+    { 6000000, 40000, 0, 4 }, { 8000000, 0, 0, 1 }, { 7990000, 1, 0, 1 } };
+
+  for (auto curve : curves) {
+    makeClock(clock, curve.f0, curve.slope, curve.curvature, curve.flat, 0, rng);
+    for (uint32_t dfreq = 0; dfreq <= DAC_TRIM_DFREQ_MAX; dfreq++) {
+      uint32_t f = clock.frequency[dfreq];
+      for (uint32_t target : { f - 1, f, f + 1, f + curve.slope / 2, f + curve.slope / 2 + 1 }) {
+        checkCase(target, clock);
+        checked++;
+      }
+    }
+    for (uint32_t target : { 0UL, 1UL, 8000000UL, 0xFFFFFFFFUL }) {
+      checkCase(target, clock);
+      checked++;
+    }
+  }
+  printf("%llu edge cases checked\n", (unsigned long long)checked);
+
+  // random curves & targets, mostly within the range of the curve
+  for (uint32_t i = 0; i < cases; i++) {
+    makeClock(clock, 1000000 + rng() % 8000000, rng() % 50000, (int32_t)(rng() % 40001) - 20000,
+              1 + rng() % 8, rng() % 2000, rng);
+    uint32_t low = clock.frequency[0], high = clock.frequency[DAC_TRIM_DFREQ_MAX];
+    uint32_t target = (rng() % 8) ? low - 10000 + rng() % (high - low + 20001) : rng();
+    checkCase(target, clock);
+  }
+  printf("%u random cases checked (seed %u), %llu failures\n", cases, seed, (unsigned long long)failures);
+
+  return failures ? 1 : 0;
+}
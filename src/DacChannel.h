@@ -0,0 +1,188 @@
+/*
+  DacChannel, compile-time DAC channel access for the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Compile-time specialized access to one DAC channel. Register addresses,
+  bit masks and shifts get resolved by the compiler, hence there is no
+  channel check or branch at runtime. Each operation is one or two shadow
+  register updates inside the shared register lock, the ...Locked()
+  variants leave the locking to the caller. Class DacESP32 uses it
+  internally.
+  Arguments are not checked, invalid values get masked off.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef DacChannel_h
+#define DacChannel_h
+
+#include "DacESP32.h"
+#include "DacEspRegs.h"
+
+// register addresses & masks of a DAC channel
+template <dac_channel_t CH> struct DacChannelRegs;
+
+template <> struct DacChannelRegs<DAC_CHANNEL_1>
+{
+  static constexpr dac_reg_t padReg       = DAC_REG_PAD_DAC1;
+  static constexpr uint32_t padEnable     = RTCIO_PAD_PDAC1_MUX_SEL | RTC_IO_PDAC1_XPD_DAC | RTC_IO_PDAC1_DAC_XPD_FORCE;
+  static constexpr uint32_t padValueMask  = RTC_IO_PDAC1_DAC_V << RTC_IO_PDAC1_DAC_S;
+  static constexpr uint32_t padValueShift = RTC_IO_PDAC1_DAC_S;
+  static constexpr uint32_t cwEnable      = SENS_DAC_CW_EN1_M;
+  static constexpr uint32_t scaleMask     = SENS_DAC_SCALE1_V << SENS_DAC_SCALE1_S;
+  static constexpr uint32_t scaleShift    = SENS_DAC_SCALE1_S;
+  static constexpr uint32_t invMask       = SENS_DAC_INV1_V << SENS_DAC_INV1_S;
+  static constexpr uint32_t invShift      = SENS_DAC_INV1_S;
+  static constexpr uint32_t dcMask        = SENS_DAC_DC1_V << SENS_DAC_DC1_S;
+  static constexpr uint32_t dcShift       = SENS_DAC_DC1_S;
+};
+
+template <> struct DacChannelRegs<DAC_CHANNEL_2>
+{
+  static constexpr dac_reg_t padReg       = DAC_REG_PAD_DAC2;
+  static constexpr uint32_t padEnable     = RTCIO_PAD_PDAC2_MUX_SEL | RTC_IO_PDAC2_XPD_DAC | RTC_IO_PDAC2_DAC_XPD_FORCE;
+  static constexpr uint32_t padValueMask  = RTC_IO_PDAC2_DAC_V << RTC_IO_PDAC2_DAC_S;
+  static constexpr uint32_t padValueShift = RTC_IO_PDAC2_DAC_S;
+  static constexpr uint32_t cwEnable      = SENS_DAC_CW_EN2_M;
+  static constexpr uint32_t scaleMask     = SENS_DAC_SCALE2_V << SENS_DAC_SCALE2_S;
+  static constexpr uint32_t scaleShift    = SENS_DAC_SCALE2_S;
+  static constexpr uint32_t invMask       = SENS_DAC_INV2_V << SENS_DAC_INV2_S;
+  static constexpr uint32_t invShift      = SENS_DAC_INV2_S;
+  static constexpr uint32_t dcMask        = SENS_DAC_DC2_V << SENS_DAC_DC2_S;
+  static constexpr uint32_t dcShift       = SENS_DAC_DC2_S;
+};
+
+// DacChannel class, all members are static & inline. The plain methods take
+// the shared register lock themselves. The ...Locked() variants expect the
+// caller to hold it (DAC_ENTER_CRITICAL() or DAC_ENTER_CRITICAL_ISR()), e.g.
+// to update both channels or several settings in one critical section.
+// The lock cannot be dropped altogether: SENS_SAR_DAC_CTRL1/2_REG are shared
+// by both channels and the CW generator, every change is a read-modify-write
+// which another core or an interrupt handler could interleave with, and the
+// shadow copies of DacEspRegs have to stay consistent with the registers.
+template <dac_channel_t CH>
+class DacChannel
+{
+  public:
+    typedef DacChannelRegs<CH> Regs;
+    static constexpr dac_channel_t channel = CH;
+
+    //
+    // Set DAC output value (0...255), deselects CW generator.
+    //
+    static inline void outputVoltage(uint8_t value)
+    {
+      DAC_ENTER_CRITICAL();
+      outputVoltageLocked(value);
+      DAC_EXIT_CRITICAL();
+    }
+
+    //
+    // Select CW generator as source & enable CW generator.
+    //
+    static inline void cwSelect(void)
+    {
+      DAC_ENTER_CRITICAL();
+      cwSelectLocked();
+      DAC_EXIT_CRITICAL();
+    }
+
+    //
+    // Deselect CW generator as source, disable CW generator if unused.
+    //
+    static inline void cwDeselect(void)
+    {
+      DAC_ENTER_CRITICAL();
+      cwDeselectLocked();
+      DAC_EXIT_CRITICAL();
+    }
+
+    static inline void setCwScale(dac_cw_scale_t scale)
+    {
+      DAC_ENTER_CRITICAL();
+      setCwScaleLocked(scale);
+      DAC_EXIT_CRITICAL();
+    }
+
+    static inline void setCwPhase(dac_cw_phase_t phase)
+    {
+      DAC_ENTER_CRITICAL();
+      setCwPhaseLocked(phase);
+      DAC_EXIT_CRITICAL();
+    }
+
+    static inline void setCwOffset(int8_t offset)
+    {
+      DAC_ENTER_CRITICAL();
+      setCwOffsetLocked(offset);
+      DAC_EXIT_CRITICAL();
+    }
+
+    //
+    // Following the variants for callers holding the shared register lock.
+    //
+    static inline __attribute__((always_inline)) void outputVoltageLocked(uint8_t value)
+    {
+      DacEspRegs::setField(DAC_REG_CTRL2, Regs::cwEnable, 0);
+      DacEspRegs::setField(Regs::padReg, Regs::padValueMask | Regs::padEnable,
+                           Regs::padEnable | ((uint32_t)value << Regs::padValueShift));
+    }
+
+    //
+    // Set DAC output value only, a single pad register store. The channel
+    // must already output DC (outputVoltage() called before).
+    //
+    static inline __attribute__((always_inline)) void setValueLocked(uint8_t value)
+    {
+      DacEspRegs::setField(Regs::padReg, Regs::padValueMask, (uint32_t)value << Regs::padValueShift);
+    }
+
+    static inline __attribute__((always_inline)) void cwSelectLocked(void)
+    {
+      DacEspRegs::setField(DAC_REG_CTRL2, Regs::cwEnable, Regs::cwEnable);
+      DacEspRegs::setField(DAC_REG_CTRL1, SENS_SW_TONE_EN, SENS_SW_TONE_EN);
+    }
+
+    static inline __attribute__((always_inline)) void cwDeselectLocked(void)
+    {
+      DacEspRegs::setField(DAC_REG_CTRL2, Regs::cwEnable, 0);
+      if (!(DacEspRegs::read(DAC_REG_CTRL2) & (SENS_DAC_CW_EN1_M | SENS_DAC_CW_EN2_M))) {
+        DacEspRegs::setField(DAC_REG_CTRL1, SENS_SW_TONE_EN, 0);
+      }
+    }
+
+    static inline __attribute__((always_inline)) void setCwScaleLocked(dac_cw_scale_t scale)
+    {
+      DacEspRegs::setField(DAC_REG_CTRL2, Regs::scaleMask, (uint32_t)scale << Regs::scaleShift);
+    }
+
+    static inline __attribute__((always_inline)) void setCwPhaseLocked(dac_cw_phase_t phase)
+    {
+      DacEspRegs::setField(DAC_REG_CTRL2, Regs::invMask, (uint32_t)phase << Regs::invShift);
+    }
+
+    static inline __attribute__((always_inline)) void setCwOffsetLocked(int8_t offset)
+    {
+      DacEspRegs::setField(DAC_REG_CTRL2, Regs::dcMask, (uint32_t)(uint8_t)offset << Regs::dcShift);
+    }
+};
+
+#endif
@@ -37,6 +37,11 @@
 */
 
 #include "DacESP32.h"
+#include "DacChannel.h"
+#include "DacEspRegs.h"
+#include "DacEspProfile.h"
+#include "DacEspArbiter.h"
+#include "DacEspCwSolver.h"
 
 // All CW generator frequency calculations are done with the assumption 
 // of RTC8M_CLK (clock source that feeds both DACs controller section) to run 
@@ -49,7 +54,7 @@
 // the digital controller clock (dig_clk_rtc_freq) of both the DAC and ADC 
 // modules might get changed (due to altered value of RTC_CNTL_CK8M_DIV_SEL). 
 // Comment line out if this causes problems or high frequency accuracy is not 
-// needed.
+// needed, or restrict the dividers used with class DacEspArbiter.
 #define CW_FREQUENCY_HIGH_ACCURACY
 
 // Below value defines the CW generators minimum number of voltage steps per cycle.
@@ -66,15 +71,46 @@
 // it (with only light or no load!). Then replace below value with the measured one.
 #define CHANNEL_VOLTAGE_MAX (float) 3.30
 
+// Above definitions only serve as defaults of the global runtime configuration,
+// see setGlobalConfig() & setConfig().
+#ifdef CW_FREQUENCY_HIGH_ACCURACY
+#define CONFIG_HIGH_ACCURACY true
+#define CONFIG_DIV_MAX       CK8M_DIV_MAX
+#else
+#define CONFIG_HIGH_ACCURACY false
+#define CONFIG_DIV_MAX       0
+#endif
+#ifdef CK8M_DFREQ_ADJUSTED
+#define CONFIG_CK8M_DFREQ    CK8M_DFREQ_ADJUSTED
+#else
+#define CONFIG_CK8M_DFREQ    -1
+#endif
+
 #define CHANNEL_CHECK                               \
   if (m_channel == DAC_CHANNEL_UNDEFINED) {         \
     log_e("channel setting invalid");               \
     return ESP_FAIL;                                \
   } 
 
+// calls compile-time specialized implementation for assigned channel
+#define CHANNEL_CALL(call)                          \
+  if (m_channel == DAC_CHANNEL_1) {                 \
+    DacChannel<DAC_CHANNEL_1>::call;                \
+  }                                                 \
+  else {                                            \
+    DacChannel<DAC_CHANNEL_2>::call;                \
+  }
+
 // initialize static members of class (shared by all created objects)
 size_t   DacESP32::m_objectCount = 0;     // clear object count
 uint32_t DacESP32::m_cwFrequency = 0;     // invalidate CW generator frequency
+portMUX_TYPE DacESP32::m_regLock = portMUX_INITIALIZER_UNLOCKED;
+// constant initialization, valid before constructors of global objects run
+DacESP32::dac_settings_t DacESP32::m_global = {
+  { CONFIG_HIGH_ACCURACY, SW_FSTEP_MAX, CONFIG_CK8M_DFREQ, CHANNEL_VOLTAGE_MAX, 0 },
+  { CK8M, CONFIG_DIV_MAX, SW_FSTEP_MAX, 0 },
+  255 / CHANNEL_VOLTAGE_MAX
+};
 
 //
 // Class constructor.
@@ -82,13 +118,17 @@ uint32_t DacESP32::m_cwFrequency = 0;     // invalidate CW generator frequency
 //
 DacESP32::DacESP32(dac_channel_t channel) 
 {
+  DAC_API(DAC_API_CONSTRUCTOR);
+
+  m_ownConfig = false;
+
   if (channel != DAC_CHANNEL_1 && channel != DAC_CHANNEL_2) {
     m_channel = DAC_CHANNEL_UNDEFINED;
     return;
   }
 
   m_channel = channel;
-  dac_output_disable(m_channel);
+  DacEspRegs::padDriverCall(dac_output_disable, m_channel);
 
   // default CW generator settings for this channel
   m_cwScale = DAC_CW_SCALE_1;
@@ -98,11 +138,13 @@ DacESP32::DacESP32(dac_channel_t channel)
   // frequency setting common to all objects
   if (m_cwFrequency == 0) {
     // CW generator not yet in use
-#ifdef CK8M_DFREQ_ADJUSTED
-    REG_SET_FIELD(RTC_CNTL_CLK_CONF_REG, RTC_CNTL_CK8M_DFREQ, CK8M_DFREQ_ADJUSTED);
-#endif
-    // set CK8M_DIV = 0 (default)
-    REG_SET_FIELD(RTC_CNTL_CLK_CONF_REG, RTC_CNTL_CK8M_DIV_SEL, 0);
+    applyCk8mDfreq(m_global.config.ck8mDfreq);
+    DAC_ENTER_CRITICAL();
+    // set CK8M_DIV = 0 (default) or the lowest one allowed by DacEspArbiter
+    DacEspRegs::setField(DAC_REG_CLK_CONF, RTC_CNTL_CK8M_DIV_SEL_M,
+                         (uint32_t)DacEspArbiter::getDividerMin() << RTC_CNTL_CK8M_DIV_SEL_S);
+    DAC_EXIT_CRITICAL();
+    DacEspArbiter::checkDivider();
   }
 
   // increase every time object is created
@@ -128,8 +170,10 @@ DacESP32::DacESP32(gpio_num_t pin)
 //
 DacESP32::~DacESP32()
 {
+  DAC_API(DAC_API_DESTRUCTOR);
+
   if (m_channel != DAC_CHANNEL_UNDEFINED) {
-    dac_output_disable(m_channel);
+    DacEspRegs::padDriverCall(dac_output_disable, m_channel);
   }
 
   // decrease counter when object is destroyed
@@ -137,7 +181,9 @@ DacESP32::~DacESP32()
 
   // disable CW generator if no objects left
   if (m_objectCount == 0) {
-    CLEAR_PERI_REG_MASK(SENS_SAR_DAC_CTRL1_REG, SENS_SW_TONE_EN);
+    DAC_ENTER_CRITICAL();
+    DacEspRegs::setField(DAC_REG_CTRL1, SENS_SW_TONE_EN, 0);
+    DAC_EXIT_CRITICAL();
   }
 }
 
@@ -147,6 +193,8 @@ DacESP32::~DacESP32()
 //
 esp_err_t DacESP32::getGPIOnum(gpio_num_t *gpio_num)
 {
+  DAC_API(DAC_API_GET_GPIO_NUM);
+
   CHANNEL_CHECK;
 
   return dac_pad_get_io_num(m_channel, gpio_num);
@@ -156,6 +204,21 @@ esp_err_t DacESP32::getGPIOnum(gpio_num_t *gpio_num)
 // (Re-)Assign DAC channel.
 //
 esp_err_t DacESP32::setChannel(dac_channel_t channel)
+{
+  DAC_API(DAC_API_SET_CHANNEL);
+
+  return assignChannel(channel);
+}
+
+esp_err_t DacESP32::setPin(gpio_num_t pin)
+{
+  DAC_API(DAC_API_SET_PIN);
+
+  return assignChannel((dac_channel_t)(pin == DAC_CHANNEL_1_GPIO_NUM) ? DAC_CHANNEL_1 : 
+                                      (pin == DAC_CHANNEL_2_GPIO_NUM) ? DAC_CHANNEL_2 : DAC_CHANNEL_UNDEFINED);
+}
+
+esp_err_t DacESP32::assignChannel(dac_channel_t channel)
 {
   if (channel != DAC_CHANNEL_1 && channel != DAC_CHANNEL_2) {
     log_e("parameter DAC channel/pin invalid");
@@ -164,29 +227,25 @@ esp_err_t DacESP32::setChannel(dac_channel_t channel)
 
   if (m_channel != channel) {
     if (m_channel != DAC_CHANNEL_UNDEFINED) {
-      dac_output_disable(m_channel);
+      DacEspRegs::padDriverCall(dac_output_disable, m_channel);
     }
-    dac_output_disable(channel);
+    DacEspRegs::padDriverCall(dac_output_disable, channel);
     m_channel = channel;
   }
 
   return ESP_OK;
 }
 
-esp_err_t DacESP32::setPin(gpio_num_t pin)
-{
-  return setChannel((dac_channel_t)(pin == DAC_CHANNEL_1_GPIO_NUM) ? DAC_CHANNEL_1 : 
-                                   (pin == DAC_CHANNEL_2_GPIO_NUM) ? DAC_CHANNEL_2 : DAC_CHANNEL_UNDEFINED);
-}
-
 //
 // Enable DAC output.
 //
 esp_err_t DacESP32::enable()
 {
+  DAC_API(DAC_API_ENABLE);
+
   CHANNEL_CHECK;
 
-  return dac_output_enable(m_channel);
+  return DacEspRegs::padDriverCall(dac_output_enable, m_channel);
 }
 
 //
@@ -194,24 +253,30 @@ esp_err_t DacESP32::enable()
 //
 esp_err_t DacESP32::disable()
 {
+  DAC_API(DAC_API_DISABLE);
+
   CHANNEL_CHECK;
 
-  return dac_output_disable(m_channel);
+  return DacEspRegs::padDriverCall(dac_output_disable, m_channel);
 }
 
 //
 // Set DAC output voltage. 
 // Parameter: value...DAC output voltage (in Volt)
-//                    Range 0...CHANNEL_VOLTAGE_MAX (see #definition above)
+//                    Range 0...channelVoltageMax (see DacEspConfig)
 //
 esp_err_t DacESP32::outputVoltage(float voltage)
 {
+  DAC_API(DAC_API_OUTPUT_VOLTAGE_FLOAT);
+
+  const dac_settings_t &s = settings();
+
   if (voltage < 0 )
     voltage = 0;
-  else if (voltage > CHANNEL_VOLTAGE_MAX)
-    voltage = CHANNEL_VOLTAGE_MAX;
+  else if (voltage > s.config.channelVoltageMax)
+    voltage = s.config.channelVoltageMax;
 
-  return outputVoltage((uint8_t)((voltage / CHANNEL_VOLTAGE_MAX) * 255));
+  return applyVoltage((uint8_t)(voltage * s.voltageScale));
 }
 
 //
@@ -221,29 +286,99 @@ esp_err_t DacESP32::outputVoltage(float voltage)
 //                    Range 0...255
 //
 esp_err_t DacESP32::outputVoltage(uint8_t value)
+{
+  DAC_API(DAC_API_OUTPUT_VOLTAGE);
+
+  return applyVoltage(value);
+}
+
+esp_err_t DacESP32::applyVoltage(uint8_t value)
 {
   CHANNEL_CHECK;
 
-  if (m_channel == DAC_CHANNEL_1) {
-    // disable CW generator on channel 1
-    CLEAR_PERI_REG_MASK(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_CW_EN1_M);
-    // enable DAC channel output
-    SET_PERI_REG_MASK(RTC_IO_PAD_DAC1_REG, RTCIO_PAD_PDAC1_MUX_SEL | RTC_IO_PDAC1_XPD_DAC | RTC_IO_PDAC1_DAC_XPD_FORCE);
-    // setting DAC output value
-    SET_PERI_REG_BITS(RTC_IO_PAD_DAC1_REG, RTC_IO_PDAC1_DAC, value, RTC_IO_PDAC1_DAC_S);
+  // disable CW generator on channel, enable DAC channel output & set value
+  CHANNEL_CALL(outputVoltage(value));
+
+  return ESP_OK;
+}
+
+//
+// Set configuration used by this object only (instead of the global one).
+// Parameter: config...see DacEspConfig, a ck8mDfreq >= 0 gets applied at once
+//
+esp_err_t DacESP32::setConfig(const DacEspConfig &config)
+{
+  DAC_API(DAC_API_SET_CONFIG);
+
+  esp_err_t result;
+
+  if ((result = deriveSettings(config, &m_settings)) != ESP_OK) {
+    return result;
   }
-  else {
-    // disable CW generator on channel 2
-    CLEAR_PERI_REG_MASK(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_CW_EN2_M);
-    // enable DAC channel output
-    SET_PERI_REG_MASK(RTC_IO_PAD_DAC2_REG, RTCIO_PAD_PDAC2_MUX_SEL | RTC_IO_PDAC2_XPD_DAC | RTC_IO_PDAC2_DAC_XPD_FORCE);
-    // setting DAC output value
-    SET_PERI_REG_BITS(RTC_IO_PAD_DAC2_REG, RTC_IO_PDAC2_DAC, value, RTC_IO_PDAC2_DAC_S);
+  m_ownConfig = true;
+  applyCk8mDfreq(config.ck8mDfreq);
+
+  return ESP_OK;
+}
+
+//
+// Set configuration used by all objects without own configuration. Static
+// functions (e.g. solveCwFrequency()) & classes like DacEspIsr use it too.
+// Parameter: config...see DacEspConfig, a ck8mDfreq >= 0 gets applied at once
+//
+esp_err_t DacESP32::setGlobalConfig(const DacEspConfig &config)
+{
+  DAC_API(DAC_API_SET_GLOBAL_CONFIG);
+
+  dac_settings_t settings;
+  esp_err_t result;
+
+  if ((result = deriveSettings(config, &settings)) != ESP_OK) {
+    return result;
+  }
+  // m_global may be read inside ISRs
+  DAC_ENTER_CRITICAL();
+  m_global = settings;
+  DAC_EXIT_CRITICAL();
+  applyCk8mDfreq(config.ck8mDfreq);
+
+  return ESP_OK;
+}
+
+//
+// Check configuration & precalculate the constants derived from it.
+//
+esp_err_t DacESP32::deriveSettings(const DacEspConfig &config, dac_settings_t *settings)
+{
+  if (config.fstepMax == 0 || config.ck8mDfreq < -1 || config.ck8mDfreq > (int16_t)RTC_CNTL_CK8M_DFREQ_V ||
+      !(config.channelVoltageMax > 0)) {
+    log_e("invalid configuration");
+    return ESP_ERR_INVALID_ARG;
   }
 
+  settings->config = config;
+  settings->solver.ck8m = config.ck8mFrequency ? config.ck8mFrequency : CK8M;
+  settings->solver.divMax = config.cwHighAccuracy ? CK8M_DIV_MAX : 0;
+  settings->solver.fstepMax = config.fstepMax;
+  settings->solver.divAllowed = 0;      // DacEspArbiter constraints get applied when solving
+  settings->voltageScale = 255 / config.channelVoltageMax;
+
   return ESP_OK;
 }
 
+//
+// Tune RTC8M_CLK (RTC_CNTL_CK8M_DFREQ), nothing done for values < 0.
+//
+void DacESP32::applyCk8mDfreq(int16_t dfreq)
+{
+  if (dfreq < 0) {
+    return;
+  }
+  DAC_ENTER_CRITICAL();
+  DacEspRegs::setField(DAC_REG_CLK_CONF, RTC_CNTL_CK8M_DFREQ_M, (uint32_t)dfreq << RTC_CNTL_CK8M_DFREQ_S);
+  DAC_EXIT_CRITICAL();
+}
+
 //
 // Following the routines for using the Cosine Waveform (CW) Generator.
 // Readme.md provides more technical details about the CW generator. 
@@ -257,20 +392,22 @@ esp_err_t DacESP32::outputCW(uint32_t frequency)
 
 esp_err_t DacESP32::outputCW(uint32_t frequency, dac_cw_scale_t scale, dac_cw_phase_t phase, int8_t offset)
 {
+  DAC_API(DAC_API_OUTPUT_CW);
+
   CHANNEL_CHECK;
 
   esp_err_t result;
   
-  // configure CW settings
-  if ((result = setCwFrequency(frequency)) != ESP_OK ||
-      (result = setCwScale(scale)) != ESP_OK ||
-      (result = setCwPhase(phase)) != ESP_OK ||
-      (result = setCwOffset(offset)) != ESP_OK) {
+  // configure CW settings (not tagged again, the writes belong to outputCW)
+  if ((result = applyCwFrequency(frequency)) != ESP_OK ||
+      (result = applyCwScale(scale)) != ESP_OK ||
+      (result = applyCwPhase(phase)) != ESP_OK ||
+      (result = applyCwOffset(offset)) != ESP_OK) {
 
     return result;
   }
 
-  dac_output_enable(m_channel);
+  DacEspRegs::padDriverCall(dac_output_enable, m_channel);
   dacCwSelect();
 
   return ESP_OK;
@@ -278,81 +415,236 @@ esp_err_t DacESP32::outputCW(uint32_t frequency, dac_cw_scale_t scale, dac_cw_ph
 
 //
 // Sets CW frequency with lower accuracy (constant frequency steps ~122Hz) or higher accuracy 
-// (frequency steps from ~15Hz up to ~122Hz) when CW_FREQUENCY_HIGH_ACCURACY is defined, 
+// (frequency steps from ~15Hz up to ~122Hz) when cwHighAccuracy is set in the configuration, 
 // in this case CK8M_DIV_SEL gets changed. The highest frequency possible and the min. number 
-// of voltage steps per cycle depend on definition of SW_FSTEP_MAX.
+// of voltage steps per cycle depend on configuration value fstepMax (SW_FSTEP_MAX).
 // Parameter: frequency - possible range is ~15...fmax
-//             fmax: ~62.6kHz (SW_FSTEP_MAX = 512 --> voltage steps/cycle >= 128)
-//             fmax: ~31.3kHz (SW_FSTEP_MAX = 256 --> voltage steps/cycle >= 256)
-//             fmax: ~15.6kHz (SW_FSTEP_MAX = 128 --> voltage steps/cycle >= 512)
+//             fmax: ~62.6kHz (fstepMax = 512 --> voltage steps/cycle >= 128)
+//             fmax: ~31.3kHz (fstepMax = 256 --> voltage steps/cycle >= 256)
+//             fmax: ~15.6kHz (fstepMax = 128 --> voltage steps/cycle >= 512)
 //
 esp_err_t DacESP32::setCwFrequency(uint32_t frequency)
 {
-  if (frequency == 0) {
+  DAC_API(DAC_API_SET_CW_FREQUENCY);
+
+  return applyCwFrequency(frequency);
+}
+
+esp_err_t DacESP32::applyCwFrequency(uint32_t frequency)
+{
+  dac_cw_setting_t setting;
+  esp_err_t result;
+
+  if ((result = solve(settings(), frequency, &setting)) != ESP_OK) {
+    return result;
+  }
+  applyCwSetting(setting);
+
+  return ESP_OK;
+}
+
+//
+// Sets CW frequency using the spectral purity aware solver (see solveCwFrequency()).
+// Parameter: opts - weighting of frequency error against spurious content
+//
+esp_err_t DacESP32::setCwFrequency(uint32_t frequency, const dac_cw_solver_opts_t &opts)
+{
+  DAC_API(DAC_API_SET_CW_FREQUENCY_OPTS);
+
+  dac_cw_setting_t setting;
+  esp_err_t result;
+
+  if ((result = solve(settings(), frequency, &setting, opts)) != ESP_OK) {
+    return result;
+  }
+  applyCwSetting(setting);
+
+  return ESP_OK;
+}
+
+//
+// Write CW generator settings found by solveCwFrequency() into the registers.
+//
+void DacESP32::applyCwSetting(const dac_cw_setting_t &setting)
+{
+  DAC_ENTER_CRITICAL();
+  if (settings().config.cwHighAccuracy) {
+    DacEspRegs::setField(DAC_REG_CLK_CONF, RTC_CNTL_CK8M_DIV_SEL_M, (uint32_t)setting.clk8mDiv << RTC_CNTL_CK8M_DIV_SEL_S);
+  }
+  DacEspRegs::setField(DAC_REG_CTRL1, SENS_SW_FSTEP_M, (uint32_t)setting.frequencyStep << SENS_SW_FSTEP_S);
+  DAC_EXIT_CRITICAL();
+
+  m_cwFrequency = setting.frequency;
+  DacEspArbiter::checkDivider();
+}
+
+//
+// Searches the CW generator settings (CK8M_DIV_SEL & SW_FSTEP) resulting in an
+// output frequency closest to the target frequency. No register gets changed,
+// hence the result can be applied later (see setCwFrequency() for details).
+// Parameter: frequency - target frequency
+//            setting - address of variable to hold the settings found
+// The global configuration is used.
+//
+esp_err_t DacESP32::solveCwFrequency(uint32_t frequency, dac_cw_setting_t *setting)
+{
+  DAC_API(DAC_API_SOLVE_CW_FREQUENCY);
+
+  return solve(m_global, frequency, setting);
+}
+
+esp_err_t DacESP32::solveCwFrequency(uint32_t frequency, dac_cw_setting_t *setting, const dac_cw_solver_opts_t &opts)
+{
+  DAC_API(DAC_API_SOLVE_CW_FREQUENCY_OPTS);
+
+  return solve(m_global, frequency, setting, opts);
+}
+
+esp_err_t DacESP32::solve(const dac_settings_t &settings, uint32_t frequency, dac_cw_setting_t *setting)
+{
+  dac_cw_solver_params_t params = settings.solver;
+  dac_cw_solution_t solution;
+
+  // only dividers allowed by all constraints (see DacEspArbiter)
+  params.divAllowed = DacEspArbiter::getAllowed();
+  if (!DacEspCwSolver::solve(frequency, params, &solution)) {
+    // no suitable combination found
+    log_e("invalid parameter: frequency (%d) out of range", frequency);
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  log_d("ftarget=%d, fcw=%d, abs(delta)=%d, clk8mDiv=%d, frequencyStep=%d, stepSize=%f", 
+        frequency, solution.fcw, solution.deltaAbs, solution.clk8mDiv, solution.frequencyStep, solution.stepSize);
+
+  setting->frequency = frequency;
+  setting->clk8mDiv = solution.clk8mDiv;
+  setting->frequencyStep = solution.frequencyStep;
+
+  return ESP_OK;
+}
+
+//
+// Same as above but candidates get scored on frequency error plus estimated
+// spurious content. For every usable CK8M_DIV_SEL the two SW_FSTEP values
+// next to the target are checked, the one with the lowest cost
+//   abs(fcw - ftarget) + opts.purityWeight * estimateCwSpurLevel(fstep)
+// wins. A higher CK8M_DIV_SEL gives finer frequency steps but needs a
+// higher SW_FSTEP (fewer voltage steps per cycle) for the same frequency.
+// With opts.purityWeight = 0 & opts.fstepMax = 0 the result equals the one above.
+// Parameter: opts.purityWeight...Hz frequency error traded for 1dB lower spur level
+//            opts.fstepMax...highest SW_FSTEP allowed (0 = fstepMax of configuration)
+//
+esp_err_t DacESP32::solve(const dac_settings_t &settings, uint32_t frequency, dac_cw_setting_t *setting,
+                          const dac_cw_solver_opts_t &opts)
+{
+  if (opts.purityWeight == 0 && opts.fstepMax == 0) {
+    return solve(settings, frequency, setting);
+  }
+
+  if (frequency == 0 || opts.purityWeight < 0) {
     log_e("invalid parameter: frequency (%d) out of range", frequency);
     return ESP_ERR_INVALID_ARG;
   }
 
-  uint8_t  clk8mDiv = 0, div, divMax = 0;
-  uint32_t frequencyStep = 0, fcw = 0, deltaAbs;
-  float    stepSize, stepSizeTemp;
+  uint32_t fstepMax = opts.fstepMax ? opts.fstepMax : settings.solver.fstepMax;
+  uint8_t  divMax = settings.solver.divMax;
+  uint8_t  clk8mDiv = 0;
+  uint16_t frequencyStep = 0;
+  float    costMin = 0;
 
-#ifdef CW_FREQUENCY_HIGH_ACCURACY
-  divMax = CK8M_DIV_MAX;
-#endif
+  for (uint8_t div = 0; div <= divMax; div++) {
+    if (!DacEspArbiter::isAllowed(div)) {
+      continue;
+    }
+    // step size ck8m / denom, fixed point
+    uint64_t denom = (uint64_t)(1 + div) << 16;
+    uint32_t fstepLow = (uint32_t)(frequency * denom / settings.solver.ck8m);
 
-  // delta to start with (biggest possible stepsize + 1)
-  deltaAbs = ((float)CK8M / 65536UL) + 1;
- 
-  // searching output frequency closest to target frequency
-  for (div = 0; div <= divMax; ) {
-    stepSizeTemp = (((float)CK8M / (1 + div)) / 65536UL);
-    for (uint16_t fstep = 1; fstep <= SW_FSTEP_MAX; fstep++) {
-      fcw = (uint32_t)(stepSizeTemp * fstep);
-      if (fcw > (frequency + deltaAbs)) {
-        // target gets out of reach (fcw >> ftarget)
-        break;
+    for (uint32_t fstep = fstepLow; fstep <= fstepLow + 1; fstep++) {
+      if (fstep == 0 || fstep > fstepMax) {
+        continue;
+      }
+      uint32_t fcw = DacEspCwSolver::outputFrequency(settings.solver.ck8m, div, fstep);
+      uint32_t deltaAbs = (uint32_t)abs((int)(fcw - frequency));
+      if (deltaAbs * denom > settings.solver.ck8m) {
+        // target out of reach with this divider
+        continue;
       }
-      // calculate deviation from target frequency
-      int dtemp = (int)(fcw - frequency);
-      log_v("fcw = %d, deltaAbs = %d, dtemp = %d, div = %d, stepSize = %f", fcw, deltaAbs, dtemp, div, stepSizeTemp);
-      if ((uint32_t)abs(dtemp) < deltaAbs) {
-        // better combination found
-        deltaAbs = (uint32_t)abs(dtemp);
+      float cost = deltaAbs + opts.purityWeight * estimateCwSpurLevel(fstep);
+      log_v("fcw = %d, deltaAbs = %d, div = %d, fstep = %d, cost = %f", fcw, deltaAbs, div, fstep, cost);
+      if (frequencyStep == 0 || cost < costMin) {
+        costMin = cost;
         clk8mDiv = div;
         frequencyStep = fstep;
-        stepSize = stepSizeTemp;
       }
-      if (deltaAbs == 0) goto end;
-    }
-
-    div++;
-    if ((int32_t)((((float)CK8M / (1 + div)) / 65536UL) * SW_FSTEP_MAX) < ((int32_t)(frequency - deltaAbs))) {
-      // target gets out of reach (fcw << ftarget)
-      break;
     }
   }
-end:
 
-  if (clk8mDiv == 0 && frequencyStep == 0) {
+  if (frequencyStep == 0) {
     // no suitable combination found
     log_e("invalid parameter: frequency (%d) out of range", frequency);
     return ESP_ERR_INVALID_ARG;
   }
 
-  log_d("ftarget=%d, fcw=%d, abs(delta)=%d, clk8mDiv=%d, frequencyStep=%d, stepSize=%f", 
-        frequency, (uint32_t)(stepSize * frequencyStep), deltaAbs, clk8mDiv, frequencyStep, stepSize);
-
-#ifdef CW_FREQUENCY_HIGH_ACCURACY
-  REG_SET_FIELD(RTC_CNTL_CLK_CONF_REG, RTC_CNTL_CK8M_DIV_SEL, clk8mDiv);
-#endif
-  SET_PERI_REG_BITS(SENS_SAR_DAC_CTRL1_REG, SENS_SW_FSTEP, frequencyStep, SENS_SW_FSTEP_S);
+  log_d("ftarget=%d, clk8mDiv=%d, frequencyStep=%d, cost=%f", frequency, clk8mDiv, frequencyStep, costMin);
 
-  m_cwFrequency = frequency;
+  setting->frequency = frequency;
+  setting->clk8mDiv = clk8mDiv;
+  setting->frequencyStep = frequencyStep;
 
   return ESP_OK;
 }
 
+//
+// Estimate level of the strongest spurious component of the CW output (dBc)
+// from the number of voltage steps per cycle (65536 / SW_FSTEP). Each step
+// is held for one generator clock, the resulting images appear roughly at
+// -20*log10(steps per cycle). Independent of CK8M_DIV_SEL.
+//
+float DacESP32::estimateCwSpurLevel(uint16_t frequencyStep)
+{
+  if (frequencyStep == 0) {
+    return 0;
+  }
+  return 20 * log10f((float)frequencyStep / 65536UL);
+}
+
+//
+// Get CW generator output frequency really achieved with the current register
+// settings (Hz, truncated). Calculated with the RTC8M_CLK frequency of the
+// configuration (ck8mFrequency, e.g. measured with DacEspClock).
+//
+uint32_t DacESP32::getCwFrequencyActual()
+{
+  DAC_API(DAC_API_GET_CW_FREQUENCY_ACTUAL);
+
+  DAC_ENTER_CRITICAL();
+  uint8_t clk8mDiv = (DacEspRegs::read(DAC_REG_CLK_CONF) & RTC_CNTL_CK8M_DIV_SEL_M) >> RTC_CNTL_CK8M_DIV_SEL_S;
+  uint16_t frequencyStep = (DacEspRegs::read(DAC_REG_CTRL1) & SENS_SW_FSTEP_M) >> SENS_SW_FSTEP_S;
+  DAC_EXIT_CRITICAL();
+
+  return DacEspCwSolver::outputFrequency(settings().solver.ck8m, clk8mDiv, frequencyStep);
+}
+
+//
+// Get the state of both DAC channels & the CW generator as the hardware has it,
+// decoded from one read of all DAC related registers (see DacEspState).
+// Parameter: state...receives the decoded state
+//            regs...if not NULL receives the raw register values
+//
+void DacESP32::getState(dac_state_t *state, dac_reg_dump_t *regs)
+{
+  DAC_API(DAC_API_GET_STATE);
+
+  dac_reg_dump_t dump;
+
+  DacEspRegs::capture(&dump);
+  DacEspState::decode(dump, m_global.solver.ck8m, state);
+  if (regs != NULL) {
+    *regs = dump;
+  }
+}
+
 //
 // Set the amplitude of the cosine wave (CW) generator output.
 // Parameter: scale - scaling factor
@@ -362,6 +654,13 @@ end:
 //             3...scale to 1/8
 //
 esp_err_t DacESP32::setCwScale(dac_cw_scale_t scale)
+{
+  DAC_API(DAC_API_SET_CW_SCALE);
+
+  return applyCwScale(scale);
+}
+
+esp_err_t DacESP32::applyCwScale(dac_cw_scale_t scale)
 {
   CHANNEL_CHECK;
 
@@ -370,12 +669,7 @@ esp_err_t DacESP32::setCwScale(dac_cw_scale_t scale)
     return ESP_ERR_INVALID_ARG;
   }
 
-  if (m_channel == DAC_CHANNEL_1) {
-    SET_PERI_REG_BITS(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_SCALE1, scale, SENS_DAC_SCALE1_S);
-  }
-  else {
-    SET_PERI_REG_BITS(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_SCALE2, scale, SENS_DAC_SCALE2_S);
-  }
+  CHANNEL_CALL(setCwScale(scale));
   m_cwScale = scale;
 
   return ESP_OK;
@@ -388,15 +682,19 @@ esp_err_t DacESP32::setCwScale(dac_cw_scale_t scale)
 //       Unclipped output signal with max. amplitude requires offset = 0 !
 //
 esp_err_t DacESP32::setCwOffset(int8_t offset)
+{
+  DAC_API(DAC_API_SET_CW_OFFSET);
+
+  return applyCwOffset(offset);
+}
+
+esp_err_t DacESP32::applyCwOffset(int8_t offset)
 {
   CHANNEL_CHECK;
 
-  if (m_channel == DAC_CHANNEL_1) {
-    SET_PERI_REG_BITS(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_DC1, offset, SENS_DAC_DC1_S);
-  }
-  else {
-    SET_PERI_REG_BITS(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_DC2, offset, SENS_DAC_DC2_S);
-  }
+  CHANNEL_CALL(setCwOffset(offset));
+  m_cwOffset = offset;
+
   return ESP_OK;
 }
 
@@ -405,6 +703,13 @@ esp_err_t DacESP32::setCwOffset(int8_t offset)
 // Parameter: phase - selected phase (0°/180°)
 //
 esp_err_t DacESP32::setCwPhase(dac_cw_phase_t phase)
+{
+  DAC_API(DAC_API_SET_CW_PHASE);
+
+  return applyCwPhase(phase);
+}
+
+esp_err_t DacESP32::applyCwPhase(dac_cw_phase_t phase)
 {
   CHANNEL_CHECK;
 
@@ -412,12 +717,7 @@ esp_err_t DacESP32::setCwPhase(dac_cw_phase_t phase)
     return ESP_ERR_INVALID_ARG;
   }
 
-  if (m_channel == DAC_CHANNEL_1) {
-    SET_PERI_REG_BITS(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_INV1, phase, SENS_DAC_INV1_S);
-  }
-  else {
-    SET_PERI_REG_BITS(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_INV2, phase, SENS_DAC_INV2_S);
-  }
+  CHANNEL_CALL(setCwPhase(phase));
   m_cwPhase = phase;
 
   return ESP_OK;
@@ -431,15 +731,8 @@ esp_err_t DacESP32::dacCwSelect()
 {
   //CHANNEL_CHECK;
 
-  if (m_channel == DAC_CHANNEL_1) {
-    SET_PERI_REG_MASK(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_CW_EN1_M);
-  }
-  else {
-    SET_PERI_REG_MASK(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_CW_EN2_M);
-  }
-
-  // enable CW generator
-  SET_PERI_REG_MASK(SENS_SAR_DAC_CTRL1_REG, SENS_SW_TONE_EN);
+  // select CW generator for channel & enable it
+  CHANNEL_CALL(cwSelect());
 
   return ESP_OK;
 }
@@ -451,18 +744,8 @@ esp_err_t DacESP32::dacCwDeselect()
 {
   //CHANNEL_CHECK;
 
-  if (m_channel == DAC_CHANNEL_1) {
-    CLEAR_PERI_REG_MASK(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_CW_EN1_M);
-  }
-  else {
-    CLEAR_PERI_REG_MASK(SENS_SAR_DAC_CTRL2_REG, SENS_DAC_CW_EN2_M);
-  }
-
-  if (!((READ_PERI_REG(SENS_SAR_DAC_CTRL2_REG) >> SENS_DAC_CW_EN1_S) & 1UL) &&
-      !((READ_PERI_REG(SENS_SAR_DAC_CTRL2_REG) >> SENS_DAC_CW_EN2_S) & 1UL)) {
-    // disable unused CW generator
-    CLEAR_PERI_REG_MASK(SENS_SAR_DAC_CTRL1_REG, SENS_SW_TONE_EN);
-  }
+  // deselect CW generator for channel, disable it if unused
+  CHANNEL_CALL(cwDeselect());
 
   return ESP_OK;
 }
@@ -479,52 +762,20 @@ void DacESP32::printObjectVariables()
 }
 
 //
-// Print selected register settings affecting the DAC system (only useful for debugging purposes)
+// Print all register settings affecting the DAC system, raw & decoded (only useful for debugging purposes)
 //
 void DacESP32::printDacRegisterSettings()
 {
-  uint32_t clk   = REG_READ(RTC_CNTL_CLK_CONF_REG),
-           dac1  = READ_PERI_REG(RTCIO_PAD_DAC1_REG),
-           dac2  = READ_PERI_REG(RTCIO_PAD_DAC2_REG),
-           ctrl1 = READ_PERI_REG(SENS_SAR_DAC_CTRL1_REG),
-           ctrl2 = READ_PERI_REG(SENS_SAR_DAC_CTRL2_REG);
-
-  Serial.printf("\nRegister: RTC_CNTL_CLK_CONF_REG=0x%08x\n", clk);
-                 // RTC_CNTL_CK8M_DFREQ: value controls tuning of 8M clock
-                 // RTC_CNTL_CK8M_DIV_SEL: configures 8M clock division
-  Serial.printf("  RTC_CNTL_FAST_CLK_RTC_SEL=%d, RTC_CNTL_CK8M_DFREQ=%d, RTC_CNTL_CK8M_DIV_SEL=%d\n", 
-                (clk >> RTC_CNTL_FAST_CLK_RTC_SEL_S) & RTC_CNTL_FAST_CLK_RTC_SEL_V, (clk >> RTC_CNTL_CK8M_DFREQ_S) & RTC_CNTL_CK8M_DFREQ_V,
-                (clk >> RTC_CNTL_CK8M_DIV_SEL_S) & RTC_CNTL_CK8M_DIV_SEL_V);
-  Serial.printf("Register: RTCIO_PAD_DAC1_REG=0x%08x\n", dac1);
-  Serial.printf("  RTCIO_PAD_PDAC1_RDE=%d,     RTCIO_PAD_PDAC1_RUE=%d\n", 
-                (dac1 >> RTCIO_PAD_PDAC_RDE_S) & RTCIO_PAD_PDAC_RDE_V, (dac1 >> RTCIO_PAD_PDAC_RUE_S) & RTCIO_PAD_PDAC_RUE_V);
-  Serial.printf("  RTCIO_PAD_PDAC1_DRV=%d,     RTCIO_PAD_PDAC1_DAC=0x%02x (%d),  RTCIO_PAD_PDAC1_XPD_DAC=%d\n", 
-                (dac1 >> RTCIO_PAD_PDAC_DRV_S) & RTCIO_PAD_PDAC_DRV_V, 
-                (dac1 >> RTCIO_PAD_PDAC_DAC_S) & RTCIO_PAD_PDAC_DAC_V, (dac1 >> RTCIO_PAD_PDAC_DAC_S) & RTCIO_PAD_PDAC_DAC_V,
-                (dac1 >> RTCIO_PAD_PDAC_XPD_DAC_S) & RTCIO_PAD_PDAC_XPD_DAC_V);
-  Serial.printf("  RTCIO_PAD_PDAC1_MUX_SEL=%d, RTCIO_PAD_PDAC1_DAC_XPD_FORCE=%d\n", 
-                (dac1 >> RTCIO_PAD_PDAC_MUX_SEL_S) & RTCIO_PAD_PDAC_MUX_SEL_V, (dac1 >> RTCIO_PAD_PDAC_DAC_XPD_FORCE_S) & RTCIO_PAD_PDAC_DAC_XPD_FORCE_V);
-  Serial.printf("Register: RTCIO_PAD_DAC2_REG=0x%08x\n", dac2);
-  Serial.printf("  RTCIO_PAD_PDAC2_RDE=%d,     RTCIO_PAD_PDAC2_RUE=%d\n", 
-                (dac2 >> RTCIO_PAD_PDAC_RDE_S) & RTCIO_PAD_PDAC_RDE_V, (dac2 >> RTCIO_PAD_PDAC_RUE_S) & RTCIO_PAD_PDAC_RUE_V);
-  Serial.printf("  RTCIO_PAD_PDAC2_DRV=%d,     RTCIO_PAD_PDAC2_DAC=0x%02x (%d),  RTCIO_PAD_PDAC2_XPD_DAC=%d\n", 
-                (dac2 >> RTCIO_PAD_PDAC_DRV_S) & RTCIO_PAD_PDAC_DRV_V, 
-                (dac2 >> RTCIO_PAD_PDAC_DAC_S) & RTCIO_PAD_PDAC_DAC_V, (dac2 >> RTCIO_PAD_PDAC_DAC_S) & RTCIO_PAD_PDAC_DAC_V,
-                (dac2 >> RTCIO_PAD_PDAC_XPD_DAC_S) & RTCIO_PAD_PDAC_XPD_DAC_V);
-  Serial.printf("  RTCIO_PAD_PDAC2_MUX_SEL=%d, RTCIO_PAD_PDAC2_DAC_XPD_FORCE=%d\n", 
-                (dac2 >> RTCIO_PAD_PDAC_MUX_SEL_S) & RTCIO_PAD_PDAC_MUX_SEL_V, (dac2 >> RTCIO_PAD_PDAC_DAC_XPD_FORCE_S) & RTCIO_PAD_PDAC_DAC_XPD_FORCE_V);
-  Serial.printf("Register: SENS_SAR_DAC_CTRL1_REG=0x%08x\n", ctrl1);
-  Serial.printf("  SENS_SW_TONE_EN=%d,   SENS_SW_FSTEP=%d\n", 
-                (ctrl1 >> SENS_SW_TONE_EN_S) & SENS_SW_TONE_EN_V, (ctrl1 >> SENS_SW_FSTEP_S) & SENS_SW_FSTEP_V);
-  Serial.printf("Register: SENS_SAR_DAC_CTRL2_REG=0x%08x\n", ctrl2);
-  Serial.printf("  SENS_DAC_CW_EN1=%d,   SENS_DAC_CW_EN2=%d\n", 
-                (ctrl2 >> SENS_DAC_CW_EN1_S) & SENS_DAC_CW_EN1_V, (ctrl2 >> SENS_DAC_CW_EN2_S) & SENS_DAC_CW_EN2_V);
-  Serial.printf("  SENS_DAC_INV1=%d,     SENS_DAC_INV2=%d\n", 
-                (ctrl2 >> SENS_DAC_INV1_S) & SENS_DAC_INV1_V, (ctrl2 >> SENS_DAC_INV2_S) & SENS_DAC_INV2_V);
-  Serial.printf("  SENS_DAC_SCALE1=%d,   SENS_DAC_SCALE2=%d\n", 
-                (ctrl2 >> SENS_DAC_SCALE1_S) & SENS_DAC_SCALE1_V, (ctrl2 >> SENS_DAC_SCALE2_S) & SENS_DAC_SCALE2_V);
-  Serial.printf("  SENS_DAC_DC1=0x%04x, SENS_DAC_DC2=0x%04x\n", 
-                (ctrl2 >> SENS_DAC_DC1_S) & SENS_DAC_DC1_V, (ctrl2 >> SENS_DAC_DC2_S) & SENS_DAC_DC2_V);
+  dac_state_t state;
+  dac_reg_dump_t regs;
+  char text[640];
+
+  getState(&state, &regs);
+  // raw values first, the line can be decoded on a host (extras/regDecode)
+  DacEspState::formatDump(regs, text, sizeof(text));
+  Serial.print(text);
+  DacEspState::format(state, text, sizeof(text));
+  Serial.print(text);
 }
 #endif
 
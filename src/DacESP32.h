@@ -46,6 +46,9 @@
 #include "soc/dac_channel.h"
 #include "soc/rtc.h"
 #include "driver/dac.h"
+#include "DacEspHal.h"
+#include "DacEspCwSolver.h"
+#include "DacEspState.h"
 
 //
 // definitions
@@ -73,6 +76,14 @@
 #define DAC_CW_OFFSET_DEFAULT 0
 #define CK8M_DIV_MAX 7
 
+// Guard read-modify-write access to registers shared by both DAC channels
+// (SENS_SAR_DAC_CTRL1_REG, SENS_SAR_DAC_CTRL2_REG, RTC_CNTL_CLK_CONF_REG).
+// Safe across both cores. Use the _ISR variants inside interrupt handlers.
+#define DAC_ENTER_CRITICAL()     portENTER_CRITICAL(&DacESP32::m_regLock)
+#define DAC_EXIT_CRITICAL()      portEXIT_CRITICAL(&DacESP32::m_regLock)
+#define DAC_ENTER_CRITICAL_ISR() portENTER_CRITICAL_ISR(&DacESP32::m_regLock)
+#define DAC_EXIT_CRITICAL_ISR()  portEXIT_CRITICAL_ISR(&DacESP32::m_regLock)
+
 // Master clock for digital controller section of both DAC & ADC systems.
 // According to spec approximately 8MHz.
 #define CK8M 8000000UL
@@ -101,6 +112,32 @@ typedef enum {
   DAC_CW_INVERT_NOT_MSB = 0x3
 } dac_cw_invert_t;
 
+// CW generator settings for a given output frequency
+typedef struct {
+  uint32_t frequency;       // target frequency
+  uint8_t  clk8mDiv;        // RTC_CNTL_CK8M_DIV_SEL
+  uint16_t frequencyStep;   // SENS_SW_FSTEP
+} dac_cw_setting_t;
+
+// Options for the spectral purity aware CW frequency solver. Each generator
+// clock gives one voltage step, fewer steps per cycle (higher SW_FSTEP) mean
+// stronger spurious content. The solver minimizes:
+//   abs(fcw - ftarget) + purityWeight * estimated spur level (dBc)
+typedef struct {
+  float    purityWeight;    // Hz frequency error accepted per dB lower spur level (0 = closest frequency only)
+  uint16_t fstepMax;        // highest SW_FSTEP allowed (0 = SW_FSTEP_MAX)
+} dac_cw_solver_opts_t;
+
+// Runtime configuration, either global (all objects) or per object. Defaults
+// are given by the definitions in DacESP32.cpp, see getGlobalConfig().
+typedef struct {
+  bool     cwHighAccuracy;    // CK8M_DIV_SEL may be changed (CW_FREQUENCY_HIGH_ACCURACY)
+  uint16_t fstepMax;          // highest SW_FSTEP, voltage steps/cycle >= 65536/fstepMax (SW_FSTEP_MAX)
+  int16_t  ck8mDfreq;         // RTC8M_CLK tuning 0...255, -1 = leave untouched (CK8M_DFREQ_ADJUSTED)
+  float    channelVoltageMax; // DAC output voltage at value 255 (CHANNEL_VOLTAGE_MAX)
+  uint32_t ck8mFrequency;     // RTC8M_CLK (Hz) assumed by the solver, 0 = CK8M (see DacEspClock)
+} DacEspConfig;
+
 // DacESP32 class
 class DacESP32
 {
@@ -119,13 +156,24 @@ class DacESP32
     esp_err_t outputCW(uint32_t frequency, dac_cw_scale_t scale,
                        dac_cw_phase_t phase = DAC_CW_PHASE_0, int8_t offset = DAC_CW_OFFSET_DEFAULT);                       
     esp_err_t setCwFrequency(uint32_t frequency);
+    esp_err_t setCwFrequency(uint32_t frequency, const dac_cw_solver_opts_t &opts);
     esp_err_t setCwScale(dac_cw_scale_t scale);
     esp_err_t setCwOffset(int8_t offset);
     esp_err_t setCwPhase(dac_cw_phase_t phase);
+    static esp_err_t solveCwFrequency(uint32_t frequency, dac_cw_setting_t *setting);
+    static esp_err_t solveCwFrequency(uint32_t frequency, dac_cw_setting_t *setting, const dac_cw_solver_opts_t &opts);
+    static float     estimateCwSpurLevel(uint16_t frequencyStep);
+    uint32_t         getCwFrequencyActual(void);
+    static void      getState(dac_state_t *state, dac_reg_dump_t *regs = NULL);
     dac_channel_t  getChannel() { return m_channel; };
     dac_cw_scale_t getCwScale() { return m_cwScale; };
     dac_cw_phase_t getCwPhase() { return m_cwPhase; };
     int8_t         getCwOffset() { return m_cwOffset; };     
+    esp_err_t      setConfig(const DacEspConfig &config);
+    void           useGlobalConfig(void) { m_ownConfig = false; };
+    const DacEspConfig &getConfig() { return settings().config; };
+    static esp_err_t setGlobalConfig(const DacEspConfig &config);
+    static const DacEspConfig &getGlobalConfig() { return m_global.config; };
 
     #ifdef DACESP32_DEBUG_FUNCTIONS_ENABLED
     void printObjectVariables(void);
@@ -135,11 +183,43 @@ class DacESP32
     // shared by all objects of this class
     static size_t   m_objectCount; // number of objects created
     static uint32_t m_cwFrequency; // CW generator output frequency, common to all objects 
+    static portMUX_TYPE m_regLock; // guards updates of shared DAC registers
 
   private:
+    friend class DacEspTransaction;
+    friend class DacEspIsr;
+    friend class DacEspFrac;
+
     esp_err_t dacCwSelect(void);
     esp_err_t dacCwDeselect(void);
-    
+    void      applyCwSetting(const dac_cw_setting_t &setting);
+
+    // implementations of the public methods, not tagged (see DAC_API())
+    esp_err_t assignChannel(dac_channel_t channel);
+    esp_err_t applyVoltage(uint8_t value);
+    esp_err_t applyCwFrequency(uint32_t frequency);
+    esp_err_t applyCwScale(dac_cw_scale_t scale);
+    esp_err_t applyCwOffset(int8_t offset);
+    esp_err_t applyCwPhase(dac_cw_phase_t phase);
+
+    // configuration & constants derived from it when set
+    typedef struct {
+      DacEspConfig           config;
+      dac_cw_solver_params_t solver;       // parameters for DacEspCwSolver
+      float                  voltageScale; // DAC value per Volt (255 / channelVoltageMax)
+    } dac_settings_t;
+
+    const dac_settings_t &settings() { return m_ownConfig ? m_settings : m_global; };
+    static esp_err_t deriveSettings(const DacEspConfig &config, dac_settings_t *settings);
+    static esp_err_t solve(const dac_settings_t &settings, uint32_t frequency, dac_cw_setting_t *setting);
+    static esp_err_t solve(const dac_settings_t &settings, uint32_t frequency, dac_cw_setting_t *setting,
+                           const dac_cw_solver_opts_t &opts);
+    static void      applyCk8mDfreq(int16_t dfreq);
+
+    static dac_settings_t m_global; // global configuration (read in ISRs, kept in DRAM)
+    dac_settings_t  m_settings;    // object specific configuration
+    bool            m_ownConfig;   // object specific configuration in use
+
     dac_channel_t   m_channel;     // DAC channel this object is assigned to
     dac_cw_scale_t  m_cwScale;     // CW generator output amplitude
     dac_cw_phase_t  m_cwPhase;     // CW generator output phaseshift
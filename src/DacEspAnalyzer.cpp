@@ -0,0 +1,292 @@
+/*
+  DacEspAnalyzer, network analyzer mode of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Network analyzer mode: sweeps the CW generator over a frequency range,
+  captures the response of a device (e.g. a filter) and optionally its
+  input with the ADC via I2S DMA and evaluates gain & phase at each
+  frequency with a single bin DFT (DacEspGoertzel).
+  Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "DacEspAnalyzer.h"
+
+#ifdef DAC_NA_SUPPORTED
+
+#include <math.h>
+#include "driver/i2s.h"
+#include "DacEspIsr.h"
+#include "DacEspArbiter.h"
+
+#define DAC_NA_READ_TIMEOUT_MS 1000
+
+DacEspAnalyzer::DacEspAnalyzer(DacESP32 &dac) : m_dac(dac)
+{
+  m_words = NULL;
+  m_running = false;
+  m_cwStarted = false;
+}
+
+DacEspAnalyzer::~DacEspAnalyzer()
+{
+  end();
+}
+
+//
+// Start the ADC (I2S0 in ADC mode, DMA running continuously). The DAC
+// output has to be wired to the device input, the device output to the
+// response channel and, for gain & phase, the device input to the
+// reference channel. Only ADC1 channels (GPIO32...39) can be used.
+// Parameter: config...channels, sample rate, block size & settle time
+//
+esp_err_t DacEspAnalyzer::begin(const dac_na_config_t &config)
+{
+  esp_err_t err;
+
+  if (config.response >= ADC1_CHANNEL_MAX || config.reference == config.response || config.sampleRate == 0 ||
+      config.samples < 2 || config.samples > DAC_NA_SAMPLES_MAX) {
+    log_e("Parameter error !");
+    return ESP_ERR_INVALID_ARG;
+  }
+  end();
+
+  m_config = config;
+  m_cwStarted = false;
+  // two words per sample (reference & response), one more for alignment
+  m_words = (uint16_t *)malloc((2 * config.samples + 2) * sizeof(uint16_t));
+  if (m_words == NULL) {
+    log_e("Out of memory !");
+    return ESP_ERR_NO_MEM;
+  }
+
+  i2s_config_t i2s = {};
+  i2s.mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX | I2S_MODE_ADC_BUILT_IN);
+  i2s.sample_rate = config.sampleRate;
+  i2s.bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT;
+  i2s.channel_format = I2S_CHANNEL_FMT_ONLY_LEFT;
+  i2s.communication_format = I2S_COMM_FORMAT_STAND_I2S;
+  i2s.dma_buf_count = DAC_NA_DMA_BUF_COUNT;
+  i2s.dma_buf_len = DAC_NA_DMA_BUF_LEN;
+  i2s.use_apll = false;
+  if ((err = i2s_driver_install(DAC_NA_I2S_PORT, &i2s, 0, NULL)) != ESP_OK) {
+    log_e("i2s_driver_install failed, error=%d !", err);
+    free(m_words);
+    m_words = NULL;
+    return err;
+  }
+  m_running = true;
+
+  adc1_config_width(ADC_WIDTH_BIT_12);
+  adc1_config_channel_atten(config.response, config.atten);
+  if (config.reference != DAC_NA_NO_REFERENCE) {
+    adc1_config_channel_atten(config.reference, config.atten);
+  }
+  if ((err = i2s_set_adc_mode(ADC_UNIT_1, config.response)) == ESP_OK) {
+    err = i2s_adc_enable(DAC_NA_I2S_PORT);
+  }
+  if (err == ESP_OK && config.reference != DAC_NA_NO_REFERENCE) {
+    // i2s_adc_enable() installs the single channel pattern of i2s_set_adc_mode(),
+    // replace it by reference & response converted alternately
+    // (pattern entry: channel << 4 | bit width << 2 | attenuation)
+    adc_digi_pattern_table_t pattern[2];
+    pattern[0].val = (config.reference << 4) | (ADC_WIDTH_BIT_12 << 2) | config.atten;
+    pattern[1].val = (config.response << 4) | (ADC_WIDTH_BIT_12 << 2) | config.atten;
+
+    adc_digi_config_t digi = {};
+    digi.adc1_pattern_len = 2;
+    digi.adc1_pattern = pattern;
+    digi.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+    digi.format = ADC_DIGI_FORMAT_12BIT;
+    err = adc_digi_controller_config(&digi);
+  }
+  if (err != ESP_OK) {
+    log_e("ADC setup failed, error=%d !", err);
+    end();
+  }
+
+  return err;
+}
+
+//
+// Stop the ADC & release I2S0. The CW output is left running.
+//
+esp_err_t DacEspAnalyzer::end()
+{
+  if (m_running) {
+    i2s_adc_disable(DAC_NA_I2S_PORT);
+    i2s_driver_uninstall(DAC_NA_I2S_PORT);
+    m_running = false;
+  }
+  free(m_words);
+  m_words = NULL;
+
+  return ESP_OK;
+}
+
+//
+// Measure at one frequency.
+// Parameter: frequency...target frequency (Hz), the nearest CW setting is used
+//            point...receives setting, output frequency & result
+//
+esp_err_t DacEspAnalyzer::measure(uint32_t frequency, dac_na_point_t *point)
+{
+  esp_err_t err;
+
+  if (!m_running || point == NULL) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  if ((err = DacESP32::solveCwFrequency(frequency, &point->setting)) != ESP_OK) {
+    return err;
+  }
+  return measurePoint(point);
+}
+
+//
+// Sweep a frequency range. All CW settings get solved first, so each point
+// only costs the register writes, settle time, capture & one Goertzel pass
+// per channel. Points closer together than the CW frequency resolution end
+// up with the same setting.
+// Parameter: startFrequency, stopFrequency...range (Hz)
+//            points...number of frequencies (results has to hold as many)
+//            logarithmic...true: points spaced logarithmically, else linearly
+//            results...receive setting, output frequency & result per point
+//
+esp_err_t DacEspAnalyzer::sweep(uint32_t startFrequency, uint32_t stopFrequency, uint16_t points, bool logarithmic,
+                                dac_na_point_t *results)
+{
+  esp_err_t err;
+
+  if (!m_running) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  if (points == 0 || results == NULL || startFrequency == 0 || stopFrequency < startFrequency) {
+    log_e("Parameter error !");
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  for (uint16_t i = 0; i < points; i++) {
+    double x = (points > 1) ? (double)i / (points - 1) : 0;
+    double frequency = logarithmic ? startFrequency * pow((double)stopFrequency / startFrequency, x)
+                                   : startFrequency + (stopFrequency - startFrequency) * x;
+    if ((err = DacESP32::solveCwFrequency((uint32_t)(frequency + 0.5), &results[i].setting)) != ESP_OK) {
+      return err;
+    }
+  }
+  for (uint16_t i = 0; i < points; i++) {
+    if ((err = measurePoint(&results[i])) != ESP_OK) {
+      return err;
+    }
+  }
+
+  return ESP_OK;
+}
+
+//
+// Apply a solved setting, wait, capture & evaluate.
+//
+esp_err_t DacEspAnalyzer::measurePoint(dac_na_point_t *point)
+{
+  esp_err_t err;
+  bool reference = (m_config.reference != DAC_NA_NO_REFERENCE);
+
+  if (!m_cwStarted) {
+    // first point switches the CW output on, keeping scale, phase & offset
+    err = m_dac.outputCW(point->setting.frequency, m_dac.getCwScale(), m_dac.getCwPhase(), m_dac.getCwOffset());
+    m_cwStarted = (err == ESP_OK);
+  } else if ((err = DacEspIsr::setCwFrequency(point->setting)) == ESP_OK) {
+    // points of a sweep may use different dividers, tell subscribers (ADC users)
+    DacEspArbiter::checkDivider();
+  }
+  if (err != ESP_OK) {
+    return err;
+  }
+  point->fcw = m_dac.getCwFrequencyActual();
+  delay(m_config.settleMs);
+
+  // whole number of cycles per channel, the capture may start with the response channel
+  float channelRate = reference ? m_config.sampleRate / 2.0f : (float)m_config.sampleRate;
+  uint32_t samples = DacEspGoertzel::coherentLength(channelRate, point->fcw, m_config.samples);
+  size_t words = reference ? 2 * samples + 1 : samples;
+  if ((err = capture(words)) != ESP_OK) {
+    return err;
+  }
+
+  bool valid;
+  if (reference) {
+    valid = DacEspGoertzel::response(m_words, words, m_config.reference, m_config.response, m_config.sampleRate,
+                                     point->fcw, &point->result);
+  } else {
+    // no reference: response amplitude only
+    memset(&point->result, 0, sizeof(point->result));
+    valid = DacEspGoertzel::tone(m_words, words, m_config.response, channelRate, point->fcw,
+                                 &point->result.response);
+    point->result.response.phase = NAN;
+    point->result.gainDb = NAN;
+    point->result.phase = NAN;
+  }
+  if (!valid) {
+    log_e("frequency (%d) above Nyquist frequency or no samples !", point->fcw);
+    return ESP_ERR_INVALID_SIZE;
+  }
+
+  return ESP_OK;
+}
+
+//
+// Read a block of fresh sample words. Samples already waiting in the DMA
+// buffers (converted before or while settling) get dropped first.
+//
+esp_err_t DacEspAnalyzer::capture(size_t words)
+{
+  size_t bufferBytes = (2 * m_config.samples + 2) * sizeof(uint16_t);
+  size_t bytes = ((words + 1) & ~(size_t)1) * sizeof(uint16_t);
+  size_t got;
+  esp_err_t err;
+
+  for (size_t stale = DAC_NA_DMA_BUF_COUNT * DAC_NA_DMA_BUF_LEN * sizeof(uint16_t); stale > 0; stale -= got) {
+    err = i2s_read(DAC_NA_I2S_PORT, m_words, (stale < bufferBytes) ? stale : bufferBytes, &got,
+                   pdMS_TO_TICKS(DAC_NA_READ_TIMEOUT_MS));
+    if (err != ESP_OK || got == 0) {
+      return (err != ESP_OK) ? err : ESP_ERR_TIMEOUT;
+    }
+  }
+  for (size_t total = 0; total < bytes; total += got) {
+    err = i2s_read(DAC_NA_I2S_PORT, (uint8_t *)m_words + total, bytes - total, &got,
+                   pdMS_TO_TICKS(DAC_NA_READ_TIMEOUT_MS));
+    if (err != ESP_OK || got == 0) {
+      return (err != ESP_OK) ? err : ESP_ERR_TIMEOUT;
+    }
+  }
+
+  // the I2S ADC delivers 16 bit samples swapped in pairs
+  for (size_t i = 0; i + 1 < bytes / sizeof(uint16_t); i += 2) {
+    uint16_t word = m_words[i];
+    m_words[i] = m_words[i + 1];
+    m_words[i + 1] = word;
+  }
+
+  return ESP_OK;
+}
+
+#endif
@@ -0,0 +1,106 @@
+/*
+  DacEspAnalyzer, network analyzer mode of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Network analyzer mode: sweeps the CW generator over a frequency range,
+  captures the response of a device (e.g. a filter) and optionally its
+  input with the ADC via I2S DMA and evaluates gain & phase at each
+  frequency with a single bin DFT (DacEspGoertzel).
+  Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef DacEspAnalyzer_h
+#define DacEspAnalyzer_h
+
+#include "DacESP32.h"
+#include "DacEspGoertzel.h"
+
+#ifndef DACESP32_HOST_EMULATION
+#include "esp_idf_version.h"
+#include "driver/adc.h"
+#endif
+
+// I2S ADC DMA with the ESP32 pattern table: ESP-IDF 4.x on target only
+#if !defined(DACESP32_HOST_EMULATION) && ESP_IDF_VERSION_MAJOR == 4
+#define DAC_NA_SUPPORTED
+#endif
+
+#ifdef DAC_NA_SUPPORTED
+
+//
+// definitions
+//
+// Max. samples per channel captured per frequency.
+#ifndef DAC_NA_SAMPLES_MAX
+#define DAC_NA_SAMPLES_MAX 4096
+#endif
+#define DAC_NA_I2S_PORT      I2S_NUM_0       // only I2S0 can read the ADC
+#define DAC_NA_DMA_BUF_LEN   1024            // samples per DMA buffer
+#define DAC_NA_DMA_BUF_COUNT 4
+#define DAC_NA_NO_REFERENCE  ADC1_CHANNEL_MAX
+
+typedef struct {
+  adc1_channel_t response;  // ADC1 channel measuring the device output
+  adc1_channel_t reference; // ADC1 channel measuring the device input (DAC pin), DAC_NA_NO_REFERENCE = none
+  adc_atten_t    atten;     // attenuation of both channels
+  uint32_t       sampleRate;// ADC conversions per second (both channels together)
+  uint16_t       samples;   // max. samples per channel & frequency (<= DAC_NA_SAMPLES_MAX)
+  uint16_t       settleMs;  // wait time after changing the frequency
+} dac_na_config_t;
+
+#define DAC_NA_CONFIG_DEFAULT() { ADC1_CHANNEL_7, ADC1_CHANNEL_6, ADC_ATTEN_DB_11, 100000, 2048, 20 }
+
+typedef struct {
+  dac_cw_setting_t        setting;  // CW generator setting (solved before the sweep)
+  uint32_t                fcw;      // output frequency of this setting (Hz)
+  dac_goertzel_response_t result;   // tones, gain (dB) & phase (degree), NAN without reference
+} dac_na_point_t;
+
+// DacEspAnalyzer class
+class DacEspAnalyzer
+{
+  public:
+    DacEspAnalyzer(DacESP32 &dac);
+    ~DacEspAnalyzer();
+    esp_err_t begin(const dac_na_config_t &config);
+    esp_err_t end(void);
+    esp_err_t measure(uint32_t frequency, dac_na_point_t *point);
+    esp_err_t sweep(uint32_t startFrequency, uint32_t stopFrequency, uint16_t points, bool logarithmic,
+                    dac_na_point_t *results);
+
+  private:
+    esp_err_t solve(uint32_t frequency, dac_na_point_t *point);
+    esp_err_t measurePoint(dac_na_point_t *point);
+    esp_err_t capture(size_t words);
+
+    DacESP32       &m_dac;
+    dac_na_config_t m_config;
+    uint16_t       *m_words;      // I2S ADC sample words
+    bool            m_running;    // I2S ADC started
+    bool            m_cwStarted;  // CW output switched on by the analyzer
+};
+
+#endif
+
+#endif
@@ -0,0 +1,328 @@
+/*
+  DacEspArbiter, CK8M_DIV_SEL arbitration for the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Keeps the constraints different components put on RTC_CNTL_CK8M_DIV_SEL
+  (e.g. an ADC sampling via the digital controller needing div <= 2) and
+  notifies subscribers of divider changes. The CW solvers of DacESP32 &
+  DacEspFrac only use dividers allowed by all constraints, a new constraint
+  moves a divider in use out of the way.
+  Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "DacEspArbiter.h"
+#include "DacEspIsr.h"
+#include "DacEspFrac.h"
+#include "DacEspRegs.h"
+#include "DacEspProfile.h"
+
+// initialize static members of class, m_allowed is read inside ISRs (kept in DRAM)
+DacEspArbiter::dac_arb_constraint_t DacEspArbiter::m_constraints[DAC_ARB_CONSTRAINTS_MAX];
+DacEspArbiter::dac_arb_subscriber_t DacEspArbiter::m_subscribers[DAC_ARB_SUBSCRIBERS_MAX];
+DRAM_ATTR volatile uint8_t DacEspArbiter::m_allowed = DAC_ARB_DIV_ANY;
+uint8_t                    DacEspArbiter::m_divider = DAC_ARB_DIV_UNKNOWN;
+portMUX_TYPE               DacEspArbiter::m_lock = portMUX_INITIALIZER_UNLOCKED;
+
+//
+// Register a constraint on CK8M_DIV_SEL. If the divider in use is not allowed
+// anymore the CW frequency gets solved again within the allowed dividers (or
+// the lowest allowed divider is set if the CW generator is not in use).
+// Parameter: owner...name of the component (kept as pointer, shown in messages)
+//            allowed...dividers allowed, e.g. DAC_ARB_DIV_UPTO(2) for div <= 2
+//            id...receives the handle for updateConstraint() & removeConstraint()
+// Fails with ESP_ERR_INVALID_STATE if the constraint conflicts with the others
+// or the current CW frequency cannot be kept, nothing gets changed then.
+//
+esp_err_t DacEspArbiter::addConstraint(const char *owner, uint8_t allowed, int *id)
+{
+  DAC_API(DAC_API_ARBITER_ADD);
+
+  int slot;
+  esp_err_t result;
+
+  if (id == NULL || (allowed & DAC_ARB_DIV_UPTO(CK8M_DIV_MAX)) == 0) {
+    log_e("Parameter error !");
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  // reserve a free slot, setConstraint() fills it
+  portENTER_CRITICAL(&m_lock);
+  for (slot = 0; slot < DAC_ARB_CONSTRAINTS_MAX; slot++) {
+    if (m_constraints[slot].allowed == 0 && m_constraints[slot].owner == NULL) {
+      m_constraints[slot].owner = owner ? owner : "?";
+      break;
+    }
+  }
+  portEXIT_CRITICAL(&m_lock);
+
+  if (slot == DAC_ARB_CONSTRAINTS_MAX) {
+    log_e("no free constraint slot (DAC_ARB_CONSTRAINTS_MAX = %d)", DAC_ARB_CONSTRAINTS_MAX);
+    return ESP_ERR_NO_MEM;
+  }
+  if ((result = setConstraint(slot, owner ? owner : "?", allowed)) != ESP_OK) {
+    portENTER_CRITICAL(&m_lock);
+    m_constraints[slot].owner = NULL;
+    portEXIT_CRITICAL(&m_lock);
+    return result;
+  }
+  *id = slot;
+
+  return ESP_OK;
+}
+
+//
+// Change the dividers allowed by a constraint, see addConstraint().
+//
+esp_err_t DacEspArbiter::updateConstraint(int id, uint8_t allowed)
+{
+  DAC_API(DAC_API_ARBITER_UPDATE);
+
+  if (id < 0 || id >= DAC_ARB_CONSTRAINTS_MAX || m_constraints[id].allowed == 0 ||
+      (allowed & DAC_ARB_DIV_UPTO(CK8M_DIV_MAX)) == 0) {
+    log_e("Parameter error !");
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  return setConstraint(id, m_constraints[id].owner, allowed);
+}
+
+//
+// Remove a constraint, the divider in use stays unchanged.
+//
+esp_err_t DacEspArbiter::removeConstraint(int id)
+{
+  DAC_API(DAC_API_ARBITER_REMOVE);
+
+  if (id < 0 || id >= DAC_ARB_CONSTRAINTS_MAX || m_constraints[id].allowed == 0) {
+    log_e("Parameter error !");
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  portENTER_CRITICAL(&m_lock);
+  m_constraints[id].owner = NULL;
+  m_constraints[id].allowed = 0;
+  m_allowed = combine();
+  portEXIT_CRITICAL(&m_lock);
+
+  return ESP_OK;
+}
+
+//
+// Register a callback invoked after CK8M_DIV_SEL changed. Callbacks run in
+// the task that caused the change (never inside an ISR), outside of any lock.
+// They should only reconfigure their clients and must not block.
+// Parameter: callback...function to call
+//            arg...passed to the callback
+//
+esp_err_t DacEspArbiter::subscribe(dac_arb_callback_t callback, void *arg)
+{
+  if (callback == NULL) {
+    log_e("Parameter error !");
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  // first subscriber, start tracking from the divider in use
+  uint8_t div = getDivider();
+
+  portENTER_CRITICAL(&m_lock);
+  if (m_divider == DAC_ARB_DIV_UNKNOWN) {
+    m_divider = div;
+  }
+  for (int i = 0; i < DAC_ARB_SUBSCRIBERS_MAX; i++) {
+    if (m_subscribers[i].callback == NULL) {
+      m_subscribers[i].callback = callback;
+      m_subscribers[i].arg = arg;
+      portEXIT_CRITICAL(&m_lock);
+      return ESP_OK;
+    }
+  }
+  portEXIT_CRITICAL(&m_lock);
+
+  log_e("no free subscriber slot (DAC_ARB_SUBSCRIBERS_MAX = %d)", DAC_ARB_SUBSCRIBERS_MAX);
+  return ESP_ERR_NO_MEM;
+}
+
+esp_err_t DacEspArbiter::unsubscribe(dac_arb_callback_t callback, void *arg)
+{
+  portENTER_CRITICAL(&m_lock);
+  for (int i = 0; i < DAC_ARB_SUBSCRIBERS_MAX; i++) {
+    if (m_subscribers[i].callback == callback && m_subscribers[i].arg == arg) {
+      m_subscribers[i].callback = NULL;
+      portEXIT_CRITICAL(&m_lock);
+      return ESP_OK;
+    }
+  }
+  portEXIT_CRITICAL(&m_lock);
+
+  return ESP_ERR_NOT_FOUND;
+}
+
+//
+// Get CK8M_DIV_SEL currently set in the register (changes pending in batch
+// mode of DacEspRegs are not yet visible).
+//
+uint8_t DacEspArbiter::getDivider()
+{
+  DAC_ENTER_CRITICAL();
+  uint32_t clkConf = DAC_HAL_READ(DacEspRegs::address(DAC_REG_CLK_CONF));
+  DAC_EXIT_CRITICAL();
+
+  return (clkConf & RTC_CNTL_CK8M_DIV_SEL_M) >> RTC_CNTL_CK8M_DIV_SEL_S;
+}
+
+//
+// Get the lowest CK8M_DIV_SEL allowed (default when the CW generator is unused).
+//
+uint8_t DacEspArbiter::getDividerMin()
+{
+  return __builtin_ctz(m_allowed);
+}
+
+//
+// Notify subscribers if CK8M_DIV_SEL changed since the last call. The library
+// calls it after each change it makes in task context. Call it yourself after
+// DacEspIsr::setCwFrequency() was used inside an ISR or after
+// DacEspRegs::flush() in batch mode. Not for ISR context.
+//
+void DacEspArbiter::checkDivider()
+{
+  dac_arb_subscriber_t subscribers[DAC_ARB_SUBSCRIBERS_MAX];
+  uint8_t div = getDivider();
+
+  portENTER_CRITICAL(&m_lock);
+  uint8_t old = m_divider;
+  m_divider = div;
+  memcpy(subscribers, m_subscribers, sizeof(subscribers));
+  portEXIT_CRITICAL(&m_lock);
+
+  if (old == div || old == DAC_ARB_DIV_UNKNOWN) {
+    return;
+  }
+
+  log_d("CK8M_DIV_SEL %d -> %d", old, div);
+  for (int i = 0; i < DAC_ARB_SUBSCRIBERS_MAX; i++) {
+    if (subscribers[i].callback != NULL) {
+      subscribers[i].callback(old, div, subscribers[i].arg);
+    }
+  }
+}
+
+//
+// Store a constraint & make the divider in use comply with it. Restores the
+// previous constraint on failure.
+//
+esp_err_t DacEspArbiter::setConstraint(int id, const char *owner, uint8_t allowed)
+{
+  esp_err_t result;
+
+  portENTER_CRITICAL(&m_lock);
+  dac_arb_constraint_t prev = m_constraints[id];
+  m_constraints[id].owner = owner;
+  m_constraints[id].allowed = allowed;
+  uint8_t combined = combine();
+  if (combined == 0) {
+    m_constraints[id] = prev;
+    portEXIT_CRITICAL(&m_lock);
+    log_e("constraint 0x%02x of %s conflicts with allowed dividers 0x%02x", allowed, owner, m_allowed);
+    return ESP_ERR_INVALID_STATE;
+  }
+  // solvers running from now on already respect the new set
+  m_allowed = combined;
+  portEXIT_CRITICAL(&m_lock);
+
+  if ((result = enforce()) != ESP_OK) {
+    portENTER_CRITICAL(&m_lock);
+    m_constraints[id] = prev;
+    m_allowed = combine();
+    portEXIT_CRITICAL(&m_lock);
+    return result;
+  }
+  checkDivider();
+
+  return ESP_OK;
+}
+
+//
+// Dividers allowed by all constraints (m_lock held).
+//
+uint8_t DacEspArbiter::combine()
+{
+  uint8_t allowed = DAC_ARB_DIV_ANY;
+
+  for (int i = 0; i < DAC_ARB_CONSTRAINTS_MAX; i++) {
+    if (m_constraints[i].allowed) {
+      allowed &= m_constraints[i].allowed;
+    }
+  }
+  return allowed & DAC_ARB_DIV_UPTO(CK8M_DIV_MAX);
+}
+
+//
+// Move CK8M_DIV_SEL into the allowed set if needed.
+//
+esp_err_t DacEspArbiter::enforce()
+{
+  uint8_t div = getDivider();
+  dac_cw_setting_t setting;
+
+  if (isAllowed(div)) {
+    return ESP_OK;
+  }
+
+  if (DacESP32::m_cwFrequency == 0) {
+    // CW generator not in use
+    DAC_ENTER_CRITICAL();
+    DacEspRegs::setField(DAC_REG_CLK_CONF, RTC_CNTL_CK8M_DIV_SEL_M,
+                         (uint32_t)getDividerMin() << RTC_CNTL_CK8M_DIV_SEL_S);
+    DAC_EXIT_CRITICAL();
+    return ESP_OK;
+  }
+
+  if (!DacESP32::getGlobalConfig().cwHighAccuracy || DacEspFrac::isRunning()) {
+    // CW frequency relies on the divider in use
+    log_e("CK8M_DIV_SEL %d in use by CW generator", div);
+    return ESP_ERR_INVALID_STATE;
+  }
+  if (DacESP32::solveCwFrequency(DacESP32::m_cwFrequency, &setting) != ESP_OK) {
+    log_e("CW frequency %d not possible with allowed dividers 0x%02x", DacESP32::m_cwFrequency, m_allowed);
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  return DacEspIsr::setCwFrequency(setting);
+}
+
+#ifdef DACESP32_DEBUG_FUNCTIONS_ENABLED
+//
+// Print constraints & divider in use (only useful for debugging purposes)
+//
+void DacEspArbiter::printConstraints()
+{
+  Serial.println("\nCK8M_DIV_SEL constraints:");
+  for (int i = 0; i < DAC_ARB_CONSTRAINTS_MAX; i++) {
+    if (m_constraints[i].allowed) {
+      Serial.printf("  id=%d, owner=%s, allowed=0x%02x\n", i, m_constraints[i].owner, m_constraints[i].allowed);
+    }
+  }
+  Serial.printf("  allowed=0x%02x, CK8M_DIV_SEL=%d\n", m_allowed, getDivider());
+}
+#endif
@@ -0,0 +1,108 @@
+/*
+  DacEspArbiter, CK8M_DIV_SEL arbitration for the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  RTC_CNTL_CK8M_DIV_SEL divides RTC8M_CLK for the digital controller of both
+  the DAC and the ADC. With cwHighAccuracy the CW solver picks it freely,
+  which changes the ADC sampling rate behind its back. Components register
+  constraints (sets of allowed dividers) with class DacEspArbiter, the
+  solvers only search dividers allowed by all of them. Subscribers get a
+  callback whenever the divider really changes.
+  Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef DacEspArbiter_h
+#define DacEspArbiter_h
+
+#include "DacESP32.h"
+
+//
+// definitions
+//
+#ifndef DAC_ARB_CONSTRAINTS_MAX
+#define DAC_ARB_CONSTRAINTS_MAX 8
+#endif
+#ifndef DAC_ARB_SUBSCRIBERS_MAX
+#define DAC_ARB_SUBSCRIBERS_MAX 4
+#endif
+
+// sets of CK8M_DIV_SEL values, bit per divider
+#define DAC_ARB_DIV_ANY     0xFF                          // all dividers
+#define DAC_ARB_DIV_UPTO(n) ((uint8_t)((2U << (n)) - 1))  // CK8M_DIV_SEL <= n
+#define DAC_ARB_DIV_ONLY(n) ((uint8_t)(1U << (n)))        // CK8M_DIV_SEL == n
+
+#define DAC_ARB_DIV_UNKNOWN 0xFF
+
+// called after CK8M_DIV_SEL changed, the new digital controller clock is RTC8M_CLK / (1 + newDiv)
+typedef void (*dac_arb_callback_t)(uint8_t oldDiv, uint8_t newDiv, void *arg);
+
+// DacEspArbiter class, all members are static (one divider for DAC & ADC)
+class DacEspArbiter
+{
+  public:
+    //
+    // Check if a CK8M_DIV_SEL value is allowed by all constraints. Safe in
+    // IRAM/ISR context.
+    //
+    static inline __attribute__((always_inline)) bool isAllowed(uint8_t div)
+    {
+      return div <= CK8M_DIV_MAX && (m_allowed & (1U << div));
+    }
+
+    static esp_err_t addConstraint(const char *owner, uint8_t allowed, int *id);
+    static esp_err_t updateConstraint(int id, uint8_t allowed);
+    static esp_err_t removeConstraint(int id);
+    static uint8_t   getAllowed(void) { return m_allowed; };
+    static esp_err_t subscribe(dac_arb_callback_t callback, void *arg = NULL);
+    static esp_err_t unsubscribe(dac_arb_callback_t callback, void *arg = NULL);
+    static uint8_t   getDivider(void);
+    static uint8_t   getDividerMin(void);
+    static void      checkDivider(void);
+
+    #ifdef DACESP32_DEBUG_FUNCTIONS_ENABLED
+    static void printConstraints(void);
+    #endif
+
+  private:
+    typedef struct {
+      const char *owner;        // name shown in messages
+      uint8_t     allowed;      // dividers allowed (0 = slot free)
+    } dac_arb_constraint_t;
+
+    typedef struct {
+      dac_arb_callback_t callback;
+      void              *arg;
+    } dac_arb_subscriber_t;
+
+    static esp_err_t setConstraint(int id, const char *owner, uint8_t allowed);
+    static uint8_t   combine(void);
+    static esp_err_t enforce(void);
+
+    static dac_arb_constraint_t m_constraints[DAC_ARB_CONSTRAINTS_MAX];
+    static dac_arb_subscriber_t m_subscribers[DAC_ARB_SUBSCRIBERS_MAX];
+    static volatile uint8_t     m_allowed;    // dividers allowed by all constraints
+    static uint8_t              m_divider;    // CK8M_DIV_SEL last reported to subscribers
+    static portMUX_TYPE         m_lock;       // guards constraints & subscribers
+};
+
+#endif
@@ -0,0 +1,298 @@
+/*
+  DacEspBench, microbenchmark of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Microbenchmark of the public DacESP32 methods. Every method gets called
+  repeatedly with varying arguments, each call timed with the CPU cycle
+  counter (host emulation: steady clock). The report is CSV, one line per
+  method, to track regressions across library versions.
+  Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "DacEspBench.h"
+#include "DacChannel.h"
+#include <algorithm>
+
+// initialize static members of class
+uint32_t DacEspBench::m_samples[DAC_BENCH_ITERATIONS_MAX];
+uint32_t DacEspBench::m_overhead = 0;
+
+//
+// Measure all public methods with register access (and the frequency
+// solver) on the channel of a DacESP32 object and output a CSV report:
+//   # comment lines (platform, cycle counter clock, build options)
+//   method,iterations,errors,min_ns,mean_ns,p50_ns,p99_ns,max_ns,calls_per_s
+//   one line per method
+// The channel outputs test signals meanwhile and gets disabled at the end.
+// Run it from a task with nothing else going on, interrupts are not masked.
+// Parameter: dac...object to use (global configuration expected)
+//            config...iterations & frequency range, 0 limits are taken
+//                     from the global configuration (getGlobalConfig())
+//            out...gets called with each line of the report
+//            arg...passed to out
+//
+esp_err_t DacEspBench::run(DacESP32 &dac, const dac_bench_config_t &config, dac_bench_out_t out, void *arg)
+{
+  char line[DAC_BENCH_LINE_LEN];
+  dac_bench_result_t result;
+  uint16_t n = config.iterations;
+  const DacEspConfig &global = DacESP32::getGlobalConfig();
+  uint32_t ck8m = global.ck8mFrequency ? global.ck8mFrequency : CK8M;
+  // lowest: highest CK8M_DIV_SEL with SW_FSTEP 1, highest: CK8M_DIV_SEL 0 with SW_FSTEP max.
+  uint32_t fMin = config.cwFrequencyMin ? config.cwFrequencyMin :
+                  DacEspCwSolver::outputFrequency(ck8m, global.cwHighAccuracy ? CK8M_DIV_MAX : 0, 1);
+  uint32_t fMax = config.cwFrequencyMax ? config.cwFrequencyMax :
+                  DacEspCwSolver::outputFrequency(ck8m, 0, global.fstepMax);
+  uint32_t fSpan = fMax - fMin;
+  dac_cw_solver_opts_t opts = { 2.0f, 0 };
+
+  if (n < 2 || n > DAC_BENCH_ITERATIONS_MAX || fMax < fMin || out == NULL) {
+    log_e("Parameter error !");
+    return ESP_ERR_INVALID_ARG;
+  }
+  // frequency of call i of a sweep over the whole range
+  auto sweep = [=](uint32_t i) { return fMin + (uint32_t)((uint64_t)fSpan * i / (n - 1)); };
+
+  m_overhead = timerOverhead();
+  snprintf(line, sizeof(line), "# DacESP32 benchmark, platform %s, cycle counter %u MHz, timer overhead %u ns (subtracted)",
+#ifdef DACESP32_HOST_EMULATION
+           "host",
+#else
+           "esp32",
+#endif
+           (unsigned)DAC_HAL_CCOUNT_MHZ(), (unsigned)(m_overhead * 1000UL / DAC_HAL_CCOUNT_MHZ()));
+  out(line, arg);
+  snprintf(line, sizeof(line), "# iterations %u, cw frequency %u...%u Hz, trace %s, profiling %s",
+           n, (unsigned)fMin, (unsigned)fMax,
+#ifdef DACESP32_TRACE_ENABLED
+           "on",
+#else
+           "off",
+#endif
+#ifdef DACESP32_PROFILING_ENABLED
+           "on");
+#else
+           "off");
+#endif
+  out(line, arg);
+  out("method,iterations,errors,min_ns,mean_ns,p50_ns,p99_ns,max_ns,calls_per_s", arg);
+
+  // channel state changes, the other state set up before each call (not timed)
+  measure("enable", n, [&](uint32_t) {
+    dac.disable();
+  }, [&](uint32_t) {
+    return dac.enable();
+  }, &result);
+  report(result, out, arg);
+
+  measure("disable", n, [&](uint32_t) {
+    dac.enable();
+  }, [&](uint32_t) {
+    return dac.disable();
+  }, &result);
+  report(result, out, arg);
+
+  dac.enable();
+  measure("outputVoltage(uint8_t)", n, [&](uint32_t i) {
+    return dac.outputVoltage((uint8_t)i);
+  }, &result);
+  report(result, out, arg);
+
+  measure("outputVoltage(float)", n, [&](uint32_t i) {
+    return dac.outputVoltage((float)(i % 34) * 0.1f);
+  }, &result);
+  report(result, out, arg);
+
+  measure("outputCW", n, [&](uint32_t i) {
+    return dac.outputCW(sweep(i), (dac_cw_scale_t)(i & 3), (i & 1) ? DAC_CW_PHASE_180 : DAC_CW_PHASE_0,
+                        (int8_t)(i % 64) - 32);
+  }, &result);
+  report(result, out, arg);
+
+  measure("outputCW(uint32_t)", n, [&](uint32_t i) {
+    return dac.outputCW(sweep(i));
+  }, &result);
+  report(result, out, arg);
+
+  measure("setCwFrequency", n, [&](uint32_t i) {
+    return dac.setCwFrequency(sweep(i));
+  }, &result);
+  report(result, out, arg);
+
+  measure("setCwFrequency(opts)", n, [&](uint32_t i) {
+    return dac.setCwFrequency(sweep(i), opts);
+  }, &result);
+  report(result, out, arg);
+
+  measure("setCwScale", n, [&](uint32_t i) {
+    return dac.setCwScale((dac_cw_scale_t)(i & 3));
+  }, &result);
+  report(result, out, arg);
+
+  measure("setCwPhase", n, [&](uint32_t i) {
+    return dac.setCwPhase((i & 1) ? DAC_CW_PHASE_180 : DAC_CW_PHASE_0);
+  }, &result);
+  report(result, out, arg);
+
+  measure("setCwOffset", n, [&](uint32_t i) {
+    return dac.setCwOffset((int8_t)(i % 64) - 32);
+  }, &result);
+  report(result, out, arg);
+
+  measure("solveCwFrequency", n, [&](uint32_t i) {
+    dac_cw_setting_t setting;
+    return DacESP32::solveCwFrequency(sweep(i), &setting);
+  }, &result);
+  report(result, out, arg);
+
+  measure("solveCwFrequency(opts)", n, [&](uint32_t i) {
+    dac_cw_setting_t setting;
+    return DacESP32::solveCwFrequency(sweep(i), &setting, opts);
+  }, &result);
+  report(result, out, arg);
+
+  measure("getCwFrequencyActual", n, [&](uint32_t) {
+    return dac.getCwFrequencyActual() ? ESP_OK : ESP_FAIL;
+  }, &result);
+  report(result, out, arg);
+
+  measure("getState", n, [&](uint32_t) {
+    dac_state_t state;
+    DacESP32::getState(&state);
+    return ESP_OK;
+  }, &result);
+  report(result, out, arg);
+
+  if (dac.getChannel() == DAC_CHANNEL_1) {
+    measureChannel<DAC_CHANNEL_1>(n, out, arg);
+  }
+  else {
+    measureChannel<DAC_CHANNEL_2>(n, out, arg);
+  }
+
+  return dac.disable();
+}
+
+//
+// Same register accesses through DacChannel<CH> directly (no argument
+// checks, no channel lookup) to compare with the DacESP32 rows above.
+//
+template <dac_channel_t CH>
+void DacEspBench::measureChannel(uint16_t iterations, dac_bench_out_t out, void *arg)
+{
+  dac_bench_result_t result;
+
+  measure("DacChannel::outputVoltage", iterations, [](uint32_t i) {
+    DacChannel<CH>::outputVoltage((uint8_t)i);
+    return ESP_OK;
+  }, &result);
+  report(result, out, arg);
+
+  // lock taken per call, callers holding it already save that part
+  measure("DacChannel::setValueLocked", iterations, [](uint32_t i) {
+    DAC_ENTER_CRITICAL();
+    DacChannel<CH>::setValueLocked((uint8_t)i);
+    DAC_EXIT_CRITICAL();
+    return ESP_OK;
+  }, &result);
+  report(result, out, arg);
+
+  measure("DacChannel::setCwScale", iterations, [](uint32_t i) {
+    DacChannel<CH>::setCwScale((dac_cw_scale_t)(i & 3));
+    return ESP_OK;
+  }, &result);
+  report(result, out, arg);
+}
+
+//
+// Call a method 'iterations' times (after one warm-up call filling caches)
+// and evaluate the durations.
+//
+template <typename Call>
+void DacEspBench::measure(const char *name, uint16_t iterations, Call call, dac_bench_result_t *result)
+{
+  measure(name, iterations, [](uint32_t) {}, call, result);
+}
+
+//
+// Same, prepare gets called before each call and is not timed.
+//
+template <typename Prepare, typename Call>
+void DacEspBench::measure(const char *name, uint16_t iterations, Prepare prepare, Call call,
+                          dac_bench_result_t *result)
+{
+  uint64_t total = 0;
+  uint32_t mhz = DAC_HAL_CCOUNT_MHZ();
+
+  result->name = name;
+  result->iterations = iterations;
+  result->errors = 0;
+  prepare(0);
+  call(0);
+  for (uint32_t i = 0; i < iterations; i++) {
+    prepare(i);
+    uint32_t start = DAC_HAL_CCOUNT();
+    esp_err_t err = call(i);
+    uint32_t cycles = DAC_HAL_CCOUNT() - start;
+
+    m_samples[i] = (cycles > m_overhead) ? cycles - m_overhead : 0;
+    total += m_samples[i];
+    if (err != ESP_OK) {
+      result->errors++;
+    }
+  }
+
+  std::sort(m_samples, m_samples + iterations);
+  result->minNs = m_samples[0] * 1000ULL / mhz;
+  result->meanNs = total * 1000ULL / mhz / iterations;
+  result->p50Ns = m_samples[(iterations - 1) * 50 / 100] * 1000ULL / mhz;
+  result->p99Ns = m_samples[(iterations - 1) * 99 / 100] * 1000ULL / mhz;
+  result->maxNs = m_samples[iterations - 1] * 1000ULL / mhz;
+  result->callsPerSec = total ? (uint32_t)(iterations * 1000000ULL * mhz / total) : 0;
+}
+
+//
+// Cycles needed by the measurement itself (shortest of a few empty ones).
+//
+uint32_t DacEspBench::timerOverhead()
+{
+  uint32_t overhead = UINT32_MAX;
+
+  for (int i = 0; i < 64; i++) {
+    uint32_t start = DAC_HAL_CCOUNT();
+    uint32_t cycles = DAC_HAL_CCOUNT() - start;
+    overhead = std::min(overhead, cycles);
+  }
+  return overhead;
+}
+
+void DacEspBench::report(const dac_bench_result_t &result, dac_bench_out_t out, void *arg)
+{
+  char line[DAC_BENCH_LINE_LEN];
+
+  snprintf(line, sizeof(line), "%s,%u,%u,%u,%u,%u,%u,%u,%u", result.name, (unsigned)result.iterations,
+           (unsigned)result.errors, (unsigned)result.minNs, (unsigned)result.meanNs, (unsigned)result.p50Ns,
+           (unsigned)result.p99Ns, (unsigned)result.maxNs, (unsigned)result.callsPerSec);
+  out(line, arg);
+}
@@ -0,0 +1,88 @@
+/*
+  DacEspBench, microbenchmark of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Microbenchmark of the public DacESP32 methods. Every method gets called
+  repeatedly with varying arguments, each call timed with the CPU cycle
+  counter (host emulation: steady clock). The report is CSV, one line per
+  method, to track regressions across library versions.
+  Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef DacEspBench_h
+#define DacEspBench_h
+
+#include "DacESP32.h"
+
+//
+// definitions
+//
+#define DAC_BENCH_ITERATIONS_MAX 1024
+#define DAC_BENCH_LINE_LEN       160
+
+// receives the report line by line (without line end)
+typedef void (*dac_bench_out_t)(const char *line, void *arg);
+
+typedef struct {
+  uint16_t iterations;      // calls measured per method (max. DAC_BENCH_ITERATIONS_MAX)
+  uint32_t cwFrequencyMin;  // setCwFrequency()/outputCW() sweep start (Hz), 0 = lowest of global configuration
+  uint32_t cwFrequencyMax;  // setCwFrequency()/outputCW() sweep end (Hz), 0 = highest of global configuration
+} dac_bench_config_t;
+
+#define DAC_BENCH_CONFIG_DEFAULT() { 256, 0, 0 }
+
+typedef struct {
+  const char *name;         // method measured
+  uint32_t    iterations;   // calls measured
+  uint32_t    errors;       // calls not returning ESP_OK (e.g. frequency out of range)
+  uint32_t    minNs;        // fastest call
+  uint32_t    meanNs;       // average
+  uint32_t    p50Ns;        // median
+  uint32_t    p99Ns;        // 99th percentile
+  uint32_t    maxNs;        // slowest call
+  uint32_t    callsPerSec;  // throughput (back-to-back calls)
+} dac_bench_result_t;
+
+// DacEspBench class, all members are static
+class DacEspBench
+{
+  public:
+    static esp_err_t run(DacESP32 &dac, const dac_bench_config_t &config, dac_bench_out_t out, void *arg = NULL);
+
+  private:
+    template <typename Call>
+    static void      measure(const char *name, uint16_t iterations, Call call, dac_bench_result_t *result);
+    template <typename Prepare, typename Call>
+    static void      measure(const char *name, uint16_t iterations, Prepare prepare, Call call,
+                             dac_bench_result_t *result);
+    template <dac_channel_t CH>
+    static void      measureChannel(uint16_t iterations, dac_bench_out_t out, void *arg);
+    static uint32_t  timerOverhead(void);
+    static void      report(const dac_bench_result_t &result, dac_bench_out_t out, void *arg);
+
+    static uint32_t m_samples[DAC_BENCH_ITERATIONS_MAX]; // cycles per call
+    static uint32_t m_overhead;                          // cycles of the measurement itself
+};
+
+#endif
@@ -0,0 +1,206 @@
+/*
+  DacEspClock, RTC8M_CLK measurement & trimming for the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  RTC8M_CLK measurement & trimming. Please see Readme.md for more
+  details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "DacEspClock.h"
+#include <Preferences.h>
+#include "DacEspRegs.h"
+#include "DacEspProfile.h"
+
+//
+// Measure RTC8M_CLK frequency against the crystal clock. The 8MD256 divider
+// gets enabled during the measurement if needed.
+// Parameter: slowClkCycles...number of RTC8M_CLK/256 cycles to count
+// Returns frequency in Hz, 0 if the measurement failed.
+//
+uint32_t DacEspClock::measureCk8m(uint32_t slowClkCycles)
+{
+  bool enabled8m = rtc_clk_8m_enabled(), enabledD256 = rtc_clk_8md256_enabled();
+
+  if (!enabled8m || !enabledD256) {
+    rtc_clk_8m_enable(true, true);
+  }
+  // period of RTC8M_CLK/256 in us, fixed point with RTC_CLK_CAL_FRACT fractional bits
+  uint32_t period = rtc_clk_cal(RTC_CAL_8MD256, slowClkCycles);
+  if (!enabled8m || !enabledD256) {
+    rtc_clk_8m_enable(enabled8m, enabledD256);
+  }
+
+  if (period == 0) {
+    log_e("RTC8M_CLK calibration failed");
+    return 0;
+  }
+  return (uint32_t)((256000000ULL << RTC_CLK_CAL_FRACT) / period);
+}
+
+//
+// Search the CK8M_DFREQ value bringing RTC8M_CLK closest to the target frequency,
+// apply it & set the measured frequency in the global configuration (used by the
+// CW frequency solver). Takes about 10 measurements (~0.35s).
+// Parameter: target...wanted RTC8M_CLK frequency (Hz)
+//            result...if not NULL receives the value found & its frequency
+//
+esp_err_t DacEspClock::autoTrim(uint32_t target, dac_trim_result_t *result)
+{
+  DAC_API(DAC_API_CLOCK_AUTO_TRIM);
+
+  uint32_t cycles = DAC_CLOCK_CAL_CYCLES;
+  uint8_t dfreq = currentDfreq();
+  dac_trim_result_t trim;
+
+  // the search leaves the value measured last, restore the original one on errors
+  if (!DacEspTrimSearch::search(target, measureAt, &cycles, &trim)) {
+    log_e("RTC8M_CLK trimming failed");
+    applyDfreq(dfreq);
+    return ESP_FAIL;
+  }
+
+  log_d("CK8M_DFREQ=%d, RTC8M_CLK=%d Hz, %d measurements", trim.dfreq, trim.frequency, trim.measurements);
+
+  DacEspConfig config = DacESP32::getGlobalConfig();
+  config.ck8mDfreq = trim.dfreq;
+  config.ck8mFrequency = trim.frequency;
+  esp_err_t err = DacESP32::setGlobalConfig(config);
+  if (err != ESP_OK) {
+    applyDfreq(dfreq);
+    return err;
+  }
+  storeCalibration(trim.dfreq, trim.frequency);
+
+  if (result != NULL) {
+    *result = trim;
+  }
+  return err;
+}
+
+//
+// Let the CW frequency solver use the real RTC8M_CLK frequency (ck8mFrequency of
+// the global configuration). The frequency gets measured only once and is kept
+// in NVS together with the CK8M_DFREQ value it belongs to, later calls (e.g.
+// after reboot) take it from there as long as CK8M_DFREQ has not changed.
+// Parameter: remeasure...measure even if a stored value exists
+//            frequency...if not NULL receives the RTC8M_CLK frequency (Hz)
+//
+esp_err_t DacEspClock::calibrate(bool remeasure, uint32_t *frequency)
+{
+  DAC_API(DAC_API_CLOCK_CALIBRATE);
+
+  uint8_t dfreq = currentDfreq();
+  uint32_t ck8m = remeasure ? 0 : loadCalibration(dfreq);
+
+  if (ck8m == 0) {
+    if ((ck8m = measureCk8m()) == 0) {
+      return ESP_FAIL;
+    }
+    storeCalibration(dfreq, ck8m);
+  }
+  log_d("CK8M_DFREQ=%d, RTC8M_CLK=%d Hz", dfreq, ck8m);
+
+  DacEspConfig config = DacESP32::getGlobalConfig();
+  config.ck8mFrequency = ck8m;
+  if (frequency != NULL) {
+    *frequency = ck8m;
+  }
+  return DacESP32::setGlobalConfig(config);
+}
+
+//
+// Remove the RTC8M_CLK frequency stored in NVS.
+//
+void DacEspClock::clearCalibration()
+{
+  Preferences prefs;
+
+  if (prefs.begin(DAC_CLOCK_NVS_NAMESPACE, false)) {
+    prefs.remove("ck8m");
+    prefs.remove("dfreq");
+    prefs.end();
+  }
+}
+
+//
+// Get RTC8M_CLK frequency stored in NVS, 0 if none stored for this CK8M_DFREQ.
+//
+uint32_t DacEspClock::loadCalibration(uint8_t dfreq)
+{
+  Preferences prefs;
+  uint32_t ck8m = 0;
+
+  if (prefs.begin(DAC_CLOCK_NVS_NAMESPACE, true)) {
+    if (prefs.getUShort("dfreq", 0xFFFF) == dfreq) {
+      ck8m = prefs.getUInt("ck8m", 0);
+    }
+    prefs.end();
+  }
+  return ck8m;
+}
+
+void DacEspClock::storeCalibration(uint8_t dfreq, uint32_t frequency)
+{
+  Preferences prefs;
+
+  if (!prefs.begin(DAC_CLOCK_NVS_NAMESPACE, false)) {
+    log_w("NVS not available, RTC8M_CLK frequency not stored");
+    return;
+  }
+  prefs.putUShort("dfreq", dfreq);
+  prefs.putUInt("ck8m", frequency);
+  prefs.end();
+}
+
+//
+// Get current RTC_CNTL_CK8M_DFREQ.
+//
+uint8_t DacEspClock::currentDfreq()
+{
+  DAC_ENTER_CRITICAL();
+  uint32_t value = DacEspRegs::read(DAC_REG_CLK_CONF);
+  DAC_EXIT_CRITICAL();
+
+  return (value & RTC_CNTL_CK8M_DFREQ_M) >> RTC_CNTL_CK8M_DFREQ_S;
+}
+
+//
+// Set RTC_CNTL_CK8M_DFREQ.
+//
+void DacEspClock::applyDfreq(uint8_t dfreq)
+{
+  DAC_ENTER_CRITICAL();
+  DacEspRegs::setField(DAC_REG_CLK_CONF, RTC_CNTL_CK8M_DFREQ_M, (uint32_t)dfreq << RTC_CNTL_CK8M_DFREQ_S);
+  DAC_EXIT_CRITICAL();
+}
+
+//
+// Measurement function for DacEspTrimSearch.
+//
+uint32_t DacEspClock::measureAt(uint8_t dfreq, void *arg)
+{
+  applyDfreq(dfreq);
+  delayMicroseconds(DAC_CLOCK_SETTLE_US);
+
+  return measureCk8m(*(uint32_t *)arg);
+}
@@ -0,0 +1,67 @@
+/*
+  DacEspClock, RTC8M_CLK measurement & trimming for the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Measurement of the RTC8M_CLK frequency against the crystal clock
+  (rtc_clk_cal) and automatic trimming of RTC_CNTL_CK8M_DFREQ. The
+  measured frequency gets passed to the CW frequency solver, so CW
+  output frequencies get accurate without manual tuning per board.
+  Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef DacEspClock_h
+#define DacEspClock_h
+
+#include "DacESP32.h"
+#include "DacEspTrimSearch.h"
+
+//
+// definitions
+//
+// Number of RTC8M_CLK/256 cycles per measurement (~32ms with 1024).
+#ifndef DAC_CLOCK_CAL_CYCLES
+#define DAC_CLOCK_CAL_CYCLES 1024
+#endif
+// Time the oscillator needs to settle after changing CK8M_DFREQ (us).
+#define DAC_CLOCK_SETTLE_US 100
+// NVS namespace holding the measured RTC8M_CLK frequency (see calibrate()).
+#define DAC_CLOCK_NVS_NAMESPACE "DacESP32"
+
+// DacEspClock class, all members are static
+class DacEspClock
+{
+  public:
+    static uint32_t  measureCk8m(uint32_t slowClkCycles = DAC_CLOCK_CAL_CYCLES);
+    static esp_err_t autoTrim(uint32_t target = CK8M, dac_trim_result_t *result = NULL);
+    static esp_err_t calibrate(bool remeasure = false, uint32_t *frequency = NULL);
+    static void      clearCalibration(void);
+
+  private:
+    static uint32_t  measureAt(uint8_t dfreq, void *arg);
+    static uint8_t   currentDfreq(void);
+    static void      applyDfreq(uint8_t dfreq);
+    static uint32_t  loadCalibration(uint8_t dfreq);
+    static void      storeCalibration(uint8_t dfreq, uint32_t frequency);
+};
+
+#endif
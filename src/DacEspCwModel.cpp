@@ -0,0 +1,196 @@
+/*
+  DacEspCwModel, software model of the ESP32 CW generator
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Software model of the ESP32 cosine waveform (CW) generator. Integer
+  math only, no Arduino or ESP-IDF dependencies. Please see Readme.md
+  for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "DacEspCwModel.h"
+
+// register fields (ESP32), kept here so the model does not need ESP-IDF headers
+#define MODEL_CK8M_DIV_SEL_S  12
+#define MODEL_CK8M_DIV_SEL_V  0x7
+#define MODEL_SW_FSTEP_S      0
+#define MODEL_SW_FSTEP_V      0xFFFF
+#define MODEL_DAC_DC_S(ch)    ((ch) ? 8 : 0)
+#define MODEL_DAC_SCALE_S(ch) ((ch) ? 18 : 16)
+#define MODEL_DAC_INV_S(ch)   ((ch) ? 22 : 20)
+
+#define NS_PER_S 1000000000ULL
+
+// initialize static members of class
+// one cosine period, amplitude 127 (two's complement, before scaling)
+const int8_t DacEspCwModel::m_cosine[256] = {
+   127,  127,  127,  127,  126,  126,  126,  125,  125,  124,  123,  122,  122,  121,  120,  118,
+   117,  116,  115,  113,  112,  111,  109,  107,  106,  104,  102,  100,   98,   96,   94,   92,
+    90,   88,   85,   83,   81,   78,   76,   73,   71,   68,   65,   63,   60,   57,   54,   51,
+    49,   46,   43,   40,   37,   34,   31,   28,   25,   22,   19,   16,   12,    9,    6,    3,
+     0,   -3,   -6,   -9,  -12,  -16,  -19,  -22,  -25,  -28,  -31,  -34,  -37,  -40,  -43,  -46,
+   -49,  -51,  -54,  -57,  -60,  -63,  -65,  -68,  -71,  -73,  -76,  -78,  -81,  -83,  -85,  -88,
+   -90,  -92,  -94,  -96,  -98, -100, -102, -104, -106, -107, -109, -111, -112, -113, -115, -116,
+  -117, -118, -120, -121, -122, -122, -123, -124, -125, -125, -126, -126, -126, -127, -127, -127,
+  -127, -127, -127, -127, -126, -126, -126, -125, -125, -124, -123, -122, -122, -121, -120, -118,
+  -117, -116, -115, -113, -112, -111, -109, -107, -106, -104, -102, -100,  -98,  -96,  -94,  -92,
+   -90,  -88,  -85,  -83,  -81,  -78,  -76,  -73,  -71,  -68,  -65,  -63,  -60,  -57,  -54,  -51,
+   -49,  -46,  -43,  -40,  -37,  -34,  -31,  -28,  -25,  -22,  -19,  -16,  -12,   -9,   -6,   -3,
+     0,    3,    6,    9,   12,   16,   19,   22,   25,   28,   31,   34,   37,   40,   43,   46,
+    49,   51,   54,   57,   60,   63,   65,   68,   71,   73,   76,   78,   81,   83,   85,   88,
+    90,   92,   94,   96,   98,  100,  102,  104,  106,  107,  109,  111,  112,  113,  115,  116,
+   117,  118,  120,  121,  122,  122,  123,  124,  125,  125,  126,  126,  126,  127,  127,  127
+};
+
+//
+// Class constructor.
+// Parameter: config...CW generator register state
+//
+DacEspCwModel::DacEspCwModel(const dac_cw_model_config_t &config)
+{
+  setConfig(config);
+}
+
+//
+// Set new register state. Phase accumulator gets reset.
+//
+void DacEspCwModel::setConfig(const dac_cw_model_config_t &config)
+{
+  m_config = config;
+  if (m_config.ck8m == 0) {
+    m_config.ck8m = DAC_CW_MODEL_CK8M;
+  }
+  m_config.clk8mDiv &= MODEL_CK8M_DIV_SEL_V;
+  m_config.scale &= 0x3;
+  m_config.invert &= 0x3;
+  m_clock = m_config.ck8m / (1 + m_config.clk8mDiv);
+  setPhase(0);
+}
+
+//
+// Get output frequency: fcw = RTC8M_CLK / (1 + CK8M_DIV_SEL) * (SW_FSTEP / 65536)
+//
+double DacEspCwModel::getFrequency()
+{
+  return (double)m_config.ck8m / (1 + m_config.clk8mDiv) * m_config.fstep / 65536;
+}
+
+//
+// Calculate DAC code for a phase accumulator value. The cosine gets scaled
+// (arithmetic shift), the DC offset added & the sum limited to 8 bit. The
+// INV setting finally turns the two's complement value into the DAC code
+// (INV = DAC_CW_INVERT_MSB gives the usual waveform centered at VDD/2).
+// Parameter: phase...phase accumulator value (65536 = one period)
+//            clipped...set to true if the DC offset drove the value out of range
+//
+uint8_t DacEspCwModel::sample(uint16_t phase, bool *clipped)
+{
+  int32_t value = (m_cosine[phase >> 8] >> m_config.scale) + m_config.offset;
+  bool limited = true;
+
+  if (value > 127) {
+    value = 127;
+  }
+  else if (value < -128) {
+    value = -128;
+  }
+  else {
+    limited = false;
+  }
+  if (clipped != NULL) {
+    *clipped = limited;
+  }
+
+  uint8_t code = (uint8_t)value;
+  switch (m_config.invert) {
+    case 1: return code ^ 0xFF;    // DAC_CW_INVERT_ALL
+    case 2: return code ^ 0x80;    // DAC_CW_INVERT_MSB
+    case 3: return code ^ 0x7F;    // DAC_CW_INVERT_NOT_MSB
+    default: return code;          // DAC_CW_INVERT_NONE
+  }
+}
+
+//
+// Render DAC output codes into a buffer, continuing at the current phase.
+// Parameter: buffer...destination
+//            count...number of samples to render
+//            intervalNs...simulated time between two samples in ns,
+//                         0 renders one sample per generator clock
+//            stats...if not NULL receives min/max code & number of clipped samples
+// Returns number of samples rendered.
+//
+size_t DacEspCwModel::render(uint8_t *buffer, size_t count, uint32_t intervalNs, dac_cw_model_stats_t *stats)
+{
+  uint8_t  min = 0xFF, max = 0;
+  uint32_t clippedCount = 0;
+  uint64_t step = (uint64_t)intervalNs * m_clock;   // generator clocks per sample, scaled by 1e9
+
+  if (buffer == NULL) {
+    return 0;
+  }
+
+  for (size_t i = 0; i < count; i++) {
+    bool clipped;
+    uint8_t code = sample(m_phase, &clipped);
+
+    buffer[i] = code;
+    if (code < min) min = code;
+    if (code > max) max = code;
+    if (clipped) clippedCount++;
+
+    // advance phase accumulator by the generator clocks elapsed
+    uint64_t clocks;
+    if (intervalNs == 0) {
+      clocks = 1;
+    }
+    else {
+      m_remainder += step;
+      clocks = m_remainder / NS_PER_S;
+      m_remainder %= NS_PER_S;
+    }
+    m_phase = (uint16_t)(m_phase + clocks * m_config.fstep);
+  }
+
+  if (stats != NULL) {
+    stats->min = count ? min : 0;
+    stats->max = max;
+    stats->clipped = clippedCount;
+  }
+
+  return count;
+}
+
+//
+// Extract the CW generator settings of a DAC channel from raw register values
+// (RTC_CNTL_CLK_CONF_REG, SENS_SAR_DAC_CTRL1_REG & SENS_SAR_DAC_CTRL2_REG).
+// Parameter: channel...0 for DAC_CHANNEL_1, 1 for DAC_CHANNEL_2
+//
+void DacEspCwModel::configFromRegisters(uint32_t clkConf, uint32_t ctrl1, uint32_t ctrl2, int channel,
+                                        dac_cw_model_config_t *config)
+{
+  config->fstep = (ctrl1 >> MODEL_SW_FSTEP_S) & MODEL_SW_FSTEP_V;
+  config->clk8mDiv = (clkConf >> MODEL_CK8M_DIV_SEL_S) & MODEL_CK8M_DIV_SEL_V;
+  config->scale = (ctrl2 >> MODEL_DAC_SCALE_S(channel)) & 0x3;
+  config->offset = (int8_t)((ctrl2 >> MODEL_DAC_DC_S(channel)) & 0xFF);
+  config->invert = (ctrl2 >> MODEL_DAC_INV_S(channel)) & 0x3;
+  config->ck8m = DAC_CW_MODEL_CK8M;
+}
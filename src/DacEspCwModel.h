@@ -0,0 +1,86 @@
+/*
+  DacEspCwModel, software model of the ESP32 CW generator
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Software model of the ESP32 cosine waveform (CW) generator. Computes
+  the 8-bit DAC codes the generator outputs for a given register state
+  (SW_FSTEP, CK8M_DIV_SEL, SCALE, DC offset & INV mode) and renders them
+  into a buffer at a chosen simulated sample interval. Uses integer math
+  only and does not depend on Arduino or ESP-IDF, hence it can be used
+  on a host as well (e.g. to predict waveforms & clipping before
+  flashing). Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef DacEspCwModel_h
+#define DacEspCwModel_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+//
+// definitions
+//
+// Nominal RTC8M_CLK frequency (same as CK8M in DacESP32.h).
+#define DAC_CW_MODEL_CK8M 8000000UL
+
+// CW generator register state of one DAC channel
+typedef struct {
+  uint16_t fstep;           // SENS_SW_FSTEP (phase increment per generator clock)
+  uint8_t  clk8mDiv;        // RTC_CNTL_CK8M_DIV_SEL (0...7)
+  uint8_t  scale;           // SENS_DAC_SCALEx (0...3, amplitude 1/1, 1/2, 1/4, 1/8)
+  int8_t   offset;          // SENS_DAC_DCx (DC offset)
+  uint8_t  invert;          // SENS_DAC_INVx (dac_cw_invert_t / dac_cw_phase_t)
+  uint32_t ck8m;            // RTC8M_CLK frequency in Hz (0 = DAC_CW_MODEL_CK8M)
+} dac_cw_model_config_t;
+
+typedef struct {
+  uint8_t  min;             // lowest DAC code rendered
+  uint8_t  max;             // highest DAC code rendered
+  uint32_t clipped;         // samples limited by the DC offset
+} dac_cw_model_stats_t;
+
+// DacEspCwModel class
+class DacEspCwModel
+{
+  public:
+    DacEspCwModel(const dac_cw_model_config_t &config);
+    void     setConfig(const dac_cw_model_config_t &config);
+    void     setPhase(uint16_t phase) { m_phase = phase; m_remainder = 0; };
+    uint16_t getPhase(void) { return m_phase; };
+    double   getFrequency(void);
+    uint32_t getClockFrequency(void) { return m_clock; };
+    uint8_t  sample(uint16_t phase, bool *clipped = NULL);
+    size_t   render(uint8_t *buffer, size_t count, uint32_t intervalNs = 0, dac_cw_model_stats_t *stats = NULL);
+    static void configFromRegisters(uint32_t clkConf, uint32_t ctrl1, uint32_t ctrl2, int channel,
+                                    dac_cw_model_config_t *config);
+
+  private:
+    dac_cw_model_config_t m_config;
+    uint32_t m_clock;       // generator clock (RTC8M_CLK / (1 + CK8M_DIV_SEL))
+    uint16_t m_phase;       // phase accumulator
+    uint64_t m_remainder;   // fraction of a generator clock carried to next sample (in ns * Hz)
+
+    static const int8_t m_cosine[256];
+};
+
+#endif
@@ -0,0 +1,166 @@
+/*
+  DacEspCwSolver, CW generator frequency solver of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  CW generator frequency solver, no Arduino or ESP-IDF dependencies.
+  Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <stdlib.h>
+#include "DacEspCwSolver.h"
+
+// called per search step, test harnesses (extras/cwSolverFuzz) define it to check the bound
+#ifndef DAC_CW_SOLVER_ITERATION
+#define DAC_CW_SOLVER_ITERATION()
+#endif
+
+//
+// Search output frequency closest to target frequency. Integer arithmetic only,
+// fcw = ck8m * fstep / ((1 + div) * 65536) is calculated exactly (truncated).
+// Parameter: frequency...target frequency (Hz)
+//            params...clock & limits to be used, dividers not in params.divAllowed are skipped
+//            solution...receives the settings found
+// Returns false if the target frequency is out of range.
+//
+bool DacEspCwSolver::solve(uint32_t frequency, const dac_cw_solver_params_t &params, dac_cw_solution_t *solution)
+{
+  if (frequency == 0 || params.ck8m == 0) {
+    return false;
+  }
+
+  uint8_t  clk8mDiv = 0, div;
+  uint32_t frequencyStep = 0, fcw, rem, stepInt, stepRem, deltaAbs;
+
+  // delta to start with (biggest possible stepsize + 1)
+  deltaAbs = (params.ck8m >> 16) + 1;
+
+  // searching output frequency closest to target frequency
+  for (div = 0; div <= params.divMax; ) {
+    if (!DAC_CW_SOLVER_DIV_ALLOWED(params, div)) {
+      // divider reserved (see DacEspArbiter)
+      div++;
+      continue;
+    }
+    // step size ck8m / ((1 + div) * 65536) as integer part & remainder
+    uint32_t denom = (uint32_t)(1 + div) << 16;
+    stepInt = params.ck8m / denom;
+    stepRem = params.ck8m % denom;
+    fcw = rem = 0;
+    for (uint32_t fstep = 1; fstep <= params.fstepMax; fstep++) {
+      DAC_CW_SOLVER_ITERATION();
+      fcw += stepInt;
+      rem += stepRem;
+      if (rem >= denom) {
+        rem -= denom;
+        fcw++;
+      }
+      if ((uint64_t)fcw > (uint64_t)frequency + deltaAbs) {
+        // target gets out of reach (fcw >> ftarget), 64 bit as frequency + deltaAbs may exceed UINT32_MAX
+        break;
+      }
+      // calculate deviation from target frequency
+      uint32_t dtemp = (fcw > frequency) ? fcw - frequency : frequency - fcw;
+      if (dtemp < deltaAbs) {
+        // better combination found
+        deltaAbs = dtemp;
+        clk8mDiv = div;
+        frequencyStep = fstep;
+      }
+      if (deltaAbs == 0) goto end;
+    }
+
+    div++;
+    if ((int64_t)outputFrequency(params.ck8m, div, params.fstepMax) < (int64_t)frequency - deltaAbs) {
+      // target gets out of reach (fcw << ftarget)
+      break;
+    }
+  }
+end:
+
+  if (clk8mDiv == 0 && frequencyStep == 0) {
+    // no suitable combination found
+    return false;
+  }
+
+  solution->fcw = outputFrequency(params.ck8m, clk8mDiv, frequencyStep);
+  solution->deltaAbs = deltaAbs;
+  solution->stepSize = ((float)params.ck8m / (1 + clk8mDiv)) / 65536UL;
+  solution->clk8mDiv = clk8mDiv;
+  solution->frequencyStep = frequencyStep;
+
+  return true;
+}
+
+//
+// Search settings for a fractional frequency. SW_FSTEP is split into an integer
+// part & a fraction, alternating SW_FSTEP between both neighbours with a first
+// order accumulator (fraction added per update, carry selects the upper one)
+// gives the target frequency on average. The highest CK8M_DIV_SEL allowed is
+// preferred, its finer steps keep the deviation between both values small.
+// Parameter: frequencyMilliHz...target frequency (mHz)
+//            params...clock & limits to be used
+//            solution...receives the settings found
+// Returns false if the target frequency is out of range.
+//
+bool DacEspCwSolver::solveFractional(uint32_t frequencyMilliHz, const dac_cw_solver_params_t &params,
+                                     dac_cw_frac_solution_t *solution)
+{
+  uint64_t clockMilliHz = (uint64_t)params.ck8m * 1000;
+
+  if (frequencyMilliHz == 0 || params.ck8m == 0) {
+    return false;
+  }
+
+  for (int div = params.divMax; div >= 0; div--) {
+    // SW_FSTEP = f * (1 + div) * 65536 / ck8m, integer part & remainder
+    uint64_t denom = (uint64_t)(1 + div) << 16;
+    uint64_t total = frequencyMilliHz * denom;
+    uint64_t fstep = total / clockMilliHz;
+    uint64_t rem = total % clockMilliHz;
+    // 30 bit fraction, remainder < 2^34 (ck8m < 17MHz)
+    uint32_t fraction = (uint32_t)(((rem << 30) / clockMilliHz) << 2);
+
+    if (fstep == 0 || fstep + (fraction ? 1 : 0) > params.fstepMax || !DAC_CW_SOLVER_DIV_ALLOWED(params, div)) {
+      continue;
+    }
+
+    solution->clk8mDiv = div;
+    solution->frequencyStep = fstep;
+    solution->fraction = fraction;
+    solution->fcwMilliHz = (uint32_t)((fstep * clockMilliHz + (((fraction >> 4) * clockMilliHz) >> 28)) / denom);
+    return true;
+  }
+
+  return false;
+}
+
+//
+// Output frequency of a CW generator setting (Hz, truncated).
+// Parameter: ck8m...RTC8M_CLK frequency (Hz)
+//            clk8mDiv...RTC_CNTL_CK8M_DIV_SEL
+//            frequencyStep...SENS_SW_FSTEP
+//
+uint32_t DacEspCwSolver::outputFrequency(uint32_t ck8m, uint8_t clk8mDiv, uint16_t frequencyStep)
+{
+  return (uint32_t)(((uint64_t)ck8m * frequencyStep) / ((uint32_t)(1 + clk8mDiv) << 16));
+}
@@ -0,0 +1,75 @@
+/*
+  DacEspCwSolver, CW generator frequency solver of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Search of the CW generator settings (CK8M_DIV_SEL & SW_FSTEP) closest
+  to a target frequency, as used by DacESP32::setCwFrequency(). Plain
+  C++ without Arduino or ESP-IDF dependencies, hence the very same code
+  can be run on a host (e.g. to generate frequency tables). Please see
+  Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef DacEspCwSolver_h
+#define DacEspCwSolver_h
+
+#include <stdint.h>
+
+// solver parameters (DacESP32 uses CK8M, CK8M_DIV_MAX or 0 & SW_FSTEP_MAX)
+typedef struct {
+  uint32_t ck8m;            // assumed RTC8M_CLK frequency in Hz
+  uint8_t  divMax;          // highest CK8M_DIV_SEL allowed
+  uint16_t fstepMax;        // highest SW_FSTEP allowed
+  uint8_t  divAllowed;      // CK8M_DIV_SEL values allowed, bit per divider (0 = all up to divMax)
+} dac_cw_solver_params_t;
+
+// CK8M_DIV_SEL value usable with the given parameters
+#define DAC_CW_SOLVER_DIV_ALLOWED(params, div) (!(params).divAllowed || ((params).divAllowed & (1U << (div))))
+
+// solver result
+typedef struct {
+  uint32_t fcw;             // resulting output frequency (Hz, truncated)
+  uint32_t deltaAbs;        // abs(fcw - ftarget)
+  float    stepSize;        // frequency step size (Hz) with this CK8M_DIV_SEL
+  uint8_t  clk8mDiv;        // RTC_CNTL_CK8M_DIV_SEL
+  uint16_t frequencyStep;   // SENS_SW_FSTEP
+} dac_cw_solution_t;
+
+// fractional solver result, two adjacent SW_FSTEP values alternating give the average frequency
+typedef struct {
+  uint32_t fcwMilliHz;      // resulting average output frequency (mHz, truncated)
+  uint8_t  clk8mDiv;        // RTC_CNTL_CK8M_DIV_SEL
+  uint16_t frequencyStep;   // lower SENS_SW_FSTEP, the upper one is frequencyStep + 1
+  uint32_t fraction;        // share of the upper SENS_SW_FSTEP (2^32 = 1)
+} dac_cw_frac_solution_t;
+
+// DacEspCwSolver class, all members are static
+class DacEspCwSolver
+{
+  public:
+    static bool     solve(uint32_t frequency, const dac_cw_solver_params_t &params, dac_cw_solution_t *solution);
+    static bool     solveFractional(uint32_t frequencyMilliHz, const dac_cw_solver_params_t &params,
+                                    dac_cw_frac_solution_t *solution);
+    static uint32_t outputFrequency(uint32_t ck8m, uint8_t clk8mDiv, uint16_t frequencyStep);
+};
+
+#endif
@@ -0,0 +1,213 @@
+/*
+  DacEspDrift, RTC8M_CLK drift compensation for the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  RTC8M_CLK drift compensation. Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "DacEspDrift.h"
+#include "DacEspClock.h"
+#include "DacEspIsr.h"
+#include "DacEspFrac.h"
+#include "DacEspRegs.h"
+#include "DacEspProfile.h"
+#include "DacEspArbiter.h"
+
+// initialize static members of class
+dac_drift_config_t DacEspDrift::m_config = DAC_DRIFT_CONFIG_DEFAULT();
+uint32_t           DacEspDrift::m_ck8mRef = 0;
+TaskHandle_t       DacEspDrift::m_task = NULL;
+volatile bool      DacEspDrift::m_stop = false;
+dac_drift_stats_t  DacEspDrift::m_stats = { 0, 0, 0, 0, 0, 0 };
+
+//
+// Start compensator task. The RTC8M_CLK frequency of the global configuration
+// (ck8mFrequency, e.g. set by DacEspClock::calibrate()) is the starting point.
+// Parameter: config.....see dac_drift_config_t, DAC_DRIFT_CONFIG_DEFAULT()
+//            core.......CPU core the task gets pinned to (0/1)
+//            priority...FreeRTOS priority of the task
+//
+esp_err_t DacEspDrift::begin(const dac_drift_config_t &config, BaseType_t core, UBaseType_t priority)
+{
+  if (m_task != NULL) {
+    log_e("drift compensation already running");
+    return ESP_ERR_INVALID_STATE;
+  }
+  if (config.periodMs == 0 || (config.temperature == NULL && config.calCycles == 0)) {
+    log_e("invalid configuration");
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  m_config = config;
+  m_ck8mRef = DacESP32::getGlobalConfig().ck8mFrequency;
+  if (m_ck8mRef == 0) {
+    m_ck8mRef = CK8M;
+  }
+  memset(&m_stats, 0, sizeof(m_stats));
+  m_stats.ck8m = m_stats.ck8mSolved = m_ck8mRef;
+  m_stop = false;
+
+  if (xTaskCreatePinnedToCore(driftTask, "DacEspDrift", DAC_DRIFT_STACK_SIZE, NULL,
+                              priority, &m_task, core) != pdPASS) {
+    log_e("drift compensation task could not be created");
+    m_task = NULL;
+    return ESP_ERR_NO_MEM;
+  }
+
+  return ESP_OK;
+}
+
+//
+// Stop compensator task. The settings applied last stay in effect.
+//
+esp_err_t DacEspDrift::end()
+{
+  if (m_task == NULL) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  m_stop = true;
+  xTaskNotifyGive(m_task);
+  while (m_task != NULL) {
+    vTaskDelay(1);
+  }
+
+  return ESP_OK;
+}
+
+//
+// One compensation step, called periodically by the task (can be called
+// directly instead of running the task). Usually only one measurement and
+// a comparison, solving happens only if the clock moved more than the
+// threshold. The new setting gets applied only if it beats the current one
+// (at the new clock) by more than hysteresisHz, hence a clock wobbling
+// between two settings does not toggle the output frequency.
+// Nothing gets done while DacEspFrac is running (it alternates SW_FSTEP &
+// owns the frequency registers), ESP_ERR_INVALID_STATE is returned then.
+//
+esp_err_t DacEspDrift::check()
+{
+  DAC_API(DAC_API_DRIFT);
+
+  if (DacEspFrac::isRunning()) {
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  uint32_t ck8m = currentCk8m();
+  if (ck8m == 0) {
+    return ESP_FAIL;
+  }
+
+  m_stats.checks++;
+  m_stats.ck8m = ck8m;
+
+  uint32_t target = DacESP32::m_cwFrequency;
+  DAC_ENTER_CRITICAL();
+  uint8_t  clk8mDiv = (DacEspRegs::read(DAC_REG_CLK_CONF) & RTC_CNTL_CK8M_DIV_SEL_M) >> RTC_CNTL_CK8M_DIV_SEL_S;
+  uint16_t frequencyStep = (DacEspRegs::read(DAC_REG_CTRL1) & SENS_SW_FSTEP_M) >> SENS_SW_FSTEP_S;
+  DAC_EXIT_CRITICAL();
+  uint32_t fcw = DacEspCwSolver::outputFrequency(ck8m, clk8mDiv, frequencyStep);
+  m_stats.errorHz = (int32_t)(fcw - target);
+
+  uint32_t deltaPpm = (uint32_t)(((uint64_t)abs((int32_t)(ck8m - m_stats.ck8mSolved)) * 1000000UL) / m_stats.ck8mSolved);
+  if (deltaPpm <= m_config.thresholdPpm) {
+    return ESP_OK;
+  }
+
+  // clock moved, solver works with the new value from now on
+  DacEspConfig config = DacESP32::getGlobalConfig();
+  config.ck8mFrequency = ck8m;
+  esp_err_t result = DacESP32::setGlobalConfig(config);
+  if (result != ESP_OK) {
+    return result;
+  }
+
+  if (target == 0 || frequencyStep == 0) {
+    // CW generator not in use
+    return ESP_OK;
+  }
+
+  dac_cw_setting_t setting;
+  if ((result = DacESP32::solveCwFrequency(target, &setting)) != ESP_OK) {
+    return result;
+  }
+  m_stats.resolves++;
+  if (setting.clk8mDiv == clk8mDiv && setting.frequencyStep == frequencyStep) {
+    // setting in use is the one solved with the new clock
+    m_stats.ck8mSolved = ck8m;
+    return ESP_OK;
+  }
+  uint32_t fcwNew = DacEspCwSolver::outputFrequency(ck8m, setting.clk8mDiv, setting.frequencyStep);
+  uint32_t errCur = (uint32_t)abs((int32_t)(fcw - target));
+  uint32_t errNew = (uint32_t)abs((int32_t)(fcwNew - target));
+  log_d("RTC8M_CLK=%d Hz (%d ppm), fcw=%d -> %d Hz, target=%d Hz", ck8m, deltaPpm, fcw, fcwNew, target);
+
+  if (errNew + m_config.hysteresisHz < errCur) {
+    if ((result = DacEspIsr::setCwFrequency(setting)) != ESP_OK) {
+      return result;
+    }
+    DacEspArbiter::checkDivider();
+    m_stats.applied++;
+    m_stats.ck8mSolved = ck8m;
+    m_stats.errorHz = (int32_t)(fcwNew - target);
+  }
+
+  return ESP_OK;
+}
+
+//
+// Get counters & last values.
+//
+void DacEspDrift::getStats(dac_drift_stats_t *stats)
+{
+  *stats = m_stats;
+}
+
+//
+// Measure RTC8M_CLK or estimate it from the temperature input.
+//
+uint32_t DacEspDrift::currentCk8m()
+{
+  if (m_config.temperature != NULL) {
+    float t = m_config.temperature(m_config.arg);
+    return (uint32_t)(m_ck8mRef * (1.0f + m_config.tempCoeffPpm * (t - m_config.tempRef) * 1e-6f));
+  }
+  return DacEspClock::measureCk8m(m_config.calCycles);
+}
+
+//
+// Compensator task, runs check() every periodMs.
+//
+void DacEspDrift::driftTask(void *arg)
+{
+  TickType_t period = pdMS_TO_TICKS(m_config.periodMs);
+
+  while (!m_stop) {
+    check();
+    // wakes up early when end() gets called
+    ulTaskNotifyTake(pdTRUE, period ? period : 1);
+  }
+
+  m_task = NULL;
+  vTaskDelete(NULL);
+}
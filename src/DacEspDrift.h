@@ -0,0 +1,89 @@
+/*
+  DacEspDrift, RTC8M_CLK drift compensation for the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Optional background task compensating RTC8M_CLK drift (e.g. caused by
+  temperature changes). The clock gets re-measured periodically (or
+  estimated from a temperature input), the CW generator settings are
+  solved again and applied only if the clock moved more than a threshold
+  and the new setting improves the output frequency noticeably.
+  Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef DacEspDrift_h
+#define DacEspDrift_h
+
+#include "DacESP32.h"
+
+//
+// definitions
+//
+#define DAC_DRIFT_STACK_SIZE 3072
+
+// temperature input (°C), see dac_drift_config_t
+typedef float (*dac_drift_temp_t)(void *arg);
+
+typedef struct {
+  uint32_t         periodMs;      // check interval (ms)
+  uint32_t         thresholdPpm;  // re-solve if RTC8M_CLK moved more than this since last solve
+  uint32_t         hysteresisHz;  // apply new setting only if it reduces the output error by more than this
+  uint16_t         calCycles;     // RTC8M_CLK/256 cycles per measurement (256 = ~8ms, ~3ppm resolution)
+  dac_drift_temp_t temperature;   // if set, RTC8M_CLK gets estimated from temperature instead of measured
+  void            *arg;           // argument passed to temperature()
+  float            tempCoeffPpm;  // RTC8M_CLK change per °C (ppm, temperature input only)
+  float            tempRef;       // temperature at which ck8mFrequency of the global configuration was valid
+} dac_drift_config_t;
+
+typedef struct {
+  uint32_t checks;          // clock checks done
+  uint32_t resolves;        // threshold exceeded, settings solved again
+  uint32_t applied;         // new settings written to the registers
+  uint32_t ck8m;            // last RTC8M_CLK frequency measured/estimated (Hz)
+  uint32_t ck8mSolved;      // RTC8M_CLK frequency the current settings were solved with (Hz)
+  int32_t  errorHz;         // output frequency - target with last clock value (Hz)
+} dac_drift_stats_t;
+
+#define DAC_DRIFT_CONFIG_DEFAULT() { 1000, 50, 2, 256, NULL, NULL, 0, 25 }
+
+// DacEspDrift class, all members are static (one compensator for both channels)
+class DacEspDrift
+{
+  public:
+    static esp_err_t begin(const dac_drift_config_t &config, BaseType_t core = 0, UBaseType_t priority = 1);
+    static esp_err_t end(void);
+    static bool      isRunning(void) { return m_task != NULL; };
+    static esp_err_t check(void);
+    static void      getStats(dac_drift_stats_t *stats);
+
+  private:
+    static uint32_t  currentCk8m(void);
+    static void      driftTask(void *arg);
+
+    static dac_drift_config_t m_config;
+    static uint32_t           m_ck8mRef;   // RTC8M_CLK at tempRef (temperature input)
+    static TaskHandle_t       m_task;      // compensator task
+    static volatile bool      m_stop;      // compensator task shall terminate
+    static dac_drift_stats_t  m_stats;
+};
+
+#endif
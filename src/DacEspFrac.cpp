@@ -0,0 +1,182 @@
+/*
+  DacEspFrac, fractional CW frequencies for the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Fractional CW frequencies. Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "DacEspFrac.h"
+#include "DacEspIsr.h"
+#include "DacEspRegs.h"
+#include "DacEspProfile.h"
+#include "DacEspArbiter.h"
+
+// The update runs in interrupt context if esp_timer supports it (otherwise
+// in the esp_timer task).
+#if CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+#define FRAC_DISPATCH         ESP_TIMER_ISR
+#define FRAC_ENTER_CRITICAL() DAC_ENTER_CRITICAL_ISR()
+#define FRAC_EXIT_CRITICAL()  DAC_EXIT_CRITICAL_ISR()
+#else
+#define FRAC_DISPATCH         ESP_TIMER_TASK
+#define FRAC_ENTER_CRITICAL() DAC_ENTER_CRITICAL()
+#define FRAC_EXIT_CRITICAL()  DAC_EXIT_CRITICAL()
+#endif
+
+// initialize static members of class, read by the timer callback (kept in DRAM)
+esp_timer_handle_t     DacEspFrac::m_timer = NULL;
+dac_cw_frac_solution_t DacEspFrac::m_solution = { 0, 0, 0, 0 };
+DRAM_ATTR uint32_t     DacEspFrac::m_fstep[2] = { 0, 0 };
+DRAM_ATTR uint32_t     DacEspFrac::m_fraction = 0;
+DRAM_ATTR uint32_t     DacEspFrac::m_accumulator = 0;
+bool                   DacEspFrac::m_running = false;
+
+//
+// Start output of a fractional CW frequency (CW generator must be enabled on
+// the channel(s) as usual, e.g. with outputCW()). Uses the global configuration.
+// Don't call setCwFrequency() while running, stop() first.
+// Parameter: frequencyMilliHz...target frequency (mHz)
+//            periodUs...update interval of SW_FSTEP (us)
+//
+esp_err_t DacEspFrac::start(uint32_t frequencyMilliHz, uint32_t periodUs)
+{
+  DAC_API(DAC_API_FRAC_START);
+
+  dac_cw_frac_solution_t solution;
+  esp_err_t result;
+
+  if (periodUs < DAC_FRAC_PERIOD_MIN_US) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if ((result = solve(frequencyMilliHz, &solution)) != ESP_OK) {
+    return result;
+  }
+  if (m_running) {
+    halt();
+  }
+
+  log_d("ftarget=%d mHz, fcw=%d mHz, clk8mDiv=%d, frequencyStep=%d + %u/2^32", frequencyMilliHz,
+        solution.fcwMilliHz, solution.clk8mDiv, solution.frequencyStep, solution.fraction);
+
+  // lower SW_FSTEP & divider first, the timer only swaps SW_FSTEP
+  dac_cw_setting_t setting = { (frequencyMilliHz + 500) / 1000, solution.clk8mDiv, solution.frequencyStep };
+  if ((result = DacEspIsr::setCwFrequency(setting)) != ESP_OK) {
+    return result;
+  }
+  DacEspArbiter::checkDivider();
+
+  m_solution = solution;
+  m_fstep[0] = (uint32_t)solution.frequencyStep << SENS_SW_FSTEP_S;
+  m_fstep[1] = (uint32_t)(solution.frequencyStep + 1) << SENS_SW_FSTEP_S;
+  m_fraction = solution.fraction;
+  m_accumulator = 0;
+
+  if (m_fraction == 0) {
+    // exact, nothing to alternate
+    m_running = true;
+    return ESP_OK;
+  }
+
+  if (m_timer == NULL) {
+    esp_timer_create_args_t args = {};
+    args.callback = onTimer;
+    args.dispatch_method = FRAC_DISPATCH;
+    args.name = "DacEspFrac";
+    if ((result = esp_timer_create(&args, &m_timer)) != ESP_OK) {
+      log_e("fractional timer could not be created (%d)", result);
+      return result;
+    }
+  }
+  if ((result = esp_timer_start_periodic(m_timer, periodUs)) != ESP_OK) {
+    log_e("fractional timer could not be started (%d)", result);
+    return result;
+  }
+  m_running = true;
+
+  return ESP_OK;
+}
+
+//
+// Stop alternating, the SW_FSTEP value closest to the target stays.
+//
+esp_err_t DacEspFrac::stop()
+{
+  DAC_API(DAC_API_FRAC_STOP);
+
+  if (!m_running) {
+    return ESP_ERR_INVALID_STATE;
+  }
+  halt();
+
+  return ESP_OK;
+}
+
+//
+// Stop the timer & set the SW_FSTEP value closest to the target (used by
+// start() as well, hence not tagged).
+//
+void DacEspFrac::halt()
+{
+  if (m_fraction != 0) {
+    esp_timer_stop(m_timer);
+  }
+  m_running = false;
+
+  FRAC_ENTER_CRITICAL();
+  DacEspRegs::setField(DAC_REG_CTRL1, SENS_SW_FSTEP_M, m_fstep[m_fraction >= 0x80000000UL]);
+  FRAC_EXIT_CRITICAL();
+}
+
+//
+// Search settings for a fractional frequency with the global configuration,
+// no register gets changed.
+// Parameter: frequencyMilliHz...target frequency (mHz)
+//            solution...receives the settings found
+//
+esp_err_t DacEspFrac::solve(uint32_t frequencyMilliHz, dac_cw_frac_solution_t *solution)
+{
+  dac_cw_solver_params_t params = DacESP32::m_global.solver;
+
+  params.divAllowed = DacEspArbiter::getAllowed();
+  if (!DacEspCwSolver::solveFractional(frequencyMilliHz, params, solution)) {
+    log_e("invalid parameter: frequency (%d mHz) out of range", frequencyMilliHz);
+    return ESP_ERR_INVALID_ARG;
+  }
+  return ESP_OK;
+}
+
+//
+// Timer callback: add fraction, the carry selects lower or upper SW_FSTEP.
+//
+void IRAM_ATTR DacEspFrac::onTimer(void *arg)
+{
+  DAC_API(DAC_API_FRAC_TIMER);
+
+  uint32_t accumulator = m_accumulator + m_fraction;
+  uint32_t carry = accumulator < m_accumulator;
+  m_accumulator = accumulator;
+
+  FRAC_ENTER_CRITICAL();
+  DacEspRegs::setField(DAC_REG_CTRL1, SENS_SW_FSTEP_M, m_fstep[carry]);
+  FRAC_EXIT_CRITICAL();
+}
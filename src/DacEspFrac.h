@@ -0,0 +1,71 @@
+/*
+  DacEspFrac, fractional CW frequencies for the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Fractional CW frequencies. SW_FSTEP only allows frequencies in steps of
+  RTC8M_CLK / (1 + CK8M_DIV_SEL) / 65536. A periodic timer alternates
+  SW_FSTEP between the two values next to the target, controlled by a
+  first order accumulator, hence the average output frequency hits the
+  target within a few mHz.
+  Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef DacEspFrac_h
+#define DacEspFrac_h
+
+#include "DacESP32.h"
+#include "esp_timer.h"
+
+//
+// definitions
+//
+// Default update interval in us (esp_timer allows >= 50us). Shorter intervals
+// move the dithering spurs further away from the carrier.
+#ifndef DAC_FRAC_PERIOD_US
+#define DAC_FRAC_PERIOD_US 100
+#endif
+#define DAC_FRAC_PERIOD_MIN_US 50
+
+// DacEspFrac class, all members are static (frequency is common to both channels)
+class DacEspFrac
+{
+  public:
+    static esp_err_t start(uint32_t frequencyMilliHz, uint32_t periodUs = DAC_FRAC_PERIOD_US);
+    static esp_err_t stop(void);
+    static bool      isRunning(void) { return m_running; };
+    static esp_err_t solve(uint32_t frequencyMilliHz, dac_cw_frac_solution_t *solution);
+    static const dac_cw_frac_solution_t &getSolution(void) { return m_solution; };
+
+  private:
+    static void      halt(void);
+    static void      onTimer(void *arg);
+
+    static esp_timer_handle_t     m_timer;       // periodic update timer
+    static dac_cw_frac_solution_t m_solution;    // settings in use
+    static uint32_t               m_fstep[2];    // SW_FSTEP field values (lower, upper), already shifted
+    static uint32_t               m_fraction;    // accumulator increment
+    static uint32_t               m_accumulator; // first order accumulator
+    static bool                   m_running;     // fractional mode active
+};
+
+#endif
@@ -0,0 +1,170 @@
+/*
+  DacEspGoertzel, single frequency DFT of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Single bin DFT (Goertzel algorithm) evaluating amplitude & phase of one
+  frequency in a block of ADC samples, e.g. captured by DacEspAnalyzer.
+  Much cheaper than a full FFT if only the stimulus frequency matters.
+  No Arduino or ESP-IDF dependencies, testable on a host.
+  Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <math.h>
+#include "DacEspGoertzel.h"
+
+static inline bool matches(uint16_t word, int channel)
+{
+  return channel == DAC_GOERTZEL_ANY_CHANNEL || (word >> DAC_GOERTZEL_CHANNEL_S) == channel;
+}
+
+static inline float wrapPhase(float degree)
+{
+  degree = fmodf(degree, 360.0f);
+  if (degree > 180.0f) {
+    degree -= 360.0f;
+  } else if (degree <= -180.0f) {
+    degree += 360.0f;
+  }
+  return degree;
+}
+
+//
+// Evaluate one frequency in the samples of an ADC channel (generalized
+// Goertzel algorithm, frequency does not need to be a DFT bin). The DC level
+// is removed first. Best results with a whole number of cycles in the block
+// (see coherentLength()).
+// Parameter: words...I2S ADC sample words
+//            count...number of words
+//            channel...ADC1 channel of the samples to use, other words are
+//                      skipped (DAC_GOERTZEL_ANY_CHANNEL: all)
+//            sampleRate...sample rate of this channel (Hz)
+//            frequency...frequency to evaluate (Hz)
+//            tone...receives amplitude & phase
+// Returns false if there are less than 2 samples or frequency is not below
+// the Nyquist frequency.
+//
+bool DacEspGoertzel::tone(const uint16_t *words, size_t count, int channel, float sampleRate, float frequency,
+                          dac_goertzel_tone_t *tone)
+{
+  uint32_t n = 0;
+  float sum = 0;
+
+  if (sampleRate <= 0 || frequency <= 0 || frequency >= sampleRate / 2) {
+    return false;
+  }
+  for (size_t i = 0; i < count; i++) {
+    if (matches(words[i], channel)) {
+      sum += words[i] & DAC_GOERTZEL_VALUE_M;
+      n++;
+    }
+  }
+  if (n < 2) {
+    return false;
+  }
+
+  float mean = sum / n;
+  float w = 2.0f * (float)M_PI * frequency / sampleRate;
+  float c = cosf(w), s = sinf(w), coeff = 2.0f * c;
+  float s1 = 0, s2 = 0;
+  for (size_t i = 0; i < count; i++) {
+    if (matches(words[i], channel)) {
+      float s0 = ((words[i] & DAC_GOERTZEL_VALUE_M) - mean) + coeff * s1 - s2;
+      s2 = s1;
+      s1 = s0;
+    }
+  }
+
+  // y = s1 - s2 * e^-jw equals X(w) * e^jw(n-1), rotate back to the first sample
+  float yr = s1 - s2 * c;
+  float yi = s2 * s;
+  float back = (float)fmod((double)w * (n - 1), 2.0 * M_PI);
+  float xr = yr * cosf(back) + yi * sinf(back);
+  float xi = yi * cosf(back) - yr * sinf(back);
+
+  tone->amplitude = 2.0f * sqrtf(xr * xr + xi * xi) / n;
+  tone->phase = wrapPhase(atan2f(xi, xr) * 180.0f / (float)M_PI);
+  tone->mean = mean;
+  tone->samples = n;
+  return true;
+}
+
+//
+// Evaluate one frequency in reference & response channel, sampled
+// alternately by the ADC (I2S ADC pattern table with both channels). Words
+// before the first reference sample are skipped. The response sample of a
+// pair is taken 1 / sampleRate after the reference one, its phase gets
+// corrected for that.
+// Parameter: words...I2S ADC sample words, channels alternating
+//            count...number of words
+//            refChannel, respChannel...ADC1 channels
+//            sampleRate...ADC conversion rate (Hz, both channels together)
+//            frequency...frequency to evaluate (Hz)
+//            response...receives both tones, gain & phase difference
+// Returns false if a channel has less than 2 samples or frequency is not
+// below the Nyquist frequency of a channel.
+//
+bool DacEspGoertzel::response(const uint16_t *words, size_t count, int refChannel, int respChannel,
+                              float sampleRate, float frequency, dac_goertzel_response_t *response)
+{
+  size_t start = 0;
+
+  while (start < count && !matches(words[start], refChannel)) {
+    start++;
+  }
+  // whole pairs only, both channels get the same number of samples
+  count = start + ((count - start) & ~(size_t)1);
+  if (!tone(words + start, count - start, refChannel, sampleRate / 2, frequency, &response->reference) ||
+      !tone(words + start, count - start, respChannel, sampleRate / 2, frequency, &response->response)) {
+    return false;
+  }
+
+  response->response.phase = wrapPhase(response->response.phase - 360.0f * frequency / sampleRate);
+  response->gainDb = (response->reference.amplitude > 0 && response->response.amplitude > 0) ?
+                     20.0f * log10f(response->response.amplitude / response->reference.amplitude) : -INFINITY;
+  response->phase = wrapPhase(response->response.phase - response->reference.phase);
+  return true;
+}
+
+//
+// Number of samples holding a whole number of cycles of a frequency (as
+// many as fit into maxSamples), which avoids leakage of the DC level and
+// of noise into the evaluated frequency. Returns maxSamples if not even one
+// cycle fits.
+// Parameter: sampleRate...sample rate (Hz)
+//            frequency...frequency to evaluate (Hz)
+//            maxSamples...buffer size
+//
+uint32_t DacEspGoertzel::coherentLength(float sampleRate, float frequency, uint32_t maxSamples)
+{
+  if (sampleRate <= 0 || frequency <= 0) {
+    return maxSamples;
+  }
+  double period = (double)sampleRate / frequency;
+  uint32_t cycles = (uint32_t)(maxSamples / period);
+  if (cycles == 0) {
+    return maxSamples;
+  }
+  uint32_t samples = (uint32_t)(cycles * period + 0.5);
+  return (samples > maxSamples) ? maxSamples : samples;
+}
@@ -0,0 +1,75 @@
+/*
+  DacEspGoertzel, single frequency DFT of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Single bin DFT (Goertzel algorithm) evaluating amplitude & phase of one
+  frequency in a block of ADC samples, e.g. captured by DacEspAnalyzer.
+  Much cheaper than a full FFT if only the stimulus frequency matters.
+  No Arduino or ESP-IDF dependencies, testable on a host.
+  Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef DacEspGoertzel_h
+#define DacEspGoertzel_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+//
+// definitions
+//
+// I2S ADC sample words: ADC1 channel in bits 12...15, 12-bit value in bits 0...11.
+#define DAC_GOERTZEL_CHANNEL_S   12
+#define DAC_GOERTZEL_VALUE_M     0x0FFF
+// channel argument accepting every sample word (untagged data)
+#define DAC_GOERTZEL_ANY_CHANNEL -1
+
+// single frequency component of a signal
+typedef struct {
+  float    amplitude;       // peak amplitude (ADC counts)
+  float    phase;           // phase at the first sample (degree, -180...180)
+  float    mean;            // DC level (ADC counts)
+  uint32_t samples;         // samples evaluated
+} dac_goertzel_tone_t;
+
+// transfer function at one frequency, response relative to reference
+typedef struct {
+  dac_goertzel_tone_t reference;
+  dac_goertzel_tone_t response;
+  float    gainDb;          // 20 * log10(response / reference amplitude)
+  float    phase;           // response - reference phase (degree, -180...180)
+} dac_goertzel_response_t;
+
+// DacEspGoertzel class, all members are static
+class DacEspGoertzel
+{
+  public:
+    static bool     tone(const uint16_t *words, size_t count, int channel, float sampleRate, float frequency,
+                         dac_goertzel_tone_t *tone);
+    static bool     response(const uint16_t *words, size_t count, int refChannel, int respChannel,
+                             float sampleRate, float frequency, dac_goertzel_response_t *response);
+    static uint32_t coherentLength(float sampleRate, float frequency, uint32_t maxSamples);
+};
+
+#endif
@@ -0,0 +1,174 @@
+/*
+  DacEspHal, host emulation of DAC related registers
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Emulated register file & DAC pad driver functions used when the
+  library gets built on a host with DACESP32_HOST_EMULATION defined.
+  Compiles to nothing for the ESP32. Please see Readme.md for more
+  details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "DacESP32.h"
+
+#ifdef DACESP32_HOST_EMULATION
+
+#include <string.h>
+#include <chrono>
+
+// initialize static members of class
+uint32_t DacEspHal::m_rtcCntl[DAC_HAL_BLOCK_SIZE / 4] = { 0 };
+uint32_t DacEspHal::m_sens[DAC_HAL_BLOCK_SIZE / 4] = { 0 };
+uint32_t DacEspHal::m_rtcIo[DAC_HAL_BLOCK_SIZE / 4] = { 0 };
+uint32_t DacEspHal::m_reads = 0;
+uint32_t DacEspHal::m_writes = 0;
+dac_hal_write_hook_t DacEspHal::m_hook = NULL;
+void    *DacEspHal::m_hookArg = NULL;
+
+//
+// Map a register address to its location in the emulated register file.
+// Returns NULL for addresses outside the emulated peripherals.
+//
+uint32_t *DacEspHal::locate(uint32_t addr)
+{
+  if (addr & 3) {
+    return NULL;
+  }
+  if (addr >= DR_REG_RTCCNTL_BASE && addr < DR_REG_RTCCNTL_BASE + DAC_HAL_BLOCK_SIZE) {
+    return &m_rtcCntl[(addr - DR_REG_RTCCNTL_BASE) / 4];
+  }
+  if (addr >= DR_REG_SENS_BASE && addr < DR_REG_SENS_BASE + DAC_HAL_BLOCK_SIZE) {
+    return &m_sens[(addr - DR_REG_SENS_BASE) / 4];
+  }
+  if (addr >= DR_REG_RTCIO_BASE && addr < DR_REG_RTCIO_BASE + DAC_HAL_BLOCK_SIZE) {
+    return &m_rtcIo[(addr - DR_REG_RTCIO_BASE) / 4];
+  }
+  return NULL;
+}
+
+//
+// Read an emulated register. Unknown addresses read as 0.
+//
+uint32_t DacEspHal::read(uint32_t addr)
+{
+  uint32_t *reg = locate(addr);
+
+  m_reads++;
+  if (reg == NULL) {
+    log_e("read from unemulated register 0x%08x", addr);
+    return 0;
+  }
+  return *reg;
+}
+
+//
+// Write an emulated register & report it to the write hook (if set).
+//
+void DacEspHal::write(uint32_t addr, uint32_t value)
+{
+  uint32_t *reg = locate(addr);
+
+  m_writes++;
+  if (reg == NULL) {
+    log_e("write to unemulated register 0x%08x", addr);
+    return;
+  }
+  *reg = value;
+  if (m_hook != NULL) {
+    m_hook(addr, value, m_hookArg);
+  }
+}
+
+//
+// Clear all emulated registers & access counters. The shadow copies of
+// DacEspRegs must be invalidated as well if the library has been used before.
+//
+void DacEspHal::reset()
+{
+  memset(m_rtcCntl, 0, sizeof(m_rtcCntl));
+  memset(m_sens, 0, sizeof(m_sens));
+  memset(m_rtcIo, 0, sizeof(m_rtcIo));
+  m_reads = m_writes = 0;
+}
+
+//
+// Install a function getting called on every register write (e.g. for
+// checking register sequences in tests). NULL removes it.
+//
+void DacEspHal::setWriteHook(dac_hal_write_hook_t hook, void *arg)
+{
+  m_hook = hook;
+  m_hookArg = arg;
+}
+
+//
+// Emulation of the ESP-IDF DAC pad driver functions used by the library.
+// Only the pad register bits the library relies on are modelled.
+//
+static uint32_t padRegOf(dac_channel_t channel)
+{
+  return (channel == DAC_CHANNEL_1) ? RTC_IO_PAD_DAC1_REG : RTC_IO_PAD_DAC2_REG;
+}
+
+esp_err_t dac_output_enable(dac_channel_t channel)
+{
+  if (channel != DAC_CHANNEL_1 && channel != DAC_CHANNEL_2) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  uint32_t reg = padRegOf(channel);
+  DacEspHal::write(reg, DacEspHal::read(reg) | RTCIO_PAD_PDAC1_MUX_SEL | RTC_IO_PDAC1_XPD_DAC | RTC_IO_PDAC1_DAC_XPD_FORCE);
+
+  return ESP_OK;
+}
+
+esp_err_t dac_output_disable(dac_channel_t channel)
+{
+  if (channel != DAC_CHANNEL_1 && channel != DAC_CHANNEL_2) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  uint32_t reg = padRegOf(channel);
+  DacEspHal::write(reg, DacEspHal::read(reg) & ~(RTC_IO_PDAC1_XPD_DAC | RTC_IO_PDAC1_DAC_XPD_FORCE));
+
+  return ESP_OK;
+}
+
+esp_err_t dac_pad_get_io_num(dac_channel_t channel, gpio_num_t *gpio_num)
+{
+  if (channel != DAC_CHANNEL_1 && channel != DAC_CHANNEL_2) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  *gpio_num = (channel == DAC_CHANNEL_1) ? (gpio_num_t)DAC_CHANNEL_1_GPIO_NUM : (gpio_num_t)DAC_CHANNEL_2_GPIO_NUM;
+
+  return ESP_OK;
+}
+
+//
+// Host replacement of the CPU cycle counter: steady clock in ns, wraps
+// around like CCOUNT (~4.3s).
+//
+uint32_t DacEspHal::ccount()
+{
+  return (uint32_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+#endif
@@ -0,0 +1,98 @@
+/*
+  DacEspHal, register access abstraction for the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Hardware abstraction seam of the DacESP32 library. All register
+  accesses of the library go through DAC_HAL_READ()/DAC_HAL_WRITE().
+  On the ESP32 they map straight to the ESP-IDF register macros. With
+  DACESP32_HOST_EMULATION defined (e.g. for a Linux build) they access
+  an emulated register file covering the RTC_CNTL, SENS and RTCIO
+  peripherals instead, so the library can be exercised without hardware.
+  Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef DacEspHal_h
+#define DacEspHal_h
+
+#include <stdint.h>
+
+#ifndef DACESP32_HOST_EMULATION
+
+// register access on target
+#define DAC_HAL_READ(addr)         READ_PERI_REG(addr)
+#define DAC_HAL_WRITE(addr, value) WRITE_PERI_REG(addr, value)
+
+// timestamps (CPU cycle counter CCOUNT) & core of the caller, used by trace & profiling
+#define DAC_HAL_CCOUNT()           dac_hal_ccount()
+#define DAC_HAL_CCOUNT_MHZ()       getCpuFrequencyMhz()
+#define DAC_HAL_CORE_ID()          xPortGetCoreID()
+
+static inline __attribute__((always_inline)) uint32_t dac_hal_ccount(void)
+{
+  uint32_t ccount;
+  __asm__ __volatile__("rsr %0, ccount" : "=a"(ccount));
+  return ccount;
+}
+
+#else
+
+// register access on host (emulated register file)
+#define DAC_HAL_READ(addr)         DacEspHal::read(addr)
+#define DAC_HAL_WRITE(addr, value) DacEspHal::write(addr, value)
+
+// timestamps on host: steady clock in ns (lower 32 bits), single core
+#define DAC_HAL_CCOUNT()           DacEspHal::ccount()
+#define DAC_HAL_CCOUNT_MHZ()       1000
+#define DAC_HAL_CORE_ID()          0
+
+// size of each emulated peripheral register block (bytes)
+#define DAC_HAL_BLOCK_SIZE 0x400
+
+typedef void (*dac_hal_write_hook_t)(uint32_t addr, uint32_t value, void *arg);
+
+// DacEspHal class, all members are static (host emulation only)
+class DacEspHal
+{
+  public:
+    static uint32_t read(uint32_t addr);
+    static void     write(uint32_t addr, uint32_t value);
+    static void     reset(void);
+    static void     setWriteHook(dac_hal_write_hook_t hook, void *arg = NULL);
+    static uint32_t getReadCount(void) { return m_reads; };
+    static uint32_t getWriteCount(void) { return m_writes; };
+    static uint32_t ccount(void);
+
+  private:
+    static uint32_t *locate(uint32_t addr);
+
+    static uint32_t m_rtcCntl[DAC_HAL_BLOCK_SIZE / 4];   // RTC_CNTL registers
+    static uint32_t m_sens[DAC_HAL_BLOCK_SIZE / 4];      // SENS registers
+    static uint32_t m_rtcIo[DAC_HAL_BLOCK_SIZE / 4];     // RTCIO registers
+    static uint32_t m_reads, m_writes;
+    static dac_hal_write_hook_t m_hook;
+    static void    *m_hookArg;
+};
+
+#endif
+
+#endif
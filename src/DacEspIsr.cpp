@@ -0,0 +1,196 @@
+/*
+  DacEspIsr, interrupt safe DAC access for the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Register level DAC operations callable from interrupt handlers. All
+  functions are placed in IRAM (usable while flash is busy), use only
+  precomputed register masks kept in DRAM, no floating point maths and
+  no logging. CW frequencies have to be solved beforehand in task context
+  with DacESP32::solveCwFrequency(). Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "DacEspIsr.h"
+#include "DacEspRegs.h"
+#include "DacEspProfile.h"
+#include "DacEspArbiter.h"
+
+#define ISR_CHANNEL_CHECK(channel)                  \
+  if ((uint32_t)channel >= DAC_CHANNEL_MAX) {       \
+    return ESP_ERR_INVALID_ARG;                     \
+  }
+
+// register addresses & masks per DAC channel, kept in DRAM
+typedef struct {
+  dac_reg_t padReg;         // DAC_REG_PAD_DACx
+  uint32_t padEnable;       // pad bits enabling DAC output
+  uint32_t padValue;        // mask of DAC value field
+  uint8_t  padValueShift;
+  uint32_t cwEnable;        // SENS_DAC_CW_ENx
+  uint32_t scale;           // mask of SENS_DAC_SCALEx
+  uint8_t  scaleShift;
+  uint32_t inv;             // mask of SENS_DAC_INVx
+  uint8_t  invShift;
+  uint32_t dc;              // mask of SENS_DAC_DCx
+  uint8_t  dcShift;
+} dac_isr_regs_t;
+
+static const DRAM_ATTR dac_isr_regs_t s_regs[DAC_CHANNEL_MAX] = {
+  { DAC_REG_PAD_DAC1, RTCIO_PAD_PDAC1_MUX_SEL | RTC_IO_PDAC1_XPD_DAC | RTC_IO_PDAC1_DAC_XPD_FORCE,
+    RTC_IO_PDAC1_DAC_M, RTC_IO_PDAC1_DAC_S, SENS_DAC_CW_EN1_M,
+    SENS_DAC_SCALE1_M, SENS_DAC_SCALE1_S, SENS_DAC_INV1_M, SENS_DAC_INV1_S, SENS_DAC_DC1_M, SENS_DAC_DC1_S },
+  { DAC_REG_PAD_DAC2, RTCIO_PAD_PDAC2_MUX_SEL | RTC_IO_PDAC2_XPD_DAC | RTC_IO_PDAC2_DAC_XPD_FORCE,
+    RTC_IO_PDAC2_DAC_M, RTC_IO_PDAC2_DAC_S, SENS_DAC_CW_EN2_M,
+    SENS_DAC_SCALE2_M, SENS_DAC_SCALE2_S, SENS_DAC_INV2_M, SENS_DAC_INV2_S, SENS_DAC_DC2_M, SENS_DAC_DC2_S }
+};
+
+//
+// Set DAC output voltage, same as DacESP32::outputVoltage(uint8_t).
+//
+esp_err_t IRAM_ATTR DacEspIsr::outputVoltage(dac_channel_t channel, uint8_t value)
+{
+  DAC_API(DAC_API_ISR_OUTPUT_VOLTAGE);
+
+  ISR_CHANNEL_CHECK(channel);
+
+  const dac_isr_regs_t &r = s_regs[channel];
+
+  DAC_ENTER_CRITICAL_ISR();
+  DacEspRegs::setField(DAC_REG_CTRL2, r.cwEnable, 0);
+  DacEspRegs::setField(r.padReg, r.padValue | r.padEnable, r.padEnable | ((uint32_t)value << r.padValueShift));
+  DAC_EXIT_CRITICAL_ISR();
+
+  return ESP_OK;
+}
+
+//
+// Select CW generator as source for DAC channel & enable DAC output.
+//
+esp_err_t IRAM_ATTR DacEspIsr::cwEnable(dac_channel_t channel)
+{
+  DAC_API(DAC_API_ISR_CW_ENABLE);
+
+  ISR_CHANNEL_CHECK(channel);
+
+  const dac_isr_regs_t &r = s_regs[channel];
+
+  DAC_ENTER_CRITICAL_ISR();
+  DacEspRegs::setField(r.padReg, r.padEnable, r.padEnable);
+  DacEspRegs::setField(DAC_REG_CTRL2, r.cwEnable, r.cwEnable);
+  DacEspRegs::setField(DAC_REG_CTRL1, SENS_SW_TONE_EN, SENS_SW_TONE_EN);
+  DAC_EXIT_CRITICAL_ISR();
+
+  return ESP_OK;
+}
+
+//
+// Deselect CW generator as source for DAC channel. CW generator gets
+// disabled if not used by the other channel either.
+//
+esp_err_t IRAM_ATTR DacEspIsr::cwDisable(dac_channel_t channel)
+{
+  DAC_API(DAC_API_ISR_CW_DISABLE);
+
+  ISR_CHANNEL_CHECK(channel);
+
+  DAC_ENTER_CRITICAL_ISR();
+  DacEspRegs::setField(DAC_REG_CTRL2, s_regs[channel].cwEnable, 0);
+  if (!(DacEspRegs::read(DAC_REG_CTRL2) & (SENS_DAC_CW_EN1_M | SENS_DAC_CW_EN2_M))) {
+    DacEspRegs::setField(DAC_REG_CTRL1, SENS_SW_TONE_EN, 0);
+  }
+  DAC_EXIT_CRITICAL_ISR();
+
+  return ESP_OK;
+}
+
+esp_err_t IRAM_ATTR DacEspIsr::setCwScale(dac_channel_t channel, dac_cw_scale_t scale)
+{
+  DAC_API(DAC_API_ISR_SET_CW_SCALE);
+
+  ISR_CHANNEL_CHECK(channel);
+
+  if ((uint32_t)scale > DAC_CW_SCALE_8) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  DAC_ENTER_CRITICAL_ISR();
+  DacEspRegs::setField(DAC_REG_CTRL2, s_regs[channel].scale, (uint32_t)scale << s_regs[channel].scaleShift);
+  DAC_EXIT_CRITICAL_ISR();
+
+  return ESP_OK;
+}
+
+esp_err_t IRAM_ATTR DacEspIsr::setCwPhase(dac_channel_t channel, dac_cw_phase_t phase)
+{
+  DAC_API(DAC_API_ISR_SET_CW_PHASE);
+
+  ISR_CHANNEL_CHECK(channel);
+
+  if (phase != DAC_CW_PHASE_0 && phase != DAC_CW_PHASE_180) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  DAC_ENTER_CRITICAL_ISR();
+  DacEspRegs::setField(DAC_REG_CTRL2, s_regs[channel].inv, (uint32_t)phase << s_regs[channel].invShift);
+  DAC_EXIT_CRITICAL_ISR();
+
+  return ESP_OK;
+}
+
+esp_err_t IRAM_ATTR DacEspIsr::setCwOffset(dac_channel_t channel, int8_t offset)
+{
+  DAC_API(DAC_API_ISR_SET_CW_OFFSET);
+
+  ISR_CHANNEL_CHECK(channel);
+
+  DAC_ENTER_CRITICAL_ISR();
+  DacEspRegs::setField(DAC_REG_CTRL2, s_regs[channel].dc, (uint32_t)(uint8_t)offset << s_regs[channel].dcShift);
+  DAC_EXIT_CRITICAL_ISR();
+
+  return ESP_OK;
+}
+
+//
+// Apply CW generator settings found by DacESP32::solveCwFrequency().
+//
+esp_err_t IRAM_ATTR DacEspIsr::setCwFrequency(const dac_cw_setting_t &setting)
+{
+  DAC_API(DAC_API_ISR_SET_CW_FREQUENCY);
+
+  if (setting.frequencyStep == 0 || setting.clk8mDiv > CK8M_DIV_MAX) {
+    return ESP_ERR_INVALID_ARG;
+  }
+  if (DacESP32::m_global.config.cwHighAccuracy && !DacEspArbiter::isAllowed(setting.clk8mDiv)) {
+    // solved before a constraint got added (see DacEspArbiter)
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  DAC_ENTER_CRITICAL_ISR();
+  if (DacESP32::m_global.config.cwHighAccuracy) {
+    DacEspRegs::setField(DAC_REG_CLK_CONF, RTC_CNTL_CK8M_DIV_SEL_M, (uint32_t)setting.clk8mDiv << RTC_CNTL_CK8M_DIV_SEL_S);
+  }
+  DacEspRegs::setField(DAC_REG_CTRL1, SENS_SW_FSTEP_M, (uint32_t)setting.frequencyStep << SENS_SW_FSTEP_S);
+  DAC_EXIT_CRITICAL_ISR();
+  DacESP32::m_cwFrequency = setting.frequency;
+
+  return ESP_OK;
+}
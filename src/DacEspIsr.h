@@ -0,0 +1,51 @@
+/*
+  DacEspIsr, interrupt safe DAC access for the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Register level DAC operations callable from interrupt handlers. All
+  functions are placed in IRAM (usable while flash is busy), use only
+  precomputed register masks kept in DRAM, no floating point maths and
+  no logging. CW frequencies have to be solved beforehand in task context
+  with DacESP32::solveCwFrequency(). Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef DacEspIsr_h
+#define DacEspIsr_h
+
+#include "DacESP32.h"
+
+// DacEspIsr class, all members are static. Invalid arguments are rejected
+// with ESP_ERR_INVALID_ARG, the channel object is not needed.
+class DacEspIsr
+{
+  public:
+    static esp_err_t outputVoltage(dac_channel_t channel, uint8_t value);
+    static esp_err_t cwEnable(dac_channel_t channel);
+    static esp_err_t cwDisable(dac_channel_t channel);
+    static esp_err_t setCwScale(dac_channel_t channel, dac_cw_scale_t scale);
+    static esp_err_t setCwPhase(dac_channel_t channel, dac_cw_phase_t phase);
+    static esp_err_t setCwOffset(dac_channel_t channel, int8_t offset);
+    static esp_err_t setCwFrequency(const dac_cw_setting_t &setting);
+};
+
+#endif
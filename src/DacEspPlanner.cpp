@@ -0,0 +1,212 @@
+/*
+  DacEspPlanner, coherent sampling planner of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Coherent sampling planner: searches CW generator settings (CK8M_DIV_SEL,
+  SW_FSTEP) near a target frequency together with ADC sample rate and
+  record length, so that a record holds a whole, coprime number of CW
+  cycles (no leakage, every sample at a different phase). No Arduino or
+  ESP-IDF dependencies.
+  Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include <math.h>
+#include "DacEspPlanner.h"
+
+static uint64_t gcd(uint64_t a, uint64_t b)
+{
+  while (b) {
+    uint64_t t = a % b;
+    a = b;
+    b = t;
+  }
+  return a;
+}
+
+static inline bool isPowerOfTwo(uint64_t n)
+{
+  return n && !(n & (n - 1));
+}
+
+//
+// Search coherent combinations of CW setting, ADC sample rate & record
+// length for a target frequency. For every CW setting within the tolerance
+// and every ADC divider the ratio fcw / sampleRate is calculated as exact
+// fraction. If its denominator is an allowed record length, sampling is
+// exactly coherent. Otherwise each allowed record length N gets the number
+// of cycles M (coprime to N) closest to coherence.
+// If the ADC is clocked by RTC8M_CLK / (1 + CK8M_DIV_SEL) as well
+// (adcClock = DAC_PLAN_ADC_CLOCK_CK8M), changing the divider for the CW
+// generator changes the sample rate too, but the ratio becomes
+// SW_FSTEP * adcDiv / 65536 and stays exact however far RTC8M_CLK drifts.
+// Effort is (settings within tolerance) * (ADC dividers) * (record lengths).
+// Parameter: frequency...target frequency (Hz)
+//            params...clock, CW & ADC limits
+//            plans...receives the best combinations, best first
+//            maxPlans...size of plans
+// Returns number of plans found.
+//
+size_t DacEspPlanner::plan(uint32_t frequency, const dac_plan_params_t &params, dac_plan_t *plans, size_t maxPlans)
+{
+  size_t count = 0;
+
+  if (frequency == 0 || params.ck8m == 0 || plans == NULL || maxPlans == 0 || params.adcDivMin == 0 ||
+      params.adcDivMin > params.adcDivMax || params.recordMin < 2 || params.recordMin > params.recordMax) {
+    return 0;
+  }
+
+  for (uint32_t div = 0; div <= params.divMax; div++) {
+    uint64_t denom = (uint64_t)(1 + div) << 16;
+    uint64_t lo, hi;
+
+    // SW_FSTEP values within tolerance, otherwise the nearest one
+    if (params.toleranceHz) {
+      uint64_t fLow = (frequency > params.toleranceHz) ? frequency - params.toleranceHz : 0;
+      lo = (fLow * denom + params.ck8m - 1) / params.ck8m;
+      hi = ((uint64_t)frequency + params.toleranceHz) * denom / params.ck8m;
+    } else {
+      lo = hi = ((uint64_t)frequency * denom + params.ck8m / 2) / params.ck8m;
+    }
+    if (lo < 1) {
+      lo = 1;
+    }
+    if (hi > params.fstepMax) {
+      hi = params.fstepMax;
+    }
+
+    for (uint64_t fstep = lo; fstep <= hi; fstep++) {
+      dac_plan_t candidate;
+      candidate.clk8mDiv = div;
+      candidate.frequencyStep = fstep;
+      candidate.fcw = (double)params.ck8m * fstep / denom;
+      double clock = (params.adcClock == DAC_PLAN_ADC_CLOCK_CK8M) ? (double)params.ck8m / (1 + div) : params.adcClock;
+
+      // fcw / sampleRate = step * adcDiv / den0 (step < 2^48, den0 < 2^51)
+      uint64_t step, den0;
+      if (params.adcClock == DAC_PLAN_ADC_CLOCK_CK8M) {
+        step = fstep;
+        den0 = 1UL << 16;
+      } else {
+        step = (uint64_t)params.ck8m * fstep;
+        den0 = denom * params.adcClock;
+      }
+      // CW frequency not below the Nyquist frequency for higher dividers, this
+      // also keeps step * adcDiv < 2^63 (and adcDiv from wrapping)
+      uint64_t adcDivLast = (den0 - 1) / (2 * step);
+      if (adcDivLast > params.adcDivMax) {
+        adcDivLast = params.adcDivMax;
+      }
+
+      for (uint64_t adcDiv = params.adcDivMin; adcDiv <= adcDivLast; adcDiv++) {
+        uint64_t num = step * adcDiv, den = den0;
+        uint64_t g = gcd(num, den);
+        num /= g;
+        den /= g;
+        candidate.adcDiv = adcDiv;
+        candidate.sampleRate = clock / adcDiv;
+
+        // exactly coherent: N = den, M = num (coprime after reduction)
+        if (den >= params.recordMin && den <= params.recordMax && (!params.powerOfTwo || isPowerOfTwo(den))) {
+          candidate.record = den;
+          candidate.cycles = num;
+          candidate.error = 0;
+          candidate.exact = true;
+          count = insert(candidate, frequency, plans, count, maxPlans);
+        }
+
+        // nearest coprime number of cycles for the other record lengths
+        candidate.exact = false;
+        for (uint64_t n = params.recordMin; n <= params.recordMax; n = params.powerOfTwo ? n * 2 : n + 1) {
+          if (params.powerOfTwo && !isPowerOfTwo(n)) {
+            // start at the next power of 2
+            n = 1ULL << (64 - __builtin_clzll(n));
+          }
+          if (n > params.recordMax || n == den) {
+            continue;
+          }
+          double x = (double)n * num / den;
+          double best = -1;
+          for (int64_t m = (int64_t)floor(x) - 1; m <= (int64_t)floor(x) + 2; m++) {
+            if (m < 1 || 2 * (uint64_t)m >= n || gcd(m, n) != 1) {
+              continue;
+            }
+            if (best < 0 || fabs(x - m) < best) {
+              best = fabs(x - m);
+              candidate.cycles = m;
+            }
+          }
+          if (best >= 0) {
+            candidate.record = n;
+            candidate.error = best;
+            count = insert(candidate, frequency, plans, count, maxPlans);
+          }
+        }
+      }
+    }
+  }
+
+  return count;
+}
+
+//
+// Ranking: exact before approximate, lower coherence error, CW frequency
+// closer to the target, longer record.
+//
+bool DacEspPlanner::better(const dac_plan_t &a, const dac_plan_t &b, uint32_t frequency)
+{
+  if (a.exact != b.exact) {
+    return a.exact;
+  }
+  if (fabs(a.error - b.error) > 1e-9) {
+    return a.error < b.error;
+  }
+  double da = fabs(a.fcw - frequency), db = fabs(b.fcw - frequency);
+  if (fabs(da - db) > 1e-9) {
+    return da < db;
+  }
+  return a.record > b.record;
+}
+
+// insert into sorted list of the best plans, returns new number of plans
+size_t DacEspPlanner::insert(const dac_plan_t &candidate, uint32_t frequency, dac_plan_t *plans, size_t count,
+                             size_t maxPlans)
+{
+  size_t pos = count;
+
+  while (pos > 0 && better(candidate, plans[pos - 1], frequency)) {
+    pos--;
+  }
+  if (pos >= maxPlans) {
+    return count;
+  }
+  if (count < maxPlans) {
+    count++;
+  }
+  for (size_t i = count - 1; i > pos; i--) {
+    plans[i] = plans[i - 1];
+  }
+  plans[pos] = candidate;
+
+  return count;
+}
@@ -0,0 +1,83 @@
+/*
+  DacEspPlanner, coherent sampling planner of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Coherent sampling planner: searches CW generator settings (CK8M_DIV_SEL,
+  SW_FSTEP) near a target frequency together with ADC sample rate and
+  record length, so that a record holds a whole, coprime number of CW
+  cycles (no leakage, every sample at a different phase). No Arduino or
+  ESP-IDF dependencies.
+  Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef DacEspPlanner_h
+#define DacEspPlanner_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+//
+// definitions
+//
+// adcClock value: ADC clocked by RTC8M_CLK / (1 + CK8M_DIV_SEL), i.e. follows the CW divider
+#define DAC_PLAN_ADC_CLOCK_CK8M 0
+
+typedef struct {
+  uint32_t ck8m;            // RTC8M_CLK frequency (Hz)
+  uint8_t  divMax;          // highest CK8M_DIV_SEL allowed
+  uint16_t fstepMax;        // highest SW_FSTEP allowed
+  uint32_t toleranceHz;     // max. deviation of the CW frequency from the target (0 = nearest setting per CK8M_DIV_SEL)
+  uint32_t adcClock;        // clock the ADC sample rate is divided from (Hz) or DAC_PLAN_ADC_CLOCK_CK8M
+  uint32_t adcDivMin;       // sample rate = adcClock / adcDiv, adcDiv = adcDivMin...adcDivMax
+  uint32_t adcDivMax;
+  uint32_t recordMin;       // samples per record, recordMin...recordMax
+  uint32_t recordMax;
+  bool     powerOfTwo;      // record length has to be a power of 2 (FFT)
+} dac_plan_params_t;
+
+typedef struct {
+  uint8_t  clk8mDiv;        // RTC_CNTL_CK8M_DIV_SEL
+  uint16_t frequencyStep;   // SENS_SW_FSTEP
+  double   fcw;             // CW frequency (Hz, exact)
+  uint32_t adcDiv;          // ADC clock divider
+  double   sampleRate;      // ADC sample rate (Hz)
+  uint32_t record;          // samples per record (N)
+  uint32_t cycles;          // CW cycles per record (M, coprime to N)
+  double   error;           // coherence error: |fcw * N / sampleRate - M| (cycles per record)
+  bool     exact;           // fcw / sampleRate is exactly M / N
+} dac_plan_t;
+
+// DacEspPlanner class, all members are static
+class DacEspPlanner
+{
+  public:
+    static size_t plan(uint32_t frequency, const dac_plan_params_t &params, dac_plan_t *plans, size_t maxPlans);
+
+  private:
+    static bool   better(const dac_plan_t &a, const dac_plan_t &b, uint32_t frequency);
+    static size_t insert(const dac_plan_t &candidate, uint32_t frequency, dac_plan_t *plans, size_t count,
+                         size_t maxPlans);
+};
+
+#endif
@@ -0,0 +1,133 @@
+/*
+  DacEspProfile, API latency profiling for the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Optional profiling (DACESP32_PROFILING_ENABLED): the duration of every
+  public method of the library gets measured with the CPU cycle counter
+  (host emulation: steady clock) and collected per API in a log2
+  histogram together with count, min., max. and total time.
+  Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#include "DacEspProfile.h"
+
+#ifdef DACESP32_PROFILING_ENABLED
+
+static const char *apiNames[DAC_API_MAX] = DAC_TRACE_API_NAMES;
+
+// initialize static members of class, updated inside ISRs (kept in DRAM)
+DRAM_ATTR dac_profile_stats_t DacEspProfile::m_stats[DAC_API_MAX];
+DRAM_ATTR portMUX_TYPE        DacEspProfile::m_lock = portMUX_INITIALIZER_UNLOCKED;
+
+//
+// Account one call of an API. Safe in IRAM/ISR context.
+// Parameter: api...API called
+//            cycles...duration (CPU cycles)
+//
+void IRAM_ATTR DacEspProfile::record(dac_trace_api_t api, uint32_t cycles)
+{
+  uint32_t bucket = cycles ? 31 - __builtin_clz(cycles) : 0;
+  dac_profile_stats_t &stats = m_stats[api];
+
+  portENTER_CRITICAL_SAFE(&m_lock);
+  if (stats.count == 0 || cycles < stats.minCycles) {
+    stats.minCycles = cycles;
+  }
+  if (cycles > stats.maxCycles) {
+    stats.maxCycles = cycles;
+  }
+  stats.count++;
+  stats.totalCycles += cycles;
+  stats.bucket[bucket]++;
+  portEXIT_CRITICAL_SAFE(&m_lock);
+}
+
+//
+// Get a consistent copy of the statistics of an API.
+// Parameter: api...API
+//            stats...receives the statistics
+// Returns false for an invalid API.
+//
+bool DacEspProfile::getStats(dac_trace_api_t api, dac_profile_stats_t *stats)
+{
+  if (api >= DAC_API_MAX || stats == NULL) {
+    return false;
+  }
+  portENTER_CRITICAL(&m_lock);
+  *stats = m_stats[api];
+  portEXIT_CRITICAL(&m_lock);
+
+  return true;
+}
+
+//
+// Clear statistics of all APIs.
+//
+void DacEspProfile::reset()
+{
+  portENTER_CRITICAL(&m_lock);
+  memset(m_stats, 0, sizeof(m_stats));
+  portEXIT_CRITICAL(&m_lock);
+}
+
+const char *DacEspProfile::apiName(dac_trace_api_t api)
+{
+  return (api < DAC_API_MAX) ? apiNames[api] : "?";
+}
+
+//
+// Estimate a percentile from the histogram (e.g. 50 = median, 99). The
+// result is the upper end of the bucket reached, i.e. no more than twice
+// the exact value, and never above the max. measured.
+// Parameter: stats...statistics of an API
+//            percent...1...100
+// Returns duration in CPU cycles.
+//
+uint32_t DacEspProfile::percentile(const dac_profile_stats_t &stats, uint8_t percent)
+{
+  uint64_t needed = ((uint64_t)stats.count * percent + 99) / 100;
+  uint64_t sum = 0;
+
+  if (stats.count == 0) {
+    return 0;
+  }
+  for (int bucket = 0; bucket < DAC_PROFILE_BUCKETS; bucket++) {
+    sum += stats.bucket[bucket];
+    if (sum >= needed) {
+      uint32_t upper = (bucket < DAC_PROFILE_BUCKETS - 1) ? (2UL << bucket) - 1 : UINT32_MAX;
+      return (upper < stats.maxCycles) ? upper : stats.maxCycles;
+    }
+  }
+  return stats.maxCycles;
+}
+
+//
+// Convert CPU cycles into ns at the current CPU clock (host: 1:1).
+//
+uint32_t DacEspProfile::cyclesToNs(uint32_t cycles)
+{
+  return (uint32_t)((uint64_t)cycles * 1000 / DAC_HAL_CCOUNT_MHZ());
+}
+
+#endif
@@ -0,0 +1,105 @@
+/*
+  DacEspProfile, API latency profiling for the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Optional profiling (DACESP32_PROFILING_ENABLED): the duration of every
+  public method of the library gets measured with the CPU cycle counter
+  (host emulation: steady clock) and collected per API in a log2
+  histogram together with count, min., max. and total time.
+  Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+
+#ifndef DacEspProfile_h
+#define DacEspProfile_h
+
+#include "DacESP32.h"
+#include "DacEspTrace.h"
+
+#ifdef DACESP32_PROFILING_ENABLED
+
+//
+// definitions
+//
+// Histogram bucket n counts calls taking 2^n...2^(n+1)-1 cycles (bucket 0 also 0 cycles).
+#define DAC_PROFILE_BUCKETS 32
+
+// Time the rest of the current scope and account it to an API.
+#define DAC_PROFILE_API(api) DacEspProfileScope dacProfileScope(api)
+
+typedef struct {
+  uint32_t count;           // calls measured
+  uint32_t minCycles;       // shortest call (CPU cycles)
+  uint32_t maxCycles;       // longest call (CPU cycles)
+  uint64_t totalCycles;     // all calls (CPU cycles)
+  uint32_t bucket[DAC_PROFILE_BUCKETS]; // log2 histogram of call durations
+} dac_profile_stats_t;
+
+// DacEspProfile class, all members are static
+class DacEspProfile
+{
+  public:
+    static void        record(dac_trace_api_t api, uint32_t cycles);
+    static bool        getStats(dac_trace_api_t api, dac_profile_stats_t *stats);
+    static void        reset(void);
+    static const char *apiName(dac_trace_api_t api);
+    static uint32_t    percentile(const dac_profile_stats_t &stats, uint8_t percent);
+    static uint32_t    cyclesToNs(uint32_t cycles);
+
+  private:
+    static dac_profile_stats_t m_stats[DAC_API_MAX];
+    static portMUX_TYPE        m_lock;
+};
+
+// Measures the cycles from construction to destruction. Nested scopes are
+// measured separately, the outer time includes the inner ones.
+class DacEspProfileScope
+{
+  public:
+    inline __attribute__((always_inline)) DacEspProfileScope(dac_trace_api_t api)
+    {
+      m_api = api;
+      m_start = DAC_HAL_CCOUNT();
+    }
+    inline __attribute__((always_inline)) ~DacEspProfileScope()
+    {
+      DacEspProfile::record(m_api, DAC_HAL_CCOUNT() - m_start);
+    }
+
+  private:
+    dac_trace_api_t m_api;
+    uint32_t        m_start;
+};
+
+#else
+
+// compiled out, no code generated
+#define DAC_PROFILE_API(api)
+
+#endif
+
+// Tag of a public method: register writes get traced with it and its
+// duration gets profiled (if enabled).
+#define DAC_API(api) DAC_TRACE_API(api); DAC_PROFILE_API(api)
+
+#endif
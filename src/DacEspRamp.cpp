@@ -0,0 +1,398 @@
+/*
+  DacEspRamp, background ramp & envelope engine for the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Moves the output of a DAC channel from its current value to a target
+  value at a given slew rate or within a given time, instead of changing
+  it in one single step. A ramp runs in the background (driven by the
+  esp_timer service) and can be retargeted at any time without blocking
+  the caller. Linear & S-curve profiles as well as ADSR-style envelopes
+  are supported. Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "DacEspRamp.h"
+#include "DacEspRegs.h"
+#include "DacChannel.h"
+#include "DacEspProfile.h"
+
+#define RAMP_CHECK                                  \
+  if (m_channel == DAC_CHANNEL_UNDEFINED) {         \
+    log_e("ramp not registered for a DAC channel"); \
+    return ESP_ERR_INVALID_STATE;                   \
+  }
+
+#define PROFILE_CHECK(profile)                      \
+  if (profile != DAC_RAMP_LINEAR &&                 \
+      profile != DAC_RAMP_SCURVE) {                 \
+    return ESP_ERR_INVALID_ARG;                     \
+  }
+
+// initialize static members of class (shared by all created objects)
+DacEspRamp         *DacEspRamp::m_ramps[DAC_CHANNEL_MAX] = { NULL };
+esp_timer_handle_t  DacEspRamp::m_timer = NULL;
+bool                DacEspRamp::m_timerArmed = false;
+bool                DacEspRamp::m_tickWriting = false;
+portMUX_TYPE        DacEspRamp::m_lock = portMUX_INITIALIZER_UNLOCKED;
+
+//
+// Class constructor.
+// Parameter: dac...DAC object whose output shall be ramped. Only one ramp
+//                  object per DAC channel is possible. The channel of the
+//                  DAC object must not be changed while the ramp exists.
+//
+DacEspRamp::DacEspRamp(DacESP32 &dac)
+  : m_channel(DAC_CHANNEL_UNDEFINED), m_state(DAC_RAMP_IDLE), m_profile(DAC_RAMP_LINEAR),
+    m_value(0), m_from(0), m_to(0), m_start(0), m_duration(0)
+{
+  dac_channel_t channel = dac.getChannel();
+
+  memset(&m_envelope, 0, sizeof(m_envelope));
+
+  if (channel != DAC_CHANNEL_1 && channel != DAC_CHANNEL_2) {
+    log_e("DAC object has no valid channel assigned");
+    return;
+  }
+
+  // ramps start at the value the DAC channel currently holds
+  DAC_ENTER_CRITICAL();
+  if (channel == DAC_CHANNEL_1) {
+    m_value = (DacEspRegs::read(DAC_REG_PAD_DAC1) & RTC_IO_PDAC1_DAC_M) >> RTC_IO_PDAC1_DAC_S;
+  }
+  else {
+    m_value = (DacEspRegs::read(DAC_REG_PAD_DAC2) & RTC_IO_PDAC2_DAC_M) >> RTC_IO_PDAC2_DAC_S;
+  }
+  DAC_EXIT_CRITICAL();
+  m_from = m_to = m_value;
+
+  portENTER_CRITICAL(&m_lock);
+  if (m_ramps[channel] == NULL) {
+    m_ramps[channel] = this;
+    m_channel = channel;
+  }
+  portEXIT_CRITICAL(&m_lock);
+
+  if (m_channel == DAC_CHANNEL_UNDEFINED) {
+    log_e("DAC channel %d already has a ramp object assigned", channel);
+  }
+}
+
+//
+// Class destructor. A running ramp stops at its current value.
+//
+DacEspRamp::~DacEspRamp()
+{
+  if (m_channel != DAC_CHANNEL_UNDEFINED) {
+    portENTER_CRITICAL(&m_lock);
+    m_ramps[m_channel] = NULL;
+    portEXIT_CRITICAL(&m_lock);
+    waitTick();
+  }
+}
+
+//
+// Ramp DAC output from its current value to a new value within given time.
+// A ramp already in progress gets retargeted from the value reached so far.
+// Parameter: value......target DAC output value (0...255)
+//            durationMs...time to reach target value in ms (0 = immediately)
+//            profile......shape of the ramp (linear or S-curve)
+//
+esp_err_t DacEspRamp::rampTo(uint8_t value, uint32_t durationMs, dac_ramp_profile_t profile)
+{
+  RAMP_CHECK;
+  PROFILE_CHECK(profile);
+
+  return activate(value, (uint64_t)durationMs * 1000, DAC_RAMP_RUNNING, profile);
+}
+
+//
+// Ramp DAC output from its current value to a new value with given slew rate.
+// Parameter: value......target DAC output value (0...255)
+//            slewRate...max. rate of change in DAC steps per second, for the
+//                       S-curve profile this is the peak rate
+//            profile....shape of the ramp (linear or S-curve)
+//
+esp_err_t DacEspRamp::slewTo(uint8_t value, uint32_t slewRate, dac_ramp_profile_t profile)
+{
+  RAMP_CHECK;
+  PROFILE_CHECK(profile);
+
+  if (slewRate == 0) {
+    log_e("invalid parameter: slew rate (%d) out of range", slewRate);
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  uint64_t durationUs = ((uint64_t)abs((int)value - (int)getValue()) * 1000000UL) / slewRate;
+
+  if (profile == DAC_RAMP_SCURVE) {
+    // smoothstep peaks at 1.5x the average slew rate
+    durationUs = durationUs * 3 / 2;
+  }
+
+  return activate(value, durationUs, DAC_RAMP_RUNNING, profile);
+}
+
+//
+// Start an ADSR-style envelope: attack to peak level, decay to sustain
+// level and hold it until release() gets called.
+// Parameter: envelope...levels & phase durations
+//
+esp_err_t DacEspRamp::envelope(const dac_envelope_t &envelope)
+{
+  RAMP_CHECK;
+  PROFILE_CHECK(envelope.profile);
+
+  portENTER_CRITICAL(&m_lock);
+  m_envelope = envelope;
+  portEXIT_CRITICAL(&m_lock);
+
+  return activate(envelope.peak, (uint64_t)envelope.attackMs * 1000, DAC_RAMP_ATTACK, envelope.profile);
+}
+
+//
+// Start release phase of an envelope. Allowed in attack, decay & sustain phase.
+//
+esp_err_t DacEspRamp::release()
+{
+  RAMP_CHECK;
+
+  dac_ramp_state_t state = getState();
+
+  if (state != DAC_RAMP_ATTACK && state != DAC_RAMP_DECAY && state != DAC_RAMP_SUSTAIN) {
+    log_e("no envelope active");
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  return activate(m_envelope.base, (uint64_t)m_envelope.releaseMs * 1000, DAC_RAMP_RELEASE, m_envelope.profile);
+}
+
+//
+// Stop ramp/envelope. DAC output keeps the value reached so far. Returns
+// after a tick writing the DAC value has finished, so a following
+// outputVoltage() of the caller can't be overwritten by the ramp. Must not
+// be called while holding the shared register lock.
+//
+esp_err_t DacEspRamp::stop()
+{
+  RAMP_CHECK;
+
+  portENTER_CRITICAL(&m_lock);
+  m_state = DAC_RAMP_IDLE;
+  portEXIT_CRITICAL(&m_lock);
+  waitTick();
+
+  return ESP_OK;
+}
+
+dac_ramp_state_t DacEspRamp::getState()
+{
+  dac_ramp_state_t state;
+
+  portENTER_CRITICAL(&m_lock);
+  state = m_state;
+  portEXIT_CRITICAL(&m_lock);
+
+  return state;
+}
+
+uint8_t DacEspRamp::getValue()
+{
+  return m_value;
+}
+
+//
+// Returns true while DAC output is changing (sustain phase counts as steady).
+//
+bool DacEspRamp::isBusy()
+{
+  dac_ramp_state_t state = getState();
+
+  return state != DAC_RAMP_IDLE && state != DAC_RAMP_SUSTAIN;
+}
+
+//
+// Start new segment from the current value and make sure the engine is ticking.
+//
+esp_err_t DacEspRamp::activate(uint8_t target, uint64_t durationUs, dac_ramp_state_t state,
+                               dac_ramp_profile_t profile)
+{
+  bool arm;
+
+  portENTER_CRITICAL(&m_lock);
+  m_profile = profile;
+  startSegment(target, durationUs, state);
+  arm = !m_timerArmed;
+  m_timerArmed = true;
+  portEXIT_CRITICAL(&m_lock);
+
+  return arm ? scheduleTick() : ESP_OK;
+}
+
+//
+// Set up a new segment starting at the current DAC value (lock must be held).
+//
+void DacEspRamp::startSegment(uint8_t target, uint64_t durationUs, dac_ramp_state_t state)
+{
+  m_from = m_value;
+  m_to = target;
+  m_start = esp_timer_get_time();
+  m_duration = durationUs;
+  m_state = state;
+}
+
+//
+// Calculate DAC value for given point in time and handle end of segments
+// (lock must be held). Returns true if the DAC value has changed.
+//
+bool DacEspRamp::advance(int64_t now)
+{
+  uint64_t elapsed = (now > m_start) ? (uint64_t)(now - m_start) : 0;
+  uint8_t  value = m_to;
+  bool     changed;
+
+  if (elapsed < m_duration) {
+    // progress within segment 0...65535 (fixed point, 1.0 = 65536)
+    uint32_t p = (uint32_t)((elapsed << 16) / m_duration);
+    if (m_profile == DAC_RAMP_SCURVE) {
+      // smoothstep: p² * (3 - 2p)
+      p = (uint32_t)(((uint64_t)p * p * (3 * 65536UL - 2 * p)) >> 32);
+    }
+    value = (uint8_t)(m_from + (int32_t)(((int64_t)((int)m_to - (int)m_from) * p + 32768) >> 16));
+  }
+
+  changed = (value != m_value);
+  m_value = value;
+
+  if (elapsed >= m_duration) {
+    // segment finished, continue with next envelope phase (if any)
+    switch (m_state) {
+      case DAC_RAMP_ATTACK:
+        startSegment(m_envelope.sustain, (uint64_t)m_envelope.decayMs * 1000, DAC_RAMP_DECAY);
+        break;
+      case DAC_RAMP_DECAY:
+        m_state = DAC_RAMP_SUSTAIN;
+        break;
+      default:
+        m_state = DAC_RAMP_IDLE;
+        break;
+    }
+  }
+
+  return changed;
+}
+
+//
+// Arm the timer for the next tick. Timer gets created on first use.
+//
+esp_err_t DacEspRamp::scheduleTick()
+{
+  esp_err_t result = ESP_OK;
+
+  if (m_timer == NULL) {
+    esp_timer_create_args_t args = {};
+    args.callback = &DacEspRamp::onTick;
+    args.name = "DacEspRamp";
+    result = esp_timer_create(&args, &m_timer);
+  }
+
+  if (result == ESP_OK) {
+    result = esp_timer_start_once(m_timer, DAC_RAMP_TICK_US);
+  }
+
+  if (result != ESP_OK) {
+    log_e("ramp timer could not be started (%d)", result);
+    portENTER_CRITICAL(&m_lock);
+    m_timerArmed = false;
+    portEXIT_CRITICAL(&m_lock);
+  }
+
+  return result;
+}
+
+//
+// Wait until a tick computed under m_lock has written its DAC values.
+//
+void DacEspRamp::waitTick()
+{
+  for (;;) {
+    portENTER_CRITICAL(&m_lock);
+    bool writing = m_tickWriting;
+    portEXIT_CRITICAL(&m_lock);
+    if (!writing) {
+      break;
+    }
+    vTaskDelay(1);
+  }
+}
+
+//
+// Timer callback (esp_timer task): advance all active ramps & write new
+// DAC values. Re-arms itself as long as any ramp is active. Progress is
+// derived from the system time, hence late ticks don't stretch a ramp.
+// The pad registers get written after m_lock is released, so the shared
+// register lock is never taken while holding it. m_tickWriting covers
+// that gap for stop() & the destructor.
+//
+void DacEspRamp::onTick(void *arg)
+{
+  DAC_API(DAC_API_RAMP);
+
+  int64_t now = esp_timer_get_time();
+  bool    rearm = false, write;
+  int16_t values[DAC_CHANNEL_MAX];    // new DAC value per channel, -1 = unchanged
+
+  portENTER_CRITICAL(&m_lock);
+  for (int i = 0; i < DAC_CHANNEL_MAX; i++) {
+    DacEspRamp *ramp = m_ramps[i];
+    values[i] = -1;
+    if (ramp == NULL || ramp->m_state == DAC_RAMP_IDLE || ramp->m_state == DAC_RAMP_SUSTAIN) {
+      continue;
+    }
+    if (ramp->advance(now)) {
+      values[i] = ramp->m_value;
+    }
+    if (ramp->m_state != DAC_RAMP_IDLE && ramp->m_state != DAC_RAMP_SUSTAIN) {
+      rearm = true;
+    }
+  }
+  m_timerArmed = rearm;
+  write = values[DAC_CHANNEL_1] >= 0 || values[DAC_CHANNEL_2] >= 0;
+  m_tickWriting = write;
+  portEXIT_CRITICAL(&m_lock);
+
+  if (write) {
+    // same register writes as DacESP32::outputVoltage(), traced as DAC_API_RAMP
+    if (values[DAC_CHANNEL_1] >= 0) {
+      DacChannel<DAC_CHANNEL_1>::outputVoltage((uint8_t)values[DAC_CHANNEL_1]);
+    }
+    if (values[DAC_CHANNEL_2] >= 0) {
+      DacChannel<DAC_CHANNEL_2>::outputVoltage((uint8_t)values[DAC_CHANNEL_2]);
+    }
+    portENTER_CRITICAL(&m_lock);
+    m_tickWriting = false;
+    portEXIT_CRITICAL(&m_lock);
+  }
+
+  if (rearm) {
+    esp_timer_start_once(m_timer, DAC_RAMP_TICK_US);
+  }
+}
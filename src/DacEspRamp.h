@@ -0,0 +1,113 @@
+/*
+  DacEspRamp, background ramp & envelope engine for the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Moves the output of a DAC channel from its current value to a target
+  value at a given slew rate or within a given time, instead of changing
+  it in one single step. A ramp runs in the background (driven by the
+  esp_timer service) and can be retargeted at any time without blocking
+  the caller. Linear & S-curve profiles as well as ADSR-style envelopes
+  are supported. Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef DacEspRamp_h
+#define DacEspRamp_h
+
+#include "DacESP32.h"
+#include "esp_timer.h"
+
+//
+// definitions
+//
+// Update interval of the ramp engine in us. Shorter intervals give smoother
+// ramps at the cost of more CPU load. A DAC value never changes more often.
+#ifndef DAC_RAMP_TICK_US
+#define DAC_RAMP_TICK_US 1000
+#endif
+
+typedef enum {
+  DAC_RAMP_LINEAR = 0,      // constant slew rate
+  DAC_RAMP_SCURVE = 1       // smooth start & stop (smoothstep), peak slew rate 1.5x average
+} dac_ramp_profile_t;
+
+typedef enum {
+  DAC_RAMP_IDLE = 0,        // no ramp active, output steady
+  DAC_RAMP_RUNNING,         // simple ramp (rampTo/slewTo) in progress
+  DAC_RAMP_ATTACK,          // envelope: ramping to peak level
+  DAC_RAMP_DECAY,           // envelope: ramping from peak to sustain level
+  DAC_RAMP_SUSTAIN,         // envelope: holding sustain level until release()
+  DAC_RAMP_RELEASE          // envelope: ramping from sustain to base level
+} dac_ramp_state_t;
+
+typedef struct {
+  uint8_t  peak;            // level reached at end of attack phase
+  uint8_t  sustain;         // level held after decay phase until release()
+  uint8_t  base;            // level reached at end of release phase
+  uint32_t attackMs;        // duration of attack phase (current level -> peak)
+  uint32_t decayMs;         // duration of decay phase (peak -> sustain)
+  uint32_t releaseMs;       // duration of release phase (current level -> base)
+  dac_ramp_profile_t profile;
+} dac_envelope_t;
+
+// DacEspRamp class
+class DacEspRamp
+{
+  public:
+    DacEspRamp(DacESP32 &dac);
+    ~DacEspRamp();
+    esp_err_t rampTo(uint8_t value, uint32_t durationMs, dac_ramp_profile_t profile = DAC_RAMP_LINEAR);
+    esp_err_t slewTo(uint8_t value, uint32_t slewRate, dac_ramp_profile_t profile = DAC_RAMP_LINEAR);
+    esp_err_t envelope(const dac_envelope_t &envelope);
+    esp_err_t release(void);
+    esp_err_t stop(void);
+    dac_ramp_state_t getState(void);
+    uint8_t   getValue(void);
+    bool      isBusy(void);
+
+  private:
+    esp_err_t activate(uint8_t target, uint64_t durationUs, dac_ramp_state_t state, dac_ramp_profile_t profile);
+    void startSegment(uint8_t target, uint64_t durationUs, dac_ramp_state_t state);
+    bool advance(int64_t now);
+    static esp_err_t scheduleTick(void);
+    static void waitTick(void);
+    static void onTick(void *arg);
+
+    dac_channel_t      m_channel;   // DAC channel this ramp is registered for
+    dac_ramp_state_t   m_state;     // current ramp/envelope phase
+    dac_ramp_profile_t m_profile;   // profile of current segment
+    dac_envelope_t     m_envelope;  // envelope parameters (ADSR)
+    uint8_t            m_value;     // DAC value last written
+    uint8_t            m_from;      // DAC value at start of current segment
+    uint8_t            m_to;        // DAC value at end of current segment
+    int64_t            m_start;     // start time of current segment (us)
+    uint64_t           m_duration;  // duration of current segment (us)
+
+    // shared by all objects of this class
+    static DacEspRamp         *m_ramps[DAC_CHANNEL_MAX]; // registered ramp per channel
+    static esp_timer_handle_t  m_timer;                  // timer driving all ramps
+    static bool                m_timerArmed;             // tick scheduled
+    static bool                m_tickWriting;            // tick writing DAC values (outside m_lock)
+    static portMUX_TYPE        m_lock;                   // protects all ramp states
+};
+
+#endif
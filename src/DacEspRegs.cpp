@@ -0,0 +1,193 @@
+/*
+  DacEspRegs, shadow register cache for the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  All register writes of the library go through class DacEspRegs. It keeps
+  in-RAM shadow copies of the DAC related bits in SENS_SAR_DAC_CTRL1_REG,
+  SENS_SAR_DAC_CTRL2_REG, RTC_IO_PAD_DAC1/2_REG and of the CK8M fields in
+  RTC_CNTL_CLK_CONF_REG. Writes not changing anything are skipped. In batch
+  mode changes only get marked dirty and are written with flush().
+  Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "DacEspRegs.h"
+
+// initialize static members of class, everything kept in DRAM (ISR safe)
+DRAM_ATTR const uint32_t DacEspRegs::m_addr[DAC_REG_MAX] = {
+  RTC_CNTL_CLK_CONF_REG, SENS_SAR_DAC_CTRL1_REG, SENS_SAR_DAC_CTRL2_REG, RTC_IO_PAD_DAC1_REG, RTC_IO_PAD_DAC2_REG
+};
+DRAM_ATTR const uint32_t DacEspRegs::m_owned[DAC_REG_MAX] = {
+  RTC_CNTL_CK8M_DIV_SEL_M | RTC_CNTL_CK8M_DFREQ_M,
+  SENS_SW_TONE_EN_M | SENS_SW_FSTEP_M,
+  SENS_DAC_CW_EN1_M | SENS_DAC_CW_EN2_M | SENS_DAC_INV1_M | SENS_DAC_INV2_M |
+    SENS_DAC_SCALE1_M | SENS_DAC_SCALE2_M | SENS_DAC_DC1_M | SENS_DAC_DC2_M,
+  RTC_IO_PDAC1_DAC_M | RTCIO_PAD_PDAC1_MUX_SEL | RTC_IO_PDAC1_XPD_DAC | RTC_IO_PDAC1_DAC_XPD_FORCE,
+  RTC_IO_PDAC2_DAC_M | RTCIO_PAD_PDAC2_MUX_SEL | RTC_IO_PDAC2_XPD_DAC | RTC_IO_PDAC2_DAC_XPD_FORCE
+};
+uint32_t DacEspRegs::m_shadow[DAC_REG_MAX] = { 0 };
+uint32_t DacEspRegs::m_valid = 0;
+uint32_t DacEspRegs::m_dirty = 0;
+bool     DacEspRegs::m_batch = false;
+uint32_t DacEspRegs::m_requested = 0;
+uint32_t DacEspRegs::m_skipped = 0;
+uint32_t DacEspRegs::m_issued = 0;
+
+//
+// Enable/disable batch mode. In batch mode register changes are collected
+// until flush() gets called. Leaving batch mode flushes pending changes.
+//
+void DacEspRegs::setBatchMode(bool enable)
+{
+  DAC_ENTER_CRITICAL();
+  m_batch = enable;
+  DAC_EXIT_CRITICAL();
+
+  if (!enable) {
+    flush();
+  }
+}
+
+//
+// Write all registers with pending changes.
+//
+void DacEspRegs::flush()
+{
+  DAC_ENTER_CRITICAL();
+  for (int reg = 0; reg < DAC_REG_MAX; reg++) {
+    if (m_dirty & BIT(reg)) {
+      writeThrough((dac_reg_t)reg);
+    }
+  }
+  DAC_EXIT_CRITICAL();
+}
+
+void DacEspRegs::flush(dac_reg_t reg)
+{
+  DAC_ENTER_CRITICAL();
+  if (m_dirty & BIT(reg)) {
+    writeThrough(reg);
+  }
+  DAC_EXIT_CRITICAL();
+}
+
+//
+// Forget shadow copy of a register, it gets reloaded on next access. Needed
+// after the register has been changed by other code (e.g. ESP-IDF driver).
+// Pending changes get written first.
+//
+void DacEspRegs::invalidate(dac_reg_t reg)
+{
+  DAC_ENTER_CRITICAL();
+  if (m_dirty & BIT(reg)) {
+    writeThrough(reg);
+  }
+  m_valid &= ~BIT(reg);
+  DAC_EXIT_CRITICAL();
+}
+
+//
+// Call an ESP-IDF DAC driver function (e.g. dac_output_enable) which changes
+// the pad register of a channel behind the shadow copy.
+//
+esp_err_t DacEspRegs::padDriverCall(esp_err_t (*func)(dac_channel_t), dac_channel_t channel)
+{
+  dac_reg_t reg = (channel == DAC_CHANNEL_1) ? DAC_REG_PAD_DAC1 : DAC_REG_PAD_DAC2;
+
+  flush(reg);
+#ifdef DACESP32_TRACE_ENABLED
+  uint32_t old = DAC_HAL_READ(m_addr[reg]);
+#endif
+  esp_err_t result = func(channel);
+#ifdef DACESP32_TRACE_ENABLED
+  DAC_ENTER_CRITICAL();
+  DAC_TRACE_DRIVER_WRITE(reg, old, DAC_HAL_READ(m_addr[reg]));
+  DAC_EXIT_CRITICAL();
+#endif
+  invalidate(reg);
+
+  return result;
+}
+
+//
+// Read all registers at once (complete values, not only the bits handled by
+// the shadow copies). Pending changes get written first.
+//
+void DacEspRegs::capture(dac_reg_dump_t *regs)
+{
+  uint32_t values[DAC_REG_MAX];
+
+  DAC_ENTER_CRITICAL();
+  for (int reg = 0; reg < DAC_REG_MAX; reg++) {
+    if (m_dirty & BIT(reg)) {
+      writeThrough((dac_reg_t)reg);
+    }
+    values[reg] = DAC_HAL_READ(m_addr[reg]);
+  }
+  DAC_EXIT_CRITICAL();
+
+  regs->clkConf = values[DAC_REG_CLK_CONF];
+  regs->ctrl1 = values[DAC_REG_CTRL1];
+  regs->ctrl2 = values[DAC_REG_CTRL2];
+  regs->padDac[0] = values[DAC_REG_PAD_DAC1];
+  regs->padDac[1] = values[DAC_REG_PAD_DAC2];
+}
+
+//
+// Compare the loaded shadow copies with the registers (e.g. in stress tests).
+// Returns a bit per register whose shadow copy differs, 0 if all match.
+// Registers with pending changes (batch mode) are not compared.
+//
+uint32_t DacEspRegs::verify()
+{
+  uint32_t mismatch = 0;
+
+  DAC_ENTER_CRITICAL();
+  for (int reg = 0; reg < DAC_REG_MAX; reg++) {
+    if ((m_valid & BIT(reg)) && !(m_dirty & BIT(reg)) &&
+        (DAC_HAL_READ(m_addr[reg]) & m_owned[reg]) != m_shadow[reg]) {
+      mismatch |= BIT(reg);
+    }
+  }
+  DAC_EXIT_CRITICAL();
+
+  return mismatch;
+}
+
+//
+// Get counters of requested, skipped and issued register writes.
+//
+void DacEspRegs::getStats(dac_regs_stats_t *stats)
+{
+  DAC_ENTER_CRITICAL();
+  stats->requested = m_requested;
+  stats->skipped = m_skipped;
+  stats->issued = m_issued;
+  DAC_EXIT_CRITICAL();
+}
+
+void DacEspRegs::resetStats()
+{
+  DAC_ENTER_CRITICAL();
+  m_requested = m_skipped = m_issued = 0;
+  DAC_EXIT_CRITICAL();
+}
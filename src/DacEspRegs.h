@@ -0,0 +1,132 @@
+/*
+  DacEspRegs, shadow register cache for the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  All register writes of the library go through class DacEspRegs. It keeps
+  in-RAM shadow copies of the DAC related bits in SENS_SAR_DAC_CTRL1_REG,
+  SENS_SAR_DAC_CTRL2_REG, RTC_IO_PAD_DAC1/2_REG and of the CK8M fields in
+  RTC_CNTL_CLK_CONF_REG. Writes not changing anything are skipped. In batch
+  mode changes only get marked dirty and are written with flush().
+  Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef DacEspRegs_h
+#define DacEspRegs_h
+
+#include "DacESP32.h"
+#include "DacEspTrace.h"
+
+// registers handled by DacEspRegs
+typedef enum {
+  DAC_REG_CLK_CONF = 0,     // RTC_CNTL_CLK_CONF_REG (CK8M_DIV_SEL & CK8M_DFREQ only)
+  DAC_REG_CTRL1,            // SENS_SAR_DAC_CTRL1_REG (SW_TONE_EN & SW_FSTEP only)
+  DAC_REG_CTRL2,            // SENS_SAR_DAC_CTRL2_REG (CW_EN, INV, SCALE, DC of both channels)
+  DAC_REG_PAD_DAC1,         // RTC_IO_PAD_DAC1_REG (DAC value & output enable bits)
+  DAC_REG_PAD_DAC2,         // RTC_IO_PAD_DAC2_REG (DAC value & output enable bits)
+  DAC_REG_MAX
+} dac_reg_t;
+
+typedef struct {
+  uint32_t requested;       // register field updates requested
+  uint32_t skipped;         // updates skipped, register already had this value
+  uint32_t issued;          // register writes really done
+} dac_regs_stats_t;
+
+// DacEspRegs class, all members are static
+class DacEspRegs
+{
+  public:
+    //
+    // Get register value from shadow copy (only bits handled by DacEspRegs).
+    // Shared register lock (DAC_ENTER_CRITICAL) must be held.
+    //
+    static inline __attribute__((always_inline)) uint32_t read(dac_reg_t reg)
+    {
+      load(reg);
+      return m_shadow[reg];
+    }
+
+    //
+    // Change bits of a register. Skipped if shadow copy already holds the
+    // value, only marked dirty in batch mode. Shared register lock
+    // (DAC_ENTER_CRITICAL) must be held. Safe in IRAM/ISR context.
+    //
+    static inline __attribute__((always_inline)) void setField(dac_reg_t reg, uint32_t mask, uint32_t value)
+    {
+      load(reg);
+      uint32_t v = (m_shadow[reg] & ~mask) | (value & mask & m_owned[reg]);
+      m_requested++;
+      if (v == m_shadow[reg]) {
+        m_skipped++;
+        return;
+      }
+      m_shadow[reg] = v;
+      if (m_batch) {
+        m_dirty |= BIT(reg);
+        return;
+      }
+      writeThrough(reg);
+    }
+
+    static void      setBatchMode(bool enable);
+    static bool      getBatchMode(void) { return m_batch; };
+    static void      flush(void);
+    static void      flush(dac_reg_t reg);
+    static void      invalidate(dac_reg_t reg);
+    static esp_err_t padDriverCall(esp_err_t (*func)(dac_channel_t), dac_channel_t channel);
+    static void      getStats(dac_regs_stats_t *stats);
+    static void      resetStats(void);
+    static void      capture(dac_reg_dump_t *regs);
+    static uint32_t  verify(void);
+    static uint32_t  address(dac_reg_t reg) { return m_addr[reg]; };
+
+  private:
+    static inline __attribute__((always_inline)) void load(dac_reg_t reg)
+    {
+      if (!(m_valid & BIT(reg))) {
+        m_shadow[reg] = DAC_HAL_READ(m_addr[reg]) & m_owned[reg];
+        m_valid |= BIT(reg);
+      }
+    }
+
+    // merges shadow copy into register, bits not handled stay untouched
+    static inline __attribute__((always_inline)) void writeThrough(dac_reg_t reg)
+    {
+      uint32_t old = DAC_HAL_READ(m_addr[reg]);
+      uint32_t value = (old & ~m_owned[reg]) | m_shadow[reg];
+      DAC_HAL_WRITE(m_addr[reg], value);
+      DAC_TRACE_WRITE(reg, old, value);
+      m_dirty &= ~BIT(reg);
+      m_issued++;
+    }
+
+    static const uint32_t m_addr[DAC_REG_MAX];    // register addresses
+    static const uint32_t m_owned[DAC_REG_MAX];   // bits handled by shadow copies
+    static uint32_t m_shadow[DAC_REG_MAX];        // shadow copies
+    static uint32_t m_valid;                      // shadow copy loaded (bit per register)
+    static uint32_t m_dirty;                      // shadow copy not yet written (bit per register)
+    static bool     m_batch;                      // batch mode active
+    static uint32_t m_requested, m_skipped, m_issued;
+};
+
+#endif
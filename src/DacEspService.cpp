@@ -0,0 +1,483 @@
+/*
+  DacEspService, DAC command task for the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Optional service mode: instead of executing frequency calculation and
+  register writes inline, callers post compact commands into a queue. A
+  dedicated task (pinned to a selectable core) executes them in the order
+  posted per channel. Parameter settings still waiting in the queue get
+  coalesced, e.g. only the latest CW frequency is applied if several got
+  posted in a row.
+  Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "DacEspService.h"
+#include "esp_timer.h"
+
+#if (DAC_SERVICE_QUEUE_LEN & (DAC_SERVICE_QUEUE_LEN - 1)) != 0
+#error "DAC_SERVICE_QUEUE_LEN must be a power of 2"
+#endif
+
+#define SERVICE_CHECK                               \
+  if (m_task == NULL) {                             \
+    return ESP_ERR_INVALID_STATE;                   \
+  }
+
+#define DAC_CHECK(dac)                              \
+  if (dac.getChannel() != DAC_CHANNEL_1 &&          \
+      dac.getChannel() != DAC_CHANNEL_2) {          \
+    return ESP_FAIL;                                \
+  }
+
+// initialize static members of class
+dac_cmd_t           DacEspService::m_queue[DAC_SERVICE_QUEUE_LEN];
+DacEspService::Slot DacEspService::m_slots[DAC_CMD_COALESCED_MAX][DAC_CHANNEL_MAX];
+uint32_t            DacEspService::m_head = 0;
+uint32_t            DacEspService::m_tail = 0;
+TaskHandle_t        DacEspService::m_task = NULL;
+portMUX_TYPE        DacEspService::m_lock = portMUX_INITIALIZER_UNLOCKED;
+volatile bool       DacEspService::m_stop = false;
+uint32_t            DacEspService::m_posted = 0;
+uint32_t            DacEspService::m_coalesced = 0;
+uint32_t            DacEspService::m_dropped = 0;
+uint32_t            DacEspService::m_executed = 0;
+uint32_t            DacEspService::m_depthMax = 0;
+uint32_t            DacEspService::m_latencyMax = 0;
+uint64_t            DacEspService::m_latencySum = 0;
+
+//
+// Start service task.
+// Parameter: core.......CPU core the service task gets pinned to (0/1)
+//            priority...FreeRTOS priority of service task
+//
+esp_err_t DacEspService::begin(BaseType_t core, UBaseType_t priority)
+{
+  if (m_task != NULL) {
+    log_e("service already running");
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  // empty queue
+  for (int op = 0; op < DAC_CMD_COALESCED_MAX; op++) {
+    for (int ch = 0; ch < DAC_CHANNEL_MAX; ch++) {
+      m_slots[op][ch].queued = false;
+    }
+  }
+  m_head = 0;
+  m_tail = 0;
+  m_stop = false;
+  resetStats();
+
+  if (xTaskCreatePinnedToCore(serviceTask, "DacEspService", DAC_SERVICE_STACK_SIZE, NULL,
+                              priority, &m_task, core) != pdPASS) {
+    log_e("service task could not be created");
+    m_task = NULL;
+    return ESP_ERR_NO_MEM;
+  }
+
+  return ESP_OK;
+}
+
+//
+// Stop service task. Commands still in the queue get executed first.
+//
+esp_err_t DacEspService::end()
+{
+  SERVICE_CHECK;
+
+  m_stop = true;
+  notify();
+  while (m_task != NULL) {
+    vTaskDelay(1);
+  }
+
+  return ESP_OK;
+}
+
+//
+// Following the commands that can be posted. Parameters are checked
+// immediately, execution happens later in the service task. All of them
+// are non-blocking and can be called from interrupt handlers as well.
+// Return value ESP_ERR_NO_MEM signals a full queue.
+//
+esp_err_t DacEspService::outputVoltage(DacESP32 &dac, uint8_t value)
+{
+  SERVICE_CHECK;
+  DAC_CHECK(dac);
+
+  return postCoalesced(&dac, DAC_CMD_VOLTAGE, value);
+}
+
+esp_err_t DacEspService::outputCW(DacESP32 &dac, uint32_t frequency)
+{
+  SERVICE_CHECK;
+  DAC_CHECK(dac);
+
+  if (frequency == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  return post(&dac, DAC_CMD_CW, frequency);
+}
+
+esp_err_t DacEspService::setCwFrequency(DacESP32 &dac, uint32_t frequency)
+{
+  SERVICE_CHECK;
+  DAC_CHECK(dac);
+
+  if (frequency == 0) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  return postCoalesced(&dac, DAC_CMD_CW_FREQUENCY, frequency);
+}
+
+esp_err_t DacEspService::setCwScale(DacESP32 &dac, dac_cw_scale_t scale)
+{
+  SERVICE_CHECK;
+  DAC_CHECK(dac);
+
+  if (scale != DAC_CW_SCALE_1 && scale != DAC_CW_SCALE_2 &&
+      scale != DAC_CW_SCALE_4 && scale != DAC_CW_SCALE_8) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  return postCoalesced(&dac, DAC_CMD_CW_SCALE, scale);
+}
+
+esp_err_t DacEspService::setCwPhase(DacESP32 &dac, dac_cw_phase_t phase)
+{
+  SERVICE_CHECK;
+  DAC_CHECK(dac);
+
+  if (phase != DAC_CW_PHASE_0 && phase != DAC_CW_PHASE_180) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  return postCoalesced(&dac, DAC_CMD_CW_PHASE, phase);
+}
+
+esp_err_t DacEspService::setCwOffset(DacESP32 &dac, int8_t offset)
+{
+  SERVICE_CHECK;
+  DAC_CHECK(dac);
+
+  return postCoalesced(&dac, DAC_CMD_CW_OFFSET, (uint8_t)offset);
+}
+
+esp_err_t DacEspService::enable(DacESP32 &dac)
+{
+  SERVICE_CHECK;
+  DAC_CHECK(dac);
+
+  return post(&dac, DAC_CMD_ENABLE, 0);
+}
+
+esp_err_t DacEspService::disable(DacESP32 &dac)
+{
+  SERVICE_CHECK;
+  DAC_CHECK(dac);
+
+  return post(&dac, DAC_CMD_DISABLE, 0);
+}
+
+//
+// Get queue & latency statistics. Values of the service task (executed,
+// latency) are sampled without locking, hence might be slightly
+// inconsistent with the queue counters while the service is busy.
+//
+void DacEspService::getStats(dac_service_stats_t *stats)
+{
+  uint32_t executed = m_executed;
+
+  portENTER_CRITICAL_SAFE(&m_lock);
+  stats->posted = m_posted;
+  stats->coalesced = m_coalesced;
+  stats->dropped = m_dropped;
+  stats->depth = m_head - m_tail;
+  portEXIT_CRITICAL_SAFE(&m_lock);
+  stats->executed = executed;
+  stats->depthMax = m_depthMax;
+  stats->latencyAvgUs = executed ? (uint32_t)(m_latencySum / executed) : 0;
+  stats->latencyMaxUs = m_latencyMax;
+}
+
+void DacEspService::resetStats()
+{
+  portENTER_CRITICAL_SAFE(&m_lock);
+  m_posted = 0;
+  m_coalesced = 0;
+  m_dropped = 0;
+  portEXIT_CRITICAL_SAFE(&m_lock);
+  m_executed = 0;
+  m_depthMax = 0;
+  m_latencyMax = 0;
+  m_latencySum = 0;
+}
+
+//
+// Put command into queue and wake up service task. Commands of a channel
+// get executed in the order posted, so coalesced commands of the channel
+// still waiting stop taking new values.
+//
+esp_err_t DacEspService::post(DacESP32 *dac, dac_cmd_op_t op, uint32_t value)
+{
+  uint32_t  pos;
+  esp_err_t result;
+
+  portENTER_CRITICAL_SAFE(&m_lock);
+  if ((result = enqueue(dac, op, value, &pos)) == ESP_OK) {
+    closeSlots(dac->getChannel());
+  }
+  portEXIT_CRITICAL_SAFE(&m_lock);
+
+  if (result == ESP_OK) {
+    notify();
+  }
+
+  return result;
+}
+
+//
+// Merge value into the command of its slot if it is still waiting and no
+// other command for the channel got queued behind it, otherwise queue a new
+// command. The service task applies the latest value (and object) merged.
+//
+esp_err_t DacEspService::postCoalesced(DacESP32 *dac, dac_cmd_op_t op, uint32_t value)
+{
+  Slot     &slot = slotOf(op, dac);
+  bool      merged = false;
+  esp_err_t result = ESP_OK;
+
+  portENTER_CRITICAL_SAFE(&m_lock);
+  if (slot.queued) {
+    merged = true;
+    m_coalesced++;
+  }
+  else if ((result = enqueue(dac, op, value, &slot.pos)) == ESP_OK) {
+    slot.queued = true;
+  }
+  if (result == ESP_OK) {
+    slot.dac = dac;
+    slot.value = value;
+  }
+  portEXIT_CRITICAL_SAFE(&m_lock);
+
+  if (!merged && result == ESP_OK) {
+    notify();
+  }
+
+  return result;
+}
+
+//
+// Queue a command (m_lock held).
+//
+esp_err_t DacEspService::enqueue(DacESP32 *dac, dac_cmd_op_t op, uint32_t value, uint32_t *pos)
+{
+  dac_cmd_t cmd;
+
+  cmd.dac = dac;
+  cmd.value = value;
+  cmd.stamp = (uint32_t)esp_timer_get_time();
+  cmd.op = op;
+
+  if (!push(cmd, pos)) {
+    m_dropped++;
+    return ESP_ERR_NO_MEM;
+  }
+  m_posted++;
+
+  return ESP_OK;
+}
+
+//
+// Freeze the waiting coalesced commands of a channel & of the CW frequency
+// (m_lock held): they keep the values merged so far and later posts queue
+// new commands behind. Cells of slots still queued are not yet taken by
+// the service task (see next()), hence can be updated here.
+//
+void DacEspService::closeSlots(dac_channel_t channel)
+{
+  for (int op = 0; op < DAC_CMD_COALESCED_MAX; op++) {
+    Slot &slot = m_slots[op][op == DAC_CMD_CW_FREQUENCY ? 0 : channel];
+    if (slot.queued) {
+      dac_cmd_t &cmd = m_queue[slot.pos & (DAC_SERVICE_QUEUE_LEN - 1)];
+      cmd.dac = slot.dac;
+      cmd.value = slot.value;
+      slot.queued = false;
+    }
+  }
+}
+
+//
+// Take the next command out of the queue (service task only). A coalesced
+// command still open gets the latest object & value of its slot, the slot
+// is released, posts from now on queue a new command.
+//
+bool DacEspService::next(dac_cmd_t *cmd)
+{
+  bool found;
+
+  portENTER_CRITICAL(&m_lock);
+  if ((found = pop(cmd)) && cmd->op < DAC_CMD_COALESCED_MAX) {
+    Slot &slot = slotOf((dac_cmd_op_t)cmd->op, cmd->dac);
+    if (slot.queued && slot.pos == m_tail - 1) {
+      cmd->dac = slot.dac;
+      cmd->value = slot.value;
+      slot.queued = false;
+    }
+  }
+  portEXIT_CRITICAL(&m_lock);
+
+  return found;
+}
+
+//
+// CW frequency is common to all channels, hence has only one slot.
+//
+DacEspService::Slot &DacEspService::slotOf(dac_cmd_op_t op, DacESP32 *dac)
+{
+  return m_slots[op][op == DAC_CMD_CW_FREQUENCY ? 0 : dac->getChannel()];
+}
+
+//
+// Bounded ring of commands (m_lock held). A plain ring under the spinlock:
+// coalescing has to look at & update the slots and the queue in one step,
+// which the lock gives anyway, so atomics would add nothing.
+//
+bool DacEspService::push(const dac_cmd_t &cmd, uint32_t *position)
+{
+  if (m_head - m_tail == DAC_SERVICE_QUEUE_LEN) {
+    // queue full
+    return false;
+  }
+
+  m_queue[m_head & (DAC_SERVICE_QUEUE_LEN - 1)] = cmd;
+  *position = m_head++;
+
+  return true;
+}
+
+bool DacEspService::pop(dac_cmd_t *cmd)
+{
+  if (m_head == m_tail) {
+    // queue empty
+    return false;
+  }
+
+  *cmd = m_queue[m_tail++ & (DAC_SERVICE_QUEUE_LEN - 1)];
+
+  return true;
+}
+
+void DacEspService::notify()
+{
+  TaskHandle_t task = m_task;
+
+  if (task == NULL) {
+    return;
+  }
+  if (xPortInIsrContext()) {
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(task, &woken);
+    if (woken) {
+      portYIELD_FROM_ISR();
+    }
+  }
+  else {
+    xTaskNotifyGive(task);
+  }
+}
+
+//
+// Execute a command (service task only).
+//
+void DacEspService::execute(const dac_cmd_t &cmd)
+{
+  uint32_t value = cmd.value;
+
+  switch (cmd.op) {
+    case DAC_CMD_VOLTAGE:
+      cmd.dac->outputVoltage((uint8_t)value);
+      break;
+    case DAC_CMD_CW_FREQUENCY:
+      cmd.dac->setCwFrequency(value);
+      break;
+    case DAC_CMD_CW_SCALE:
+      cmd.dac->setCwScale((dac_cw_scale_t)value);
+      break;
+    case DAC_CMD_CW_PHASE:
+      cmd.dac->setCwPhase((dac_cw_phase_t)value);
+      break;
+    case DAC_CMD_CW_OFFSET:
+      cmd.dac->setCwOffset((int8_t)value);
+      break;
+    case DAC_CMD_CW:
+      cmd.dac->outputCW(value);
+      break;
+    case DAC_CMD_ENABLE:
+      cmd.dac->enable();
+      break;
+    case DAC_CMD_DISABLE:
+      cmd.dac->disable();
+      break;
+  }
+
+  uint32_t latency = (uint32_t)esp_timer_get_time() - cmd.stamp;
+  m_latencySum += latency;
+  if (latency > m_latencyMax) {
+    m_latencyMax = latency;
+  }
+  m_executed++;
+}
+
+//
+// Service task: sleeps until commands get posted, then drains the queue.
+//
+void DacEspService::serviceTask(void *arg)
+{
+  dac_cmd_t cmd;
+
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    portENTER_CRITICAL(&m_lock);
+    uint32_t depth = m_head - m_tail;
+    portEXIT_CRITICAL(&m_lock);
+    if (depth > m_depthMax) {
+      m_depthMax = depth;
+    }
+
+    while (next(&cmd)) {
+      execute(cmd);
+    }
+
+    if (m_stop) {
+      break;
+    }
+  }
+
+  m_task = NULL;
+  vTaskDelete(NULL);
+}
@@ -0,0 +1,130 @@
+/*
+  DacEspService, DAC command task for the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Optional service mode: instead of executing frequency calculation and
+  register writes inline, callers post compact commands into a queue. A
+  dedicated task (pinned to a selectable core) executes them in the order
+  posted per channel. Parameter settings still waiting in the queue get
+  coalesced, e.g. only the latest CW frequency is applied if several got
+  posted in a row.
+  Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef DacEspService_h
+#define DacEspService_h
+
+#include "DacESP32.h"
+
+//
+// definitions
+//
+// Number of command slots in the queue, must be a power of 2.
+#ifndef DAC_SERVICE_QUEUE_LEN
+#define DAC_SERVICE_QUEUE_LEN 32
+#endif
+#define DAC_SERVICE_STACK_SIZE 4096
+
+typedef enum {
+  DAC_CMD_VOLTAGE = 0,      // outputVoltage(uint8_t)     coalesced per channel
+  DAC_CMD_CW_FREQUENCY,     // setCwFrequency()           coalesced (common to all channels)
+  DAC_CMD_CW_SCALE,         // setCwScale()               coalesced per channel
+  DAC_CMD_CW_PHASE,         // setCwPhase()               coalesced per channel
+  DAC_CMD_CW_OFFSET,        // setCwOffset()              coalesced per channel
+  DAC_CMD_COALESCED_MAX,
+  DAC_CMD_CW = DAC_CMD_COALESCED_MAX, // outputCW(frequency)
+  DAC_CMD_ENABLE,           // enable()
+  DAC_CMD_DISABLE           // disable()
+} dac_cmd_op_t;
+
+typedef struct {
+  DacESP32 *dac;            // target object
+  uint32_t  value;          // argument (coalesced commands: see DacEspService::Slot)
+  uint32_t  stamp;          // time of posting (us, lower 32 bits)
+  uint8_t   op;             // dac_cmd_op_t
+} dac_cmd_t;
+
+typedef struct {
+  uint32_t posted;          // commands put into queue
+  uint32_t coalesced;       // commands merged into one still waiting in queue
+  uint32_t dropped;         // commands rejected (queue full)
+  uint32_t executed;        // commands executed by service task
+  uint32_t depth;           // current number of commands in queue
+  uint32_t depthMax;        // max. number of commands in queue seen
+  uint32_t latencyAvgUs;    // average time from posting to execution (us)
+  uint32_t latencyMaxUs;    // max. time from posting to execution (us)
+} dac_service_stats_t;
+
+// DacEspService class, all members are static (one service for both channels)
+class DacEspService
+{
+  public:
+    static esp_err_t begin(BaseType_t core = 1, UBaseType_t priority = 5);
+    static esp_err_t end(void);
+    static bool      isRunning(void) { return m_task != NULL; };
+    static esp_err_t outputVoltage(DacESP32 &dac, uint8_t value);
+    static esp_err_t outputCW(DacESP32 &dac, uint32_t frequency);
+    static esp_err_t setCwFrequency(DacESP32 &dac, uint32_t frequency);
+    static esp_err_t setCwScale(DacESP32 &dac, dac_cw_scale_t scale);
+    static esp_err_t setCwPhase(DacESP32 &dac, dac_cw_phase_t phase);
+    static esp_err_t setCwOffset(DacESP32 &dac, int8_t offset);
+    static esp_err_t enable(DacESP32 &dac);
+    static esp_err_t disable(DacESP32 &dac);
+    static void      getStats(dac_service_stats_t *stats);
+    static void      resetStats(void);
+
+  private:
+    struct Slot {
+      DacESP32 *dac;               // object of the latest post
+      uint32_t  value;             // latest value posted
+      uint32_t  pos;               // queue position of the command
+      bool      queued;            // command waiting in queue, posts get merged into it
+    };
+
+    static esp_err_t post(DacESP32 *dac, dac_cmd_op_t op, uint32_t value);
+    static Slot     &slotOf(dac_cmd_op_t op, DacESP32 *dac);
+    static esp_err_t postCoalesced(DacESP32 *dac, dac_cmd_op_t op, uint32_t value);
+    static esp_err_t enqueue(DacESP32 *dac, dac_cmd_op_t op, uint32_t value, uint32_t *pos);
+    static void      closeSlots(dac_channel_t channel);
+    static bool      next(dac_cmd_t *cmd);
+    static bool      push(const dac_cmd_t &cmd, uint32_t *position);
+    static bool      pop(dac_cmd_t *cmd);
+    static void      notify(void);
+    static void      execute(const dac_cmd_t &cmd);
+    static void      serviceTask(void *arg);
+
+    static dac_cmd_t     m_queue[DAC_SERVICE_QUEUE_LEN]; // ring of commands
+    static Slot          m_slots[DAC_CMD_COALESCED_MAX][DAC_CHANNEL_MAX];
+    static uint32_t      m_head;       // next enqueue position
+    static uint32_t      m_tail;       // next dequeue position
+    static TaskHandle_t  m_task;       // service task
+    static portMUX_TYPE  m_lock;       // guards queue, slots & posting statistics
+    static volatile bool m_stop;       // service task shall terminate
+
+    // statistics
+    static uint32_t      m_posted, m_coalesced, m_dropped;
+    static uint32_t      m_executed, m_depthMax, m_latencyMax;
+    static uint64_t      m_latencySum;
+};
+
+#endif
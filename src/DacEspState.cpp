@@ -0,0 +1,151 @@
+/*
+  DacEspState, register state decoder of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Register state decoder. Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include "DacEspState.h"
+#include "DacEspCwModel.h"
+#include "DacEspCwSolver.h"
+
+// register fields (ESP32) not covered by DacEspCwModel::configFromRegisters()
+#define STATE_CK8M_DFREQ_S        17
+#define STATE_CK8M_DFREQ_V        0xFF
+#define STATE_FAST_CLK_RTC_SEL_S  29
+#define STATE_SW_TONE_EN_S        16
+#define STATE_DAC_CW_EN_S(ch)     ((ch) ? 25 : 24)
+#define STATE_PDAC_DAC_S          19
+#define STATE_PDAC_DAC_V          0xFF
+#define STATE_PDAC_XPD_DAC_S      18
+#define STATE_PDAC_MUX_SEL_S      17
+#define STATE_PDAC_DAC_XPD_FORCE_S 10
+#define STATE_PDAC_RDE_S          28
+#define STATE_PDAC_RUE_S          27
+#define STATE_PDAC_DRV_S          30
+#define STATE_PDAC_DRV_V          0x3
+
+// prefix of a register dump line (see formatDump())
+#define STATE_DUMP_TAG "DACREGS"
+
+#define STATE_BIT(reg, s) ((((reg) >> (s)) & 1) != 0)
+
+//
+// Decode raw register values.
+// Parameter: regs...register values (e.g. captured with DacEspRegs::capture())
+//            ck8m...RTC8M_CLK frequency (Hz) for calculating the output frequency
+//            state...receives the decoded state
+//
+void DacEspState::decode(const dac_reg_dump_t &regs, uint32_t ck8m, dac_state_t *state)
+{
+  dac_cw_model_config_t cw;
+
+  memset(state, 0, sizeof(*state));
+  for (int ch = 0; ch < 2; ch++) {
+    dac_channel_state_t &c = state->channel[ch];
+    uint32_t pad = regs.padDac[ch];
+
+    DacEspCwModel::configFromRegisters(regs.clkConf, regs.ctrl1, regs.ctrl2, ch, &cw);
+    c.cwEnabled = STATE_BIT(regs.ctrl2, STATE_DAC_CW_EN_S(ch));
+    c.scale = cw.scale;
+    c.invert = cw.invert;
+    c.offset = cw.offset;
+    c.value = (pad >> STATE_PDAC_DAC_S) & STATE_PDAC_DAC_V;
+    c.outputEnabled = STATE_BIT(pad, STATE_PDAC_XPD_DAC_S);
+    c.xpdForce = STATE_BIT(pad, STATE_PDAC_DAC_XPD_FORCE_S);
+    c.rtcMux = STATE_BIT(pad, STATE_PDAC_MUX_SEL_S);
+    c.drive = (pad >> STATE_PDAC_DRV_S) & STATE_PDAC_DRV_V;
+    c.pullUp = STATE_BIT(pad, STATE_PDAC_RUE_S);
+    c.pullDown = STATE_BIT(pad, STATE_PDAC_RDE_S);
+  }
+
+  state->clk8mDiv = cw.clk8mDiv;
+  state->frequencyStep = cw.fstep;
+  state->ck8m = ck8m;
+  state->ck8mDfreq = (regs.clkConf >> STATE_CK8M_DFREQ_S) & STATE_CK8M_DFREQ_V;
+  state->fastClkRtc = STATE_BIT(regs.clkConf, STATE_FAST_CLK_RTC_SEL_S);
+  state->toneEnabled = STATE_BIT(regs.ctrl1, STATE_SW_TONE_EN_S);
+  state->frequency = DacEspCwSolver::outputFrequency(ck8m, state->clk8mDiv, state->frequencyStep);
+}
+
+//
+// Print decoded state as text (several lines).
+// Returns number of characters needed (like snprintf).
+//
+int DacEspState::format(const dac_state_t &state, char *buffer, size_t size)
+{
+  static const char *invert[4] = { "none", "all", "MSB (phase 0)", "not MSB (phase 180)" };
+  int n = snprintf(buffer, size,
+                   "CW generator: %s, frequency %u Hz (RTC8M_CLK %u Hz / (1 + CK8M_DIV_SEL %u) * SW_FSTEP %u / 65536)\n"
+                   "  CK8M_DFREQ %u, FAST_CLK_RTC_SEL %u\n",
+                   state.toneEnabled ? "running" : "stopped", (unsigned)state.frequency, (unsigned)state.ck8m,
+                   state.clk8mDiv, state.frequencyStep, state.ck8mDfreq, state.fastClkRtc);
+
+  for (int ch = 0; ch < 2; ch++) {
+    const dac_channel_state_t &c = state.channel[ch];
+    size_t used = (n >= 0 && (size_t)n < size) ? n : size;
+    n += snprintf(buffer + used, size - used,
+                  "DAC_CHANNEL_%d: output %s, %s, value %u (0x%02x)\n"
+                  "  CW scale 1/%u, invert %s, offset %d\n"
+                  "  XPD_FORCE %u, MUX_SEL %u, DRV %u, RUE %u, RDE %u\n",
+                  ch + 1, c.outputEnabled ? "enabled" : "disabled", c.cwEnabled ? "CW generator" : "DC value",
+                  c.value, c.value, 1u << c.scale, invert[c.invert & 3], c.offset,
+                  c.xpdForce, c.rtcMux, c.drive, c.pullUp, c.pullDown);
+  }
+  return n;
+}
+
+//
+// Print raw register values as one line, which can be decoded later
+// (e.g. on a host) with parseDump():
+//   DACREGS clkConf ctrl1 ctrl2 padDac1 padDac2
+//
+int DacEspState::formatDump(const dac_reg_dump_t &regs, char *buffer, size_t size)
+{
+  return snprintf(buffer, size, STATE_DUMP_TAG " %08x %08x %08x %08x %08x\n", (unsigned)regs.clkConf,
+                  (unsigned)regs.ctrl1, (unsigned)regs.ctrl2, (unsigned)regs.padDac[0], (unsigned)regs.padDac[1]);
+}
+
+//
+// Read register values from a line written by formatDump(). Text before
+// the tag (e.g. a log prefix) is ignored.
+// Returns false if the line does not hold a register dump.
+//
+bool DacEspState::parseDump(const char *line, dac_reg_dump_t *regs)
+{
+  const char *p = strstr(line, STATE_DUMP_TAG);
+  unsigned v[5];
+
+  if (p == NULL ||
+      sscanf(p + strlen(STATE_DUMP_TAG), "%x %x %x %x %x", &v[0], &v[1], &v[2], &v[3], &v[4]) != 5) {
+    return false;
+  }
+  regs->clkConf = v[0];
+  regs->ctrl1 = v[1];
+  regs->ctrl2 = v[2];
+  regs->padDac[0] = v[3];
+  regs->padDac[1] = v[4];
+  return true;
+}
@@ -0,0 +1,84 @@
+/*
+  DacEspState, register state decoder of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Decoder turning raw register values (RTC_CNTL_CLK_CONF_REG,
+  SENS_SAR_DAC_CTRL1/2_REG, RTC_IO_PAD_DAC1/2_REG) into a typed snapshot of
+  the DAC & CW generator state, no Arduino or ESP-IDF dependencies. Works on
+  live registers (DacESP32::getState()) as well as on register dumps
+  captured on a board and decoded on a host.
+  Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef DacEspState_h
+#define DacEspState_h
+
+#include <stdint.h>
+#include <stddef.h>
+
+// raw register values (same order as dac_reg_t)
+typedef struct {
+  uint32_t clkConf;         // RTC_CNTL_CLK_CONF_REG
+  uint32_t ctrl1;           // SENS_SAR_DAC_CTRL1_REG
+  uint32_t ctrl2;           // SENS_SAR_DAC_CTRL2_REG
+  uint32_t padDac[2];       // RTC_IO_PAD_DAC1_REG, RTC_IO_PAD_DAC2_REG
+} dac_reg_dump_t;
+
+// state of one DAC channel
+typedef struct {
+  bool     cwEnabled;       // SENS_DAC_CW_ENx, CW generator drives the channel
+  uint8_t  scale;           // SENS_DAC_SCALEx (dac_cw_scale_t)
+  uint8_t  invert;          // SENS_DAC_INVx (dac_cw_invert_t, DAC_CW_PHASE_0/180 = 2/3)
+  int8_t   offset;          // SENS_DAC_DCx, CW DC offset
+  uint8_t  value;           // RTC_IO_PDACx_DAC, DAC value used without CW generator
+  bool     outputEnabled;   // RTC_IO_PDACx_XPD_DAC, DAC powered up
+  bool     xpdForce;        // RTC_IO_PDACx_DAC_XPD_FORCE
+  bool     rtcMux;          // RTC_IO_PDACx_MUX_SEL, pad routed to RTC (DAC)
+  uint8_t  drive;           // RTC_IO_PDACx_DRV
+  bool     pullUp;          // RTC_IO_PDACx_RUE
+  bool     pullDown;        // RTC_IO_PDACx_RDE
+} dac_channel_state_t;
+
+// state of both channels & the CW generator
+typedef struct {
+  uint32_t frequency;       // CW output frequency achieved (Hz, truncated)
+  uint32_t ck8m;            // RTC8M_CLK frequency assumed for frequency (Hz)
+  uint8_t  clk8mDiv;        // RTC_CNTL_CK8M_DIV_SEL
+  uint8_t  ck8mDfreq;       // RTC_CNTL_CK8M_DFREQ
+  bool     fastClkRtc;      // RTC_CNTL_FAST_CLK_RTC_SEL (RTC fast clock = RTC8M_CLK)
+  uint16_t frequencyStep;   // SENS_SW_FSTEP
+  bool     toneEnabled;     // SENS_SW_TONE_EN, CW generator running
+  dac_channel_state_t channel[2];
+} dac_state_t;
+
+// DacEspState class, all members are static
+class DacEspState
+{
+  public:
+    static void decode(const dac_reg_dump_t &regs, uint32_t ck8m, dac_state_t *state);
+    static int  format(const dac_state_t &state, char *buffer, size_t size);
+    static int  formatDump(const dac_reg_dump_t &regs, char *buffer, size_t size);
+    static bool parseDump(const char *line, dac_reg_dump_t *regs);
+};
+
+#endif
@@ -0,0 +1,110 @@
+/*
+  DacEspTrace, register write trace for the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Register write trace. Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "DacEspTrace.h"
+
+#ifdef DACESP32_TRACE_ENABLED
+
+#include "DacEspRegs.h"
+
+#if (DAC_TRACE_LEN & (DAC_TRACE_LEN - 1)) != 0
+#error "DAC_TRACE_LEN must be a power of 2"
+#endif
+static_assert(DAC_TRACE_REGS == DAC_REG_MAX, "trace format must cover all registers of DacEspRegs");
+
+// initialize static members of class, written inside ISRs (kept in DRAM)
+DRAM_ATTR dac_trace_entry_t DacEspTrace::m_ring[DAC_TRACE_LEN];
+DRAM_ATTR uint32_t          DacEspTrace::m_writes = 0;
+DRAM_ATTR volatile bool     DacEspTrace::m_enabled = true;
+DRAM_ATTR uint8_t           DacEspTrace::m_api[DAC_TRACE_CORES] = { DAC_API_NONE };
+
+//
+// Start/stop recording (active from boot on).
+//
+void DacEspTrace::setEnabled(bool enable)
+{
+  DAC_ENTER_CRITICAL();
+  m_enabled = enable;
+  DAC_EXIT_CRITICAL();
+}
+
+//
+// Discard all recorded writes.
+//
+void DacEspTrace::reset()
+{
+  DAC_ENTER_CRITICAL();
+  m_writes = 0;
+  DAC_EXIT_CRITICAL();
+}
+
+//
+// Output header & recorded writes (oldest first), see DacEspTraceFormat.h.
+// Recording is paused meanwhile, writes during the dump are not recorded.
+// Parameter: out...gets called with consecutive pieces of the dump
+//            arg...passed to out
+// Returns number of bytes output.
+//
+size_t DacEspTrace::dump(dac_trace_out_t out, void *arg)
+{
+  dac_trace_header_t header;
+  bool enabled;
+
+  DAC_ENTER_CRITICAL();
+  enabled = m_enabled;
+  m_enabled = false;
+  header.writes = m_writes;
+  DAC_EXIT_CRITICAL();
+
+  header.magic = DAC_TRACE_MAGIC;
+  header.version = DAC_TRACE_VERSION;
+  header.ccountMhz = DAC_HAL_CCOUNT_MHZ();
+  header.count = header.writes < DAC_TRACE_LEN ? header.writes : DAC_TRACE_LEN;
+  for (int reg = 0; reg < DAC_TRACE_REGS; reg++) {
+    header.addr[reg] = DacEspRegs::address((dac_reg_t)reg);
+  }
+  out(&header, sizeof(header), arg);
+
+  // ring may have wrapped around, oldest entry first
+  uint32_t first = header.writes - header.count;
+  for (uint32_t i = 0; i < header.count; ) {
+    uint32_t pos = (first + i) & (DAC_TRACE_LEN - 1);
+    uint32_t n = DAC_TRACE_LEN - pos;
+    if (n > header.count - i) {
+      n = header.count - i;
+    }
+    out(&m_ring[pos], n * sizeof(dac_trace_entry_t), arg);
+    i += n;
+  }
+
+  if (enabled) {
+    setEnabled(true);
+  }
+  return sizeof(header) + header.count * sizeof(dac_trace_entry_t);
+}
+
+#endif
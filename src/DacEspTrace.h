@@ -0,0 +1,131 @@
+/*
+  DacEspTrace, register write trace for the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Optional register write trace (compiled in with DACESP32_TRACE_ENABLED).
+  Every register write issued by DacEspRegs gets recorded in a ring
+  buffer in RAM: register, old & new value, CCOUNT timestamp, CPU core and
+  the public API that caused it. The buffer is dumped on demand in a
+  compact binary format (see DacEspTraceFormat.h), extras/traceDecode
+  turns it into text on a host.
+  Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef DacEspTrace_h
+#define DacEspTrace_h
+
+#include "DacESP32.h"
+#include "DacEspTraceFormat.h"
+
+#ifdef DACESP32_TRACE_ENABLED
+
+//
+// definitions
+//
+// Number of entries kept (16 bytes each), must be a power of 2.
+#ifndef DAC_TRACE_LEN
+#define DAC_TRACE_LEN 256
+#endif
+#define DAC_TRACE_CORES 2
+
+// Tag register writes inside the current scope with the calling API.
+#define DAC_TRACE_API(api)                       DacEspTraceScope dacTraceScope(api)
+#define DAC_TRACE_WRITE(reg, oldValue, newValue) DacEspTrace::record(reg, oldValue, newValue)
+#define DAC_TRACE_DRIVER_WRITE(reg, oldValue, newValue) \
+  DacEspTrace::record(reg, oldValue, newValue, DAC_TRACE_FLAG_DRIVER)
+
+// receives the dump in pieces
+typedef void (*dac_trace_out_t)(const void *data, size_t size, void *arg);
+
+// DacEspTrace class, all members are static
+class DacEspTrace
+{
+  public:
+    //
+    // Record one register write. Called by DacEspRegs with the shared register
+    // lock (DAC_ENTER_CRITICAL) held, which already serializes all writers,
+    // hence no further locking. Safe in IRAM/ISR context.
+    //
+    static inline __attribute__((always_inline)) void record(uint8_t reg, uint32_t oldValue, uint32_t newValue,
+                                                             uint8_t flags = 0)
+    {
+      if (!m_enabled) {
+        return;
+      }
+      uint32_t core = DAC_HAL_CORE_ID();
+      dac_trace_entry_t &entry = m_ring[m_writes++ & (DAC_TRACE_LEN - 1)];
+      entry.ccount = DAC_HAL_CCOUNT();
+      entry.oldValue = oldValue;
+      entry.newValue = newValue;
+      entry.reg = reg;
+      entry.core = core;
+      entry.api = m_api[core];
+      entry.flags = flags;
+    }
+
+    static void     setEnabled(bool enable);
+    static bool     isEnabled(void) { return m_enabled; };
+    static void     reset(void);
+    static uint32_t getWriteCount(void) { return m_writes; };
+    static size_t   dump(dac_trace_out_t out, void *arg = NULL);
+
+  private:
+    friend class DacEspTraceScope;
+
+    static dac_trace_entry_t m_ring[DAC_TRACE_LEN]; // recorded writes
+    static uint32_t          m_writes;              // writes recorded since reset (next entry)
+    static volatile bool     m_enabled;             // recording active
+    static uint8_t           m_api[DAC_TRACE_CORES];// API currently running per core
+};
+
+// Sets the API tag of the current core for its lifetime, nested scopes
+// restore the outer tag.
+class DacEspTraceScope
+{
+  public:
+    inline __attribute__((always_inline)) DacEspTraceScope(dac_trace_api_t api)
+    {
+      m_core = DAC_HAL_CORE_ID();
+      m_prev = DacEspTrace::m_api[m_core];
+      DacEspTrace::m_api[m_core] = api;
+    }
+    inline __attribute__((always_inline)) ~DacEspTraceScope()
+    {
+      DacEspTrace::m_api[m_core] = m_prev;
+    }
+
+  private:
+    uint8_t m_core;
+    uint8_t m_prev;
+};
+
+#else
+
+// compiled out, no code generated
+#define DAC_TRACE_API(api)
+#define DAC_TRACE_WRITE(reg, oldValue, newValue)
+#define DAC_TRACE_DRIVER_WRITE(reg, oldValue, newValue)
+
+#endif
+
+#endif
@@ -0,0 +1,123 @@
+/*
+  DacEspTraceFormat, register write trace format of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Binary format of the register write trace (see DacEspTrace), shared by
+  the library & the host decoder extras/traceDecode. No Arduino or
+  ESP-IDF dependencies.
+  Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef DacEspTraceFormat_h
+#define DacEspTraceFormat_h
+
+#include <stdint.h>
+
+#define DAC_TRACE_MAGIC   0x43525444UL  // "DTRC"
+#define DAC_TRACE_VERSION 2
+#define DAC_TRACE_REGS    5             // registers traced (dac_reg_t)
+
+// API that caused a register write (innermost public call). Every public
+// method has its own tag, internal calls between them are not tagged again.
+typedef enum {
+  DAC_API_NONE = 0,                 // not tagged
+  DAC_API_CONSTRUCTOR,              // DacESP32()
+  DAC_API_DESTRUCTOR,               // ~DacESP32()
+  DAC_API_SET_PIN,                  // setPin()
+  DAC_API_SET_CHANNEL,              // setChannel()
+  DAC_API_GET_GPIO_NUM,             // getGPIOnum()
+  DAC_API_ENABLE,                   // enable()
+  DAC_API_DISABLE,                  // disable()
+  DAC_API_OUTPUT_VOLTAGE,           // outputVoltage(uint8_t)
+  DAC_API_OUTPUT_VOLTAGE_FLOAT,     // outputVoltage(float)
+  DAC_API_OUTPUT_CW,                // outputCW()
+  DAC_API_SET_CW_FREQUENCY,         // setCwFrequency()
+  DAC_API_SET_CW_FREQUENCY_OPTS,    // setCwFrequency() with dac_cw_solver_opts_t
+  DAC_API_SET_CW_SCALE,             // setCwScale()
+  DAC_API_SET_CW_OFFSET,            // setCwOffset()
+  DAC_API_SET_CW_PHASE,             // setCwPhase()
+  DAC_API_SOLVE_CW_FREQUENCY,       // solveCwFrequency()
+  DAC_API_SOLVE_CW_FREQUENCY_OPTS,  // solveCwFrequency() with dac_cw_solver_opts_t
+  DAC_API_GET_CW_FREQUENCY_ACTUAL,  // getCwFrequencyActual()
+  DAC_API_GET_STATE,                // getState()
+  DAC_API_SET_CONFIG,               // setConfig()
+  DAC_API_SET_GLOBAL_CONFIG,        // setGlobalConfig()
+  DAC_API_TRANSACTION,              // DacEspTransaction::commit()
+  DAC_API_ISR_OUTPUT_VOLTAGE,       // DacEspIsr::outputVoltage()
+  DAC_API_ISR_CW_ENABLE,            // DacEspIsr::cwEnable()
+  DAC_API_ISR_CW_DISABLE,           // DacEspIsr::cwDisable()
+  DAC_API_ISR_SET_CW_SCALE,         // DacEspIsr::setCwScale()
+  DAC_API_ISR_SET_CW_PHASE,         // DacEspIsr::setCwPhase()
+  DAC_API_ISR_SET_CW_OFFSET,        // DacEspIsr::setCwOffset()
+  DAC_API_ISR_SET_CW_FREQUENCY,     // DacEspIsr::setCwFrequency()
+  DAC_API_RAMP,                     // DacEspRamp timer
+  DAC_API_CLOCK_AUTO_TRIM,          // DacEspClock::autoTrim()
+  DAC_API_CLOCK_CALIBRATE,          // DacEspClock::calibrate()
+  DAC_API_DRIFT,                    // DacEspDrift::check()
+  DAC_API_FRAC_START,               // DacEspFrac::start()
+  DAC_API_FRAC_STOP,                // DacEspFrac::stop()
+  DAC_API_FRAC_TIMER,               // DacEspFrac timer
+  DAC_API_ARBITER_ADD,              // DacEspArbiter::addConstraint()
+  DAC_API_ARBITER_UPDATE,           // DacEspArbiter::updateConstraint()
+  DAC_API_ARBITER_REMOVE,           // DacEspArbiter::removeConstraint()
+  DAC_API_MAX
+} dac_trace_api_t;
+
+// names of dac_trace_api_t values (for decoders)
+#define DAC_TRACE_API_NAMES {                                                         \
+  "-", "DacESP32()", "~DacESP32()", "setPin", "setChannel", "getGPIOnum",            \
+  "enable", "disable", "outputVoltage(uint8_t)", "outputVoltage(float)", "outputCW", \
+  "setCwFrequency", "setCwFrequency(opts)", "setCwScale", "setCwOffset",             \
+  "setCwPhase", "solveCwFrequency", "solveCwFrequency(opts)",                        \
+  "getCwFrequencyActual", "getState", "setConfig", "setGlobalConfig",                \
+  "Transaction::commit", "Isr::outputVoltage", "Isr::cwEnable", "Isr::cwDisable",    \
+  "Isr::setCwScale", "Isr::setCwPhase", "Isr::setCwOffset", "Isr::setCwFrequency",   \
+  "Ramp::onTick", "Clock::autoTrim", "Clock::calibrate", "Drift::check",             \
+  "Frac::start", "Frac::stop", "Frac::onTimer", "Arbiter::addConstraint",            \
+  "Arbiter::updateConstraint", "Arbiter::removeConstraint" }
+
+// dump header, followed by 'count' entries (oldest first), little endian
+typedef struct {
+  uint32_t magic;           // DAC_TRACE_MAGIC
+  uint16_t version;         // DAC_TRACE_VERSION
+  uint16_t ccountMhz;       // CCOUNT ticks per us (CPU clock in MHz)
+  uint32_t writes;          // register writes recorded since reset (incl. overwritten ones)
+  uint32_t count;           // entries following
+  uint32_t addr[DAC_TRACE_REGS]; // register addresses (index = entry.reg)
+} dac_trace_header_t;
+
+// entry flags
+#define DAC_TRACE_FLAG_DRIVER 0x01      // written by the ESP-IDF DAC driver (DacEspRegs::padDriverCall())
+
+// one register write (16 bytes)
+typedef struct {
+  uint32_t ccount;          // CPU cycle counter at time of write
+  uint32_t oldValue;        // register value before
+  uint32_t newValue;        // register value written
+  uint8_t  reg;             // register (dac_reg_t)
+  uint8_t  core;            // CPU core
+  uint8_t  api;             // dac_trace_api_t
+  uint8_t  flags;           // DAC_TRACE_FLAG_xxx
+} dac_trace_entry_t;
+
+#endif
@@ -0,0 +1,318 @@
+/*
+  DacEspTransaction, atomic multi-parameter updates for the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Collects changes of CW frequency, scale, phase, offset and CW generator
+  selection for both DAC channels in shadow copies of the registers
+  RTC_CNTL_CLK_CONF_REG, SENS_SAR_DAC_CTRL1_REG and SENS_SAR_DAC_CTRL2_REG.
+  commit() then writes each register only once, back to back, so the
+  output never passes through intermediate states (e.g. new scale with
+  old offset). Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "DacEspTransaction.h"
+#include "DacEspRegs.h"
+#include "DacChannel.h"
+#include "DacEspProfile.h"
+#include "DacEspArbiter.h"
+
+//
+// Class constructor. Starts with an empty transaction.
+//
+DacEspTransaction::DacEspTransaction()
+{
+  begin();
+}
+
+//
+// Discard all staged changes and start a new transaction.
+//
+void DacEspTransaction::begin()
+{
+  m_clkConf = m_ctrl1 = m_ctrl2 = 0;
+  m_clkConfMask = m_ctrl1Mask = m_ctrl2Mask = 0;
+  m_cwFrequency = 0;
+  for (int i = 0; i < DAC_CHANNEL_MAX; i++) {
+    m_dac[i] = NULL;
+    m_cwSelect[i] = false;
+  }
+}
+
+//
+// Stage new CW generator frequency (common to both channels). The register
+// settings get calculated right away with the global configuration (see
+// DacESP32::setGlobalConfig()), commit() only writes them.
+// Parameter: frequency - see DacESP32::setCwFrequency()
+//
+esp_err_t DacEspTransaction::setCwFrequency(uint32_t frequency)
+{
+  return stageCwFrequency(DacESP32::m_global, frequency);
+}
+
+//
+// Same as above, but calculated with the configuration of a DAC object
+// (its own one if set with DacESP32::setConfig()).
+//
+esp_err_t DacEspTransaction::setCwFrequency(DacESP32 &dac, uint32_t frequency)
+{
+  esp_err_t result;
+
+  if ((result = useChannel(dac)) != ESP_OK) {
+    return result;
+  }
+
+  return stageCwFrequency(dac.settings(), frequency);
+}
+
+//
+// Stage CW generator output amplitude of a DAC channel.
+//
+esp_err_t DacEspTransaction::setCwScale(DacESP32 &dac, dac_cw_scale_t scale)
+{
+  esp_err_t result;
+
+  if ((result = useChannel(dac)) != ESP_OK) {
+    return result;
+  }
+
+  if (scale != DAC_CW_SCALE_1 && scale != DAC_CW_SCALE_2 &&
+      scale != DAC_CW_SCALE_4 && scale != DAC_CW_SCALE_8) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  if (dac.m_channel == DAC_CHANNEL_1) {
+    stage(m_ctrl2, m_ctrl2Mask, SENS_DAC_SCALE1_M, scale << SENS_DAC_SCALE1_S);
+  }
+  else {
+    stage(m_ctrl2, m_ctrl2Mask, SENS_DAC_SCALE2_M, scale << SENS_DAC_SCALE2_S);
+  }
+
+  return ESP_OK;
+}
+
+//
+// Stage CW generator output phase of a DAC channel.
+//
+esp_err_t DacEspTransaction::setCwPhase(DacESP32 &dac, dac_cw_phase_t phase)
+{
+  esp_err_t result;
+
+  if ((result = useChannel(dac)) != ESP_OK) {
+    return result;
+  }
+
+  if (phase != DAC_CW_PHASE_0 && phase != DAC_CW_PHASE_180) {
+    return ESP_ERR_INVALID_ARG;
+  }
+
+  if (dac.m_channel == DAC_CHANNEL_1) {
+    stage(m_ctrl2, m_ctrl2Mask, SENS_DAC_INV1_M, phase << SENS_DAC_INV1_S);
+  }
+  else {
+    stage(m_ctrl2, m_ctrl2Mask, SENS_DAC_INV2_M, phase << SENS_DAC_INV2_S);
+  }
+
+  return ESP_OK;
+}
+
+//
+// Stage CW generator DC offset of a DAC channel.
+//
+esp_err_t DacEspTransaction::setCwOffset(DacESP32 &dac, int8_t offset)
+{
+  esp_err_t result;
+
+  if ((result = useChannel(dac)) != ESP_OK) {
+    return result;
+  }
+
+  if (dac.m_channel == DAC_CHANNEL_1) {
+    stage(m_ctrl2, m_ctrl2Mask, SENS_DAC_DC1_M, (uint8_t)offset << SENS_DAC_DC1_S);
+  }
+  else {
+    stage(m_ctrl2, m_ctrl2Mask, SENS_DAC_DC2_M, (uint8_t)offset << SENS_DAC_DC2_S);
+  }
+
+  return ESP_OK;
+}
+
+//
+// Stage selection of CW generator as source for a DAC channel. DAC channel
+// output gets enabled with commit().
+//
+esp_err_t DacEspTransaction::cwSelect(DacESP32 &dac)
+{
+  esp_err_t result;
+
+  if ((result = useChannel(dac)) != ESP_OK) {
+    return result;
+  }
+
+  if (dac.m_channel == DAC_CHANNEL_1) {
+    stage(m_ctrl2, m_ctrl2Mask, SENS_DAC_CW_EN1_M, SENS_DAC_CW_EN1_M);
+  }
+  else {
+    stage(m_ctrl2, m_ctrl2Mask, SENS_DAC_CW_EN2_M, SENS_DAC_CW_EN2_M);
+  }
+  m_cwSelect[dac.m_channel] = true;
+
+  return ESP_OK;
+}
+
+//
+// Stage deselection of CW generator as source for a DAC channel.
+//
+esp_err_t DacEspTransaction::cwDeselect(DacESP32 &dac)
+{
+  esp_err_t result;
+
+  if ((result = useChannel(dac)) != ESP_OK) {
+    return result;
+  }
+
+  if (dac.m_channel == DAC_CHANNEL_1) {
+    stage(m_ctrl2, m_ctrl2Mask, SENS_DAC_CW_EN1_M, 0);
+  }
+  else {
+    stage(m_ctrl2, m_ctrl2Mask, SENS_DAC_CW_EN2_M, 0);
+  }
+  m_cwSelect[dac.m_channel] = false;
+
+  return ESP_OK;
+}
+
+//
+// Write all staged changes. Each register gets written at most once and all
+// writes happen back to back inside one critical section, the pad registers
+// of channels switched to the CW generator last. Bits not touched
+// by the transaction keep their current value. Starts a new transaction.
+// Fails without writing anything if the staged CK8M_DIV_SEL got disallowed
+// by a constraint added meanwhile (see DacEspArbiter).
+//
+esp_err_t DacEspTransaction::commit()
+{
+  DAC_API(DAC_API_TRANSACTION);
+
+  uint32_t ctrl2;
+
+  if ((m_clkConfMask & RTC_CNTL_CK8M_DIV_SEL_M) &&
+      !DacEspArbiter::isAllowed((m_clkConf & RTC_CNTL_CK8M_DIV_SEL_M) >> RTC_CNTL_CK8M_DIV_SEL_S)) {
+    // divider staged before a constraint got added, nothing written
+    log_e("staged CK8M_DIV_SEL not allowed anymore");
+    return ESP_ERR_INVALID_STATE;
+  }
+
+  DAC_ENTER_CRITICAL();
+  ctrl2 = (DacEspRegs::read(DAC_REG_CTRL2) & ~m_ctrl2Mask) | m_ctrl2;
+  if (m_ctrl2Mask & (SENS_DAC_CW_EN1_M | SENS_DAC_CW_EN2_M)) {
+    // CW generator runs as long as at least one channel uses it
+    stage(m_ctrl1, m_ctrl1Mask, SENS_SW_TONE_EN,
+          (ctrl2 & (SENS_DAC_CW_EN1_M | SENS_DAC_CW_EN2_M)) ? SENS_SW_TONE_EN : 0);
+  }
+  if (m_clkConfMask) {
+    DacEspRegs::setField(DAC_REG_CLK_CONF, m_clkConfMask, m_clkConf);
+  }
+  if (m_ctrl1Mask) {
+    DacEspRegs::setField(DAC_REG_CTRL1, m_ctrl1Mask, m_ctrl1);
+  }
+  if (m_ctrl2Mask) {
+    DacEspRegs::setField(DAC_REG_CTRL2, m_ctrl2Mask, m_ctrl2);
+  }
+  // DAC channel outputs switched to CW generator get powered up last, when
+  // the generator already runs with its new settings
+  if (m_cwSelect[DAC_CHANNEL_1]) {
+    DacEspRegs::setField(DAC_REG_PAD_DAC1, DacChannelRegs<DAC_CHANNEL_1>::padEnable,
+                         DacChannelRegs<DAC_CHANNEL_1>::padEnable);
+  }
+  if (m_cwSelect[DAC_CHANNEL_2]) {
+    DacEspRegs::setField(DAC_REG_PAD_DAC2, DacChannelRegs<DAC_CHANNEL_2>::padEnable,
+                         DacChannelRegs<DAC_CHANNEL_2>::padEnable);
+  }
+  DAC_EXIT_CRITICAL();
+  DacEspArbiter::checkDivider();
+
+  // keep objects in sync with the new register settings
+  if (m_cwFrequency) {
+    DacESP32::m_cwFrequency = m_cwFrequency;
+  }
+  if (m_dac[DAC_CHANNEL_1] != NULL) {
+    DacESP32 *dac = m_dac[DAC_CHANNEL_1];
+    if (m_ctrl2Mask & SENS_DAC_SCALE1_M) dac->m_cwScale = (dac_cw_scale_t)((ctrl2 >> SENS_DAC_SCALE1_S) & SENS_DAC_SCALE1_V);
+    if (m_ctrl2Mask & SENS_DAC_INV1_M) dac->m_cwPhase = (dac_cw_phase_t)((ctrl2 >> SENS_DAC_INV1_S) & SENS_DAC_INV1_V);
+    if (m_ctrl2Mask & SENS_DAC_DC1_M) dac->m_cwOffset = (int8_t)((ctrl2 >> SENS_DAC_DC1_S) & SENS_DAC_DC1_V);
+  }
+  if (m_dac[DAC_CHANNEL_2] != NULL) {
+    DacESP32 *dac = m_dac[DAC_CHANNEL_2];
+    if (m_ctrl2Mask & SENS_DAC_SCALE2_M) dac->m_cwScale = (dac_cw_scale_t)((ctrl2 >> SENS_DAC_SCALE2_S) & SENS_DAC_SCALE2_V);
+    if (m_ctrl2Mask & SENS_DAC_INV2_M) dac->m_cwPhase = (dac_cw_phase_t)((ctrl2 >> SENS_DAC_INV2_S) & SENS_DAC_INV2_V);
+    if (m_ctrl2Mask & SENS_DAC_DC2_M) dac->m_cwOffset = (int8_t)((ctrl2 >> SENS_DAC_DC2_S) & SENS_DAC_DC2_V);
+  }
+
+  begin();
+
+  return ESP_OK;
+}
+
+//
+// Check DAC object & remember it for updating its variables on commit().
+//
+esp_err_t DacEspTransaction::useChannel(DacESP32 &dac)
+{
+  if (dac.m_channel != DAC_CHANNEL_1 && dac.m_channel != DAC_CHANNEL_2) {
+    log_e("channel setting invalid");
+    return ESP_FAIL;
+  }
+  m_dac[dac.m_channel] = &dac;
+
+  return ESP_OK;
+}
+
+//
+// Solve CW frequency with given settings & stage the register fields.
+//
+esp_err_t DacEspTransaction::stageCwFrequency(const DacESP32::dac_settings_t &settings, uint32_t frequency)
+{
+  dac_cw_setting_t setting;
+  esp_err_t result;
+
+  if ((result = DacESP32::solve(settings, frequency, &setting)) != ESP_OK) {
+    return result;
+  }
+
+  if (settings.config.cwHighAccuracy) {
+    stage(m_clkConf, m_clkConfMask, RTC_CNTL_CK8M_DIV_SEL_M, setting.clk8mDiv << RTC_CNTL_CK8M_DIV_SEL_S);
+  }
+  stage(m_ctrl1, m_ctrl1Mask, SENS_SW_FSTEP_M, setting.frequencyStep << SENS_SW_FSTEP_S);
+  m_cwFrequency = frequency;
+
+  return ESP_OK;
+}
+
+//
+// Change a register field in a shadow copy and mark its bits as changed.
+//
+void DacEspTransaction::stage(uint32_t &shadow, uint32_t &mask, uint32_t fieldMask, uint32_t value)
+{
+  shadow = (shadow & ~fieldMask) | (value & fieldMask);
+  mask |= fieldMask;
+}
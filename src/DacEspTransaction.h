@@ -0,0 +1,65 @@
+/*
+  DacEspTransaction, atomic multi-parameter updates for the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Collects changes of CW frequency, scale, phase, offset and CW generator
+  selection for both DAC channels in shadow copies of the registers
+  RTC_CNTL_CLK_CONF_REG, SENS_SAR_DAC_CTRL1_REG and SENS_SAR_DAC_CTRL2_REG.
+  commit() then writes each register only once, back to back, so the
+  output never passes through intermediate states (e.g. new scale with
+  old offset). Please see Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef DacEspTransaction_h
+#define DacEspTransaction_h
+
+#include "DacESP32.h"
+
+// DacEspTransaction class
+class DacEspTransaction
+{
+  public:
+    DacEspTransaction();
+    void      begin(void);
+    esp_err_t setCwFrequency(uint32_t frequency);
+    esp_err_t setCwFrequency(DacESP32 &dac, uint32_t frequency);
+    esp_err_t setCwScale(DacESP32 &dac, dac_cw_scale_t scale);
+    esp_err_t setCwPhase(DacESP32 &dac, dac_cw_phase_t phase);
+    esp_err_t setCwOffset(DacESP32 &dac, int8_t offset);
+    esp_err_t cwSelect(DacESP32 &dac);
+    esp_err_t cwDeselect(DacESP32 &dac);
+    esp_err_t commit(void);
+
+  private:
+    esp_err_t useChannel(DacESP32 &dac);
+    esp_err_t stageCwFrequency(const DacESP32::dac_settings_t &settings, uint32_t frequency);
+    static void stage(uint32_t &shadow, uint32_t &mask, uint32_t fieldMask, uint32_t value);
+
+    uint32_t  m_clkConf, m_ctrl1, m_ctrl2;             // shadow copies of registers
+    uint32_t  m_clkConfMask, m_ctrl1Mask, m_ctrl2Mask; // bits changed by transaction
+    DacESP32 *m_dac[DAC_CHANNEL_MAX];                  // objects involved per channel
+    uint32_t  m_cwFrequency;                           // new frequency (0 = unchanged)
+    bool      m_cwSelect[DAC_CHANNEL_MAX];             // CW generator selected for channel
+};
+
+#endif
@@ -0,0 +1,89 @@
+/*
+  DacEspTrimSearch, RTC8M_CLK trim search of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  RTC8M_CLK trim search, no hardware dependencies. Please see Readme.md
+  for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#include "DacEspTrimSearch.h"
+
+//
+// Binary search for the CK8M_DFREQ value giving a RTC8M_CLK frequency closest
+// to the target. The frequency is expected to rise with CK8M_DFREQ. The search
+// ends with the lowest value reaching the target, then this value & the one
+// below get compared. Needs about 10 measurements.
+// Parameter: target...wanted RTC8M_CLK frequency (Hz)
+//            measure...applies a CK8M_DFREQ value & measures RTC8M_CLK
+//            arg...passed to measure
+//            result...receives the value found & its frequency
+// Returns false if a measurement failed. The value found is not applied, the
+// caller has to set it (the hardware keeps the value measured last).
+//
+bool DacEspTrimSearch::search(uint32_t target, dac_trim_measure_t measure, void *arg, dac_trim_result_t *result)
+{
+  uint32_t lo = 0, hi = DAC_TRIM_DFREQ_MAX, f, fBelow;
+  uint8_t  count = 0;
+
+  if (measure == 0 || result == 0) {
+    return false;
+  }
+
+  // lowest value with f >= target (DAC_TRIM_DFREQ_MAX if target not reachable)
+  while (lo < hi) {
+    uint32_t mid = (lo + hi) / 2;
+    if ((f = measure(mid, arg)) == 0) {
+      return false;
+    }
+    count++;
+    if (f < target) {
+      lo = mid + 1;
+    }
+    else {
+      hi = mid;
+    }
+  }
+
+  if ((f = measure(lo, arg)) == 0) {
+    return false;
+  }
+  count++;
+  result->dfreq = lo;
+  result->frequency = f;
+
+  // value below might be closer
+  if (lo > 0 && f > target) {
+    if ((fBelow = measure(lo - 1, arg)) == 0) {
+      return false;
+    }
+    count++;
+    uint32_t deltaBelow = (fBelow > target) ? fBelow - target : target - fBelow;
+    if (deltaBelow < f - target) {
+      result->dfreq = lo - 1;
+      result->frequency = fBelow;
+    }
+  }
+  result->measurements = count;
+
+  return true;
+}
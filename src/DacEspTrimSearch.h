@@ -0,0 +1,59 @@
+/*
+  DacEspTrimSearch, RTC8M_CLK trim search of the DacESP32 library
+
+  Copyright (c) 2022 Thomas Jentzsch
+
+  Search of the RTC_CNTL_CK8M_DFREQ value bringing RTC8M_CLK closest to
+  a target frequency. The measurement is supplied by the caller, hence
+  the search has no hardware dependencies and can be tested on a host
+  with a simulated clock. Used by DacEspClock::autoTrim(). Please see
+  Readme.md for more details.
+
+  Permission is hereby granted, free of charge, to any person
+  obtaining a copy of this software and associated documentation
+  files (the "Software"), to deal in the Software without restriction,
+  including without limitation the rights to use, copy, modify, merge,
+  publish, distribute, sublicense, and/or sell copies of the Software,
+  and to permit persons to whom the Software is furnished to do so, subject
+  to the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR
+  ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF
+  CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION
+  WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef DacEspTrimSearch_h
+#define DacEspTrimSearch_h
+
+#include <stdint.h>
+
+//
+// definitions
+//
+#define DAC_TRIM_DFREQ_MAX 255    // RTC_CNTL_CK8M_DFREQ is 8 bit
+
+// Sets CK8M_DFREQ to dfreq & returns the resulting RTC8M_CLK frequency (Hz),
+// 0 if the measurement failed.
+typedef uint32_t (*dac_trim_measure_t)(uint8_t dfreq, void *arg);
+
+typedef struct {
+  uint8_t  dfreq;           // CK8M_DFREQ value found
+  uint32_t frequency;       // RTC8M_CLK measured with this value (Hz)
+  uint8_t  measurements;    // number of measurements needed
+} dac_trim_result_t;
+
+// DacEspTrimSearch class, all members are static
+class DacEspTrimSearch
+{
+  public:
+    static bool search(uint32_t target, dac_trim_measure_t measure, void *arg, dac_trim_result_t *result);
+};
+
+#endif